@@ -48,6 +48,8 @@ dict_file_directory['name'] = {
     'size': <integer number: file size (uint64)>
     'write': <function: write callback function>
     'read': <function: read callback function>
+    'readinto': <function: optional read callback function filling a
+                 writable memoryview of the native buffer in-place>
 }
 
 The dicts are: VmmPy_RootDirectoryRoot and VmmPy_RootDirectoryProcess.
@@ -59,6 +61,15 @@ processes. If process independant file listings are required please use the
 Please also note that even though the directory listings are shared amongst
 all processes it's still possible to differentiate on file contents via the
 'read' and 'write' callback functions.
+
+Files and directories registered via the VmmPyPlugin_FileRegister* functions
+are mirrored in the native plugin. Listings of such directories are served
+natively and root files registered with is_cacheable=True have their contents
+cached natively until VmmPyPlugin_FileInvalidate is called or the file is
+written. Process files are never cached natively since their contents may
+differ between processes. Dynamic listings ('list' callback) are cached natively until the next
+notify event. Directory dicts modified directly (not via the register
+functions) are not reflected in the native plugin.
 """
 
 
@@ -85,7 +96,8 @@ def VmmPyPlugin_InternalInitialize():
         VmmPyPlugin_InternalCallback_Read, 
         VmmPyPlugin_InternalCallback_Write, 
         VmmPyPlugin_InternalCallback_Notify, 
-        VmmPyPlugin_InternalCallback_Close)
+        VmmPyPlugin_InternalCallback_Close,
+        VmmPyPlugin_InternalCallback_ReadInto)
 
 
 
@@ -181,6 +193,43 @@ def VmmPyPlugin_InternalCallback_Read(pid, path, bytes_length, bytes_offset):
         return None
 
 
+
+def VmmPyPlugin_InternalCallback_ReadInto(pid, path, bytes_view, bytes_offset):
+    """Internal Use Only!
+    Read bytes from a given path/file directly into the native buffer.
+    NB! the view is released on return and must not be retained.
+
+    Keyword arguments:
+    pid -- int: process identifier (PID), None/False for root.
+    path -- str: the path/file to read.
+    bytes_view -- memoryview: writable view of the native buffer.
+    bytes_offset -- int: offset of bytes to read.
+    return -- int: the number of bytes read.
+    """
+    try:
+        file_name, file_attr = VmmPyPlugin_FileRetrieve(pid, path)
+        bytes_length = len(bytes_view)
+        if bytes_offset >= file_attr['size']:
+            return 0
+        if bytes_length + bytes_offset > file_attr['size']:
+            bytes_length = file_attr['size'] - bytes_offset
+        if file_attr.get('readinto') != None:
+            with bytes_view[:bytes_length] as view:
+                return file_attr['readinto'](pid, file_name, file_attr, view, bytes_offset)
+        if file_attr['read'] == None:
+            return 0
+        bytes_data = file_attr['read'](pid, file_name, file_attr, bytes_length, bytes_offset)
+        if bytes_data == None:
+            return 0
+        bytes_length = min(bytes_length, len(bytes_data))
+        bytes_view[:bytes_length] = bytes_data[:bytes_length]
+        return bytes_length
+    except Exception as e:
+        if VmmPyPlugin_fPrintV:
+            print("VmmPyPlugin_InternalCallback_ReadInto: Exception: " + str(e))
+        return 0
+
+
    
 def VmmPyPlugin_InternalCallback_Write(pid, path, bytes_data, bytes_offset):
     """Internal Use Only!
@@ -251,7 +300,7 @@ def VmmPyPlugin_InternalCallback_Close():
 
 
 
-def VmmPyPlugin_FileRegister(pid, path, size, fn_read_callback, fn_write_callback = None, is_overwrite = False):
+def VmmPyPlugin_FileRegister(pid, path, size, fn_read_callback, fn_write_callback = None, is_overwrite = False, fn_readinto_callback = None, is_cacheable = False):
     """Register a file in the file listing database.
     NB! Required directories are automatically created if possible.
 
@@ -262,19 +311,24 @@ def VmmPyPlugin_FileRegister(pid, path, size, fn_read_callback, fn_write_callbac
     fn_read_callback = callback function for read operation.
     fn_write_callback = callback function for write operation.
     is_overwrite -- overwrise allowed?
+    fn_readinto_callback = optional callback function filling a memoryview in-place.
+    is_cacheable -- contents may be cached natively until invalidated (root files only).
     """
-    dir_entry = VmmPyPlugin_RootDirectoryRoot if (pid == None or pid == False) else VmmPyPlugin_RootDirectoryProcess
+    is_root = (pid == None or pid == False)
+    dir_entry = VmmPyPlugin_RootDirectoryRoot if is_root else VmmPyPlugin_RootDirectoryProcess
     path_items = list(filter(None, path.split('/')))
     file = path_items.pop()
-    for path_item in path_items:
+    for i, path_item in enumerate(path_items):
         if not path_item in dir_entry:
             dir_entry[path_item] = {'list': None, 'dirs': {}}
+            VMMPYCC_StaticRegister(is_root, '/'.join(path_items[:i+1]), 0, True, False, False)
         if dir_entry[path_item]['list'] != None:
             raise RuntimeError('VmmPyPlugin_FileRegister: cannot add file entry to sub-directory with dynamic listing.')
         dir_entry = dir_entry[path_item]['dirs']
     if not is_overwrite and file in dir_entry:
         raise RuntimeError('VmmPyPlugin_FileRegister: cannot overwrite existing file without is_overwrite flag set.')
-    dir_entry[file] = {'size': size, 'read': fn_read_callback, 'write': fn_write_callback}
+    dir_entry[file] = {'size': size, 'read': fn_read_callback, 'write': fn_write_callback, 'readinto': fn_readinto_callback}
+    VMMPYCC_StaticRegister(is_root, path, size, False, False, is_cacheable)
 
 
 
@@ -288,18 +342,21 @@ def VmmPyPlugin_FileRegisterDirectory(pid, path, fn_list_callback = None, is_ove
     fn_list_callback = callback function for dynamic directory listing.
     is_overwrite -- overwrise allowed?
     """
-    dir_entry = VmmPyPlugin_RootDirectoryRoot if (pid == None or pid == False) else VmmPyPlugin_RootDirectoryProcess
+    is_root = (pid == None or pid == False)
+    dir_entry = VmmPyPlugin_RootDirectoryRoot if is_root else VmmPyPlugin_RootDirectoryProcess
     path_items = list(filter(None, path.split('/')))
     dir_to_reg = path_items.pop()
-    for path_item in path_items:
+    for i, path_item in enumerate(path_items):
         if not path_item in dir_entry:
             dir_entry[path_item] = {'list': None, 'dirs': {}}
+            VMMPYCC_StaticRegister(is_root, '/'.join(path_items[:i+1]), 0, True, False, False)
         if dir_entry[path_item]['list'] != None:
             raise RuntimeError('VmmPyPlugin_FileRegisterDirectory: cannot add directory entry to sub-directory with dynamic listing.')
         dir_entry = dir_entry[path_item]['dirs']
     if not is_overwrite and dir_to_reg in dir_entry:
         raise RuntimeError('VmmPyPlugin_FileRegisterDirectory: cannot overwrite existing directory without is_overwrite flag set.')
     dir_entry[dir_to_reg] = {'list': fn_list_callback, 'dirs': {}}
+    VMMPYCC_StaticRegister(is_root, path, 0, True, fn_list_callback != None, False)
 
 
 
@@ -320,6 +377,20 @@ def VmmPyPlugin_FileUnregister(pid, path):
     if not entry in dir_entry:
         raise RuntimeError('VmmPyPlugin_FileUnregister: cannot remove non-existant directory/file.')
     del dir_entry[entry]
+    VMMPYCC_StaticUnregister(pid == None or pid == False, path)
+
+
+
+def VmmPyPlugin_FileInvalidate(pid, path = None):
+    """Invalidate natively cached file contents and directory listings.
+    Should be called whenever the contents of a file registered with the
+    is_cacheable flag set changes.
+
+    Keyword arguments:
+    pid -- int: process identifier (PID), None/False for root.
+    path -- str: the file or directory to invalidate, None for everything.
+    """
+    VMMPYCC_Invalidate(pid == None or pid == False, path)
 
 
 
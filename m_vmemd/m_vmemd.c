@@ -92,20 +92,38 @@ PVOID VMemD_Util_qfind(_In_ PVOID pvFind, _In_ DWORD cMap, _In_ PVOID pvMap, _In
     return NULL;
 }
 
-/*
-* Comparator function for VMemD_Util_qfind to serach entries in PTEMAP.
-*/
-int VMemD_ReadPte_CmpFind(_In_ QWORD vaFind, _In_ PVMMDLL_MAP_PTEENTRY pEntry)
-{
-    if(pEntry->vaBase > vaFind) { return -1; }
-    if(pEntry->vaBase < vaFind) { return 1; }
-    return 0;
-}
+// ----------------------------------------------------------------------------
+// Per-process memory range index below:
+// Each read/write of a vmemd file previously retrieved and copied the whole
+// PTE/VAD map of the process. The range index keeps a compact sorted copy of
+// the [start, end) ranges of the most recently used processes instead. The
+// index is invalidated on process refresh by the notify callback.
+// ----------------------------------------------------------------------------
+
+#define VMEMD_INDEX_CACHE_ENTRIES       0x10
+#define VMEMD_READ_LARGE_THRESHOLD      0x00100000      // reads of 1MB or larger do not populate the vmm data cache.
+
+typedef struct tdVMEMD_RANGE {
+    QWORD vaStart;
+    QWORD vaEnd;                        // exclusive end address
+} VMEMD_RANGE, *PVMEMD_RANGE;
+
+typedef struct tdVMEMD_INDEX {
+    DWORD dwPID;
+    BOOL fVad;
+    QWORD qwTickLastUse;
+    DWORD cRange;
+    VMEMD_RANGE pRange[];
+} VMEMD_INDEX, *PVMEMD_INDEX;
+
+SRWLOCK g_VMemD_IndexLock = SRWLOCK_INIT;
+DWORD g_VMemD_IndexGeneration = 0;
+PVMEMD_INDEX g_VMemD_Index[VMEMD_INDEX_CACHE_ENTRIES] = { 0 };
 
 /*
-* Comparator function for VMemD_Util_qfind to serach entries in VADMAP.
+* Comparator function for VMemD_Util_qfind to search entries in the range index.
 */
-int VMemD_ReadVad_CmpFind(_In_ QWORD vaFind, _In_ PVMMDLL_MAP_VADENTRY pEntry)
+int VMemD_Range_CmpFind(_In_ QWORD vaFind, _In_ PVMEMD_RANGE pEntry)
 {
     if(pEntry->vaStart > vaFind) { return -1; }
     if(pEntry->vaStart < vaFind) { return 1; }
@@ -113,79 +131,157 @@ int VMemD_ReadVad_CmpFind(_In_ QWORD vaFind, _In_ PVMMDLL_MAP_VADENTRY pEntry)
 }
 
 /*
-* Read/Write virtual memory inside a memory map entry of PTE-type.
+* Create a new range index from the PTE or VAD map of a process.
+* CALLER LocalFree: return
+* -- dwPID
+* -- fVad
+* -- return
 */
-NTSTATUS VMemD_ReadWritePte(_In_ DWORD dwPID, _In_ QWORD vaBase, _In_ BOOL fRead, _Out_writes_bytes_(*pcbReadWrite) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbReadWrite, _In_ ULONG64 cbOffset)
+_Success_(return != NULL)
+PVMEMD_INDEX VMemD_Index_Create(_In_ DWORD dwPID, _In_ BOOL fVad)
 {
-    NTSTATUS nt = VMMDLL_STATUS_FILE_INVALID;
-    BOOL result;
-    QWORD cbMax;
-    DWORD cbPteMap = 0;
+    DWORD i, cbMap = 0;
     PVMMDLL_MAP_PTE pPteMap = NULL;
-    PVMMDLL_MAP_PTEENTRY pe = NULL;
-    // read memory from "vmemd" directory file - "pte mapped"
-    *pcbReadWrite = 0;
-    result =
-        VMMDLL_ProcessMap_GetPte(dwPID, NULL, &cbPteMap, FALSE) &&
-        (pPteMap = LocalAlloc(0, cbPteMap)) &&
-        VMMDLL_ProcessMap_GetPte(dwPID, pPteMap, &cbPteMap, FALSE) &&
-        (pe = VMemD_Util_qfind((PVOID)vaBase, pPteMap->cMap, pPteMap->pMap, sizeof(VMMDLL_MAP_PTEENTRY), (int(*)(PVOID, PVOID))VMemD_ReadPte_CmpFind));
-    if(!result) { goto fail; }
-    if(pe->vaBase + (pe->cPages << 12) <= vaBase + cbOffset) {
-        nt = VMMDLL_STATUS_END_OF_FILE;
-        goto fail;
-    }
-    cbMax = min((pe->vaBase + (pe->cPages << 12)), (vaBase + cb + cbOffset)) - (vaBase + cbOffset);   // min(entry_top_addr, request_top_addr) - request_start_addr
-    if(fRead) {
-        result = VMMDLL_MemReadEx(dwPID, vaBase + cbOffset, pb, (DWORD)min(cb, cbMax), NULL, VMMDLL_FLAG_ZEROPAD_ON_FAIL);
-        *pcbReadWrite = (DWORD)min(cb, cbMax);
-        nt = (result && *pcbReadWrite) ? VMMDLL_STATUS_SUCCESS : VMMDLL_STATUS_END_OF_FILE;
+    PVMMDLL_MAP_VAD pVadMap = NULL;
+    PVMEMD_INDEX pIndex = NULL;
+    if(fVad) {
+        if(!VMMDLL_ProcessMap_GetVad(dwPID, NULL, &cbMap, FALSE) || !(pVadMap = LocalAlloc(0, cbMap))) { goto fail; }
+        if(!VMMDLL_ProcessMap_GetVad(dwPID, pVadMap, &cbMap, FALSE)) { goto fail; }
+        if(!(pIndex = LocalAlloc(0, sizeof(VMEMD_INDEX) + pVadMap->cMap * sizeof(VMEMD_RANGE)))) { goto fail; }
+        pIndex->cRange = pVadMap->cMap;
+        for(i = 0; i < pVadMap->cMap; i++) {
+            pIndex->pRange[i].vaStart = pVadMap->pMap[i].vaStart;
+            pIndex->pRange[i].vaEnd = pVadMap->pMap[i].vaEnd + 1;
+        }
     } else {
-        VMMDLL_MemWrite(dwPID, vaBase + cbOffset, pb, (DWORD)min(cb, cbMax));
-        *pcbReadWrite = cb;
-        nt = VMMDLL_STATUS_SUCCESS;
+        if(!VMMDLL_ProcessMap_GetPte(dwPID, NULL, &cbMap, FALSE) || !(pPteMap = LocalAlloc(0, cbMap))) { goto fail; }
+        if(!VMMDLL_ProcessMap_GetPte(dwPID, pPteMap, &cbMap, FALSE)) { goto fail; }
+        if(!(pIndex = LocalAlloc(0, sizeof(VMEMD_INDEX) + pPteMap->cMap * sizeof(VMEMD_RANGE)))) { goto fail; }
+        pIndex->cRange = pPteMap->cMap;
+        for(i = 0; i < pPteMap->cMap; i++) {
+            pIndex->pRange[i].vaStart = pPteMap->pMap[i].vaBase;
+            pIndex->pRange[i].vaEnd = pPteMap->pMap[i].vaBase + (pPteMap->pMap[i].cPages << 12);
+        }
     }
+    pIndex->dwPID = dwPID;
+    pIndex->fVad = fVad;
+    pIndex->qwTickLastUse = GetTickCount64();
 fail:
     LocalFree(pPteMap);
-    return nt;
+    LocalFree(pVadMap);
+    return pIndex;
 }
 
 /*
-* Read/Write virtual memory inside a memory map entry of VAD-type.
+* Look up a range starting at vaBase in the cached index of a process.
+* -- dwPID
+* -- fVad
+* -- vaBase
+* -- pRange = receives the range on success.
+* -- return = TRUE if the process index exists in the cache (even if the range
+*             was not found in it; check pRange->vaEnd in that case).
 */
-NTSTATUS VMemD_ReadWriteVad(_In_ DWORD dwPID, _In_ QWORD vaBase, _In_ BOOL fRead, _Out_writes_bytes_(*pcbReadWrite) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbReadWrite, _In_ ULONG64 cbOffset)
+_Success_(return)
+BOOL VMemD_Index_LookupCached(_In_ DWORD dwPID, _In_ BOOL fVad, _In_ QWORD vaBase, _Out_ PVMEMD_RANGE pRange)
+{
+    DWORD i;
+    BOOL fResult = FALSE;
+    PVMEMD_INDEX pIndex;
+    PVMEMD_RANGE pe;
+    ZeroMemory(pRange, sizeof(VMEMD_RANGE));
+    AcquireSRWLockShared(&g_VMemD_IndexLock);
+    for(i = 0; i < VMEMD_INDEX_CACHE_ENTRIES; i++) {
+        pIndex = g_VMemD_Index[i];
+        if(!pIndex || (pIndex->dwPID != dwPID) || (pIndex->fVad != fVad)) { continue; }
+        if((pe = VMemD_Util_qfind((PVOID)vaBase, pIndex->cRange, pIndex->pRange, sizeof(VMEMD_RANGE), (int(*)(PVOID, PVOID))VMemD_Range_CmpFind))) {
+            *pRange = *pe;
+        }
+        pIndex->qwTickLastUse = GetTickCount64();   // benign race - lru hint only
+        fResult = TRUE;
+        break;
+    }
+    ReleaseSRWLockShared(&g_VMemD_IndexLock);
+    return fResult;
+}
+
+/*
+* Retrieve the memory range starting at vaBase from the PTE or VAD map of a
+* process. The process range index is created and cached on first use.
+* -- dwPID
+* -- fVad
+* -- vaBase
+* -- pRange
+* -- return
+*/
+_Success_(return)
+BOOL VMemD_Index_GetRange(_In_ DWORD dwPID, _In_ BOOL fVad, _In_ QWORD vaBase, _Out_ PVMEMD_RANGE pRange)
+{
+    DWORD i, iSlot = 0, dwGeneration;
+    PVMEMD_INDEX pIndex;
+    PVMEMD_RANGE pe;
+    if(VMemD_Index_LookupCached(dwPID, fVad, vaBase, pRange)) {
+        return pRange->vaEnd ? TRUE : FALSE;
+    }
+    dwGeneration = g_VMemD_IndexGeneration;
+    if(!(pIndex = VMemD_Index_Create(dwPID, fVad))) { return FALSE; }
+    if((pe = VMemD_Util_qfind((PVOID)vaBase, pIndex->cRange, pIndex->pRange, sizeof(VMEMD_RANGE), (int(*)(PVOID, PVOID))VMemD_Range_CmpFind))) {
+        *pRange = *pe;
+    }
+    AcquireSRWLockExclusive(&g_VMemD_IndexLock);
+    if(dwGeneration == g_VMemD_IndexGeneration) {
+        // replace an existing index of the same process or the least recently used one.
+        for(i = 0; i < VMEMD_INDEX_CACHE_ENTRIES; i++) {
+            if(!g_VMemD_Index[i]) { iSlot = i; break; }
+            if((g_VMemD_Index[i]->dwPID == dwPID) && (g_VMemD_Index[i]->fVad == fVad)) { iSlot = i; break; }
+            if(g_VMemD_Index[i]->qwTickLastUse < g_VMemD_Index[iSlot]->qwTickLastUse) { iSlot = i; }
+        }
+        LocalFree(g_VMemD_Index[iSlot]);
+        g_VMemD_Index[iSlot] = pIndex;
+        pIndex = NULL;
+    }
+    ReleaseSRWLockExclusive(&g_VMemD_IndexLock);
+    LocalFree(pIndex);
+    return pRange->vaEnd ? TRUE : FALSE;
+}
+
+/*
+* Invalidate all cached range indexes.
+*/
+VOID VMemD_Index_Clear()
+{
+    DWORD i;
+    AcquireSRWLockExclusive(&g_VMemD_IndexLock);
+    g_VMemD_IndexGeneration++;
+    for(i = 0; i < VMEMD_INDEX_CACHE_ENTRIES; i++) {
+        LocalFree(g_VMemD_Index[i]);
+        g_VMemD_Index[i] = NULL;
+    }
+    ReleaseSRWLockExclusive(&g_VMemD_IndexLock);
+}
+
+/*
+* Read/Write virtual memory inside a memory map entry of PTE-type or VAD-type.
+* Reads are passed straight through to the caller buffer; large reads do not
+* populate the vmm data cache to avoid evicting the working set of other users.
+*/
+NTSTATUS VMemD_ReadWrite(_In_ DWORD dwPID, _In_ QWORD vaBase, _In_ BOOL fVad, _In_ BOOL fRead, _Out_writes_bytes_(*pcbReadWrite) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbReadWrite, _In_ ULONG64 cbOffset)
 {
-    NTSTATUS nt = VMMDLL_STATUS_FILE_INVALID;
     BOOL result;
     QWORD cbMax;
-    DWORD cbVadMap = 0;
-    PVMMDLL_MAP_VAD pVadMap = NULL;
-    PVMMDLL_MAP_VADENTRY pe = NULL;
-    // read memory from "vmemd" directory file - "pte mapped"
+    VMEMD_RANGE Range;
     *pcbReadWrite = 0;
-    result =
-        VMMDLL_ProcessMap_GetVad(dwPID, NULL, &cbVadMap, FALSE) &&
-        (pVadMap = LocalAlloc(0, cbVadMap)) &&
-        VMMDLL_ProcessMap_GetVad(dwPID, pVadMap, &cbVadMap, FALSE) &&
-        (pe = VMemD_Util_qfind((PVOID)vaBase, pVadMap->cMap, pVadMap->pMap, sizeof(VMMDLL_MAP_VADENTRY), (int(*)(PVOID, PVOID))VMemD_ReadVad_CmpFind));
-    if(!result) { goto fail; }
-    if(pe->vaEnd <= vaBase + cbOffset) {
-        nt = VMMDLL_STATUS_END_OF_FILE;
-        goto fail;
-    }
-    cbMax = min(pe->vaEnd + 1, (vaBase + cb + cbOffset)) - (vaBase + cbOffset);   // min(entry_top_addr, request_top_addr) - request_start_addr
+    if(!VMemD_Index_GetRange(dwPID, fVad, vaBase, &Range)) { return VMMDLL_STATUS_FILE_INVALID; }
+    if(Range.vaEnd <= vaBase + cbOffset) { return VMMDLL_STATUS_END_OF_FILE; }
+    cbMax = min(Range.vaEnd, (vaBase + cb + cbOffset)) - (vaBase + cbOffset);   // min(entry_top_addr, request_top_addr) - request_start_addr
     if(fRead) {
-        result = VMMDLL_MemReadEx(dwPID, vaBase + cbOffset, pb, (DWORD)min(cb, cbMax), NULL, VMMDLL_FLAG_ZEROPAD_ON_FAIL);
+        result = VMMDLL_MemReadEx(dwPID, vaBase + cbOffset, pb, (DWORD)min(cb, cbMax), NULL, VMMDLL_FLAG_ZEROPAD_ON_FAIL | ((cb >= VMEMD_READ_LARGE_THRESHOLD) ? VMMDLL_FLAG_NOCACHEPUT : 0));
         *pcbReadWrite = (DWORD)min(cb, cbMax);
-        nt = (result && *pcbReadWrite) ? VMMDLL_STATUS_SUCCESS : VMMDLL_STATUS_END_OF_FILE;
+        return (result && *pcbReadWrite) ? VMMDLL_STATUS_SUCCESS : VMMDLL_STATUS_END_OF_FILE;
     } else {
         VMMDLL_MemWrite(dwPID, vaBase + cbOffset, pb, (DWORD)min(cb, cbMax));
         *pcbReadWrite = cb;
-        nt = VMMDLL_STATUS_SUCCESS;
+        return VMMDLL_STATUS_SUCCESS;
     }
-fail:
-    LocalFree(pVadMap);
-    return nt;
 }
 
 /*
@@ -203,9 +299,7 @@ NTSTATUS VMemD_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_ LPVOID pb, _In_ DWORD
     BOOL fVad;
     QWORD vaBase;
     if(!VMemD_GetBaseAndTypeFromFileName(ctx->wszPath, &vaBase, &fVad)) { return VMMDLL_STATUS_FILE_INVALID; }
-    return fVad ?
-        VMemD_ReadWriteVad(ctx->dwPID, vaBase, TRUE, pb, cb, pcbRead, cbOffset) :
-        VMemD_ReadWritePte(ctx->dwPID, vaBase, TRUE, pb, cb, pcbRead, cbOffset);
+    return VMemD_ReadWrite(ctx->dwPID, vaBase, fVad, TRUE, pb, cb, pcbRead, cbOffset);
 }
 
 /*
@@ -223,9 +317,7 @@ NTSTATUS VMemD_WritePte(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _In_ LPVOID pb, _In_ DW
     BOOL fVad;
     QWORD vaBase;
     if(!VMemD_GetBaseAndTypeFromFileName(ctx->wszPath, &vaBase, &fVad)) { return VMMDLL_STATUS_FILE_INVALID; }
-    return fVad ?
-        VMemD_ReadWriteVad(ctx->dwPID, vaBase, FALSE, pb, cb, pcbWrite, cbOffset) :
-        VMemD_ReadWritePte(ctx->dwPID, vaBase, FALSE, pb, cb, pcbWrite, cbOffset);
+    return VMemD_ReadWrite(ctx->dwPID, vaBase, fVad, FALSE, pb, cb, pcbWrite, cbOffset);
 }
 
 /*
@@ -315,6 +407,28 @@ fail:
     return fResult;
 }
 
+/*
+* Notify : function as specified by the module manager. Cached range indexes
+* are invalidated whenever the process maps may have been refreshed.
+* -- fEvent
+* -- pvEvent
+* -- cbEvent
+*/
+VOID VMemD_Notify(_In_ DWORD fEvent, _In_opt_ PVOID pvEvent, _In_opt_ DWORD cbEvent)
+{
+    if((fEvent == VMMDLL_PLUGIN_NOTIFY_REFRESH_FAST) || (fEvent == VMMDLL_PLUGIN_NOTIFY_REFRESH_MEDIUM)) {
+        VMemD_Index_Clear();
+    }
+}
+
+/*
+* Close : function as specified by the module manager.
+*/
+VOID VMemD_Close()
+{
+    VMemD_Index_Clear();
+}
+
 /*
 * Initialization function for the vmemd native plugin module.
 * It's important that the function is exported in the DLL and that it is
@@ -337,5 +451,7 @@ VOID InitializeVmmPlugin(_In_ PVMMDLL_PLUGIN_REGINFO pRegInfo)
     pRegInfo->reg_fn.pfnList = VMemD_List;                      // List function supported.
     pRegInfo->reg_fn.pfnRead = VMemD_Read;                      // Read function supported.
     pRegInfo->reg_fn.pfnWrite = VMemD_WritePte;                    // Write function supported.
+    pRegInfo->reg_fn.pfnNotify = VMemD_Notify;                  // Notify function supported.
+    pRegInfo->reg_fn.pfnClose = VMemD_Close;                    // Close function supported.
     pRegInfo->pfnPluginManager_Register(pRegInfo);              // Register with the plugin maanger.
 }
@@ -19,30 +19,54 @@ static LPSTR FC_SQL_SCHEMA_PROCESS =
     "DROP VIEW IF EXISTS v_process; " \
     "CREATE VIEW v_process AS SELECT p.*, sn.csz AS csz_name, sn.cbu AS cbu_name, sn.cbj AS cbj_name, sn.sz AS sz_name, sp.csz AS csz_path, sp.cbu AS cbu_path, sp.cbj AS cbj_path, sp.sz AS sz_path, su.csz AS csz_user, su.cbu AS cbu_user, su.cbj AS cbj_user, su.sz AS sz_user, sa.csz AS csz_all, sa.cbu AS cbu_all, sa.cbj AS cbj_all, sa.sz AS sz_all FROM process p, str sn, str sp, str su, str sa WHERE p.id_str_name = sn.id AND p.id_str_path = sp.id AND p.id_str_user = su.id AND  p.id_str_all = sa.id; ";
 
+typedef struct tdMFCPROC_ENTRY {
+    PVMM_PROCESS pProcess;
+    BOOL fWellKnownAccount;
+    WCHAR wszUserName[MAX_PATH];
+} MFCPROC_ENTRY, *PMFCPROC_ENTRY;
+
 /*
 * Forensic initialization function called when the forensic sub-system is initializing.
+* Processes and their user names are collected into memory first - the shared
+* database connection is then reserved only for the insert transaction.
 */
 PVOID M_FcProc_FcInitialize()
 {
     int rc;
-    BOOL fWellKnownAccount = FALSE;
+    DWORD i, cEntry = 0;
+    SIZE_T cProcess = 0;
+    PMFCPROC_ENTRY pe, pEntries = NULL;
     PVMM_PROCESS pObProcess = NULL;
     sqlite3 *hSql = NULL;
     sqlite3_stmt *hStmt = NULL, *hStmtStr = NULL;
     FCSQL_INSERTSTRTABLE SqlStrInsert[4];
-    WCHAR wszUserName[MAX_PATH], wszFullInfo[2048];
+    WCHAR wszFullInfo[2048];
     if(SQLITE_OK != Fc_SqlExec(FC_SQL_SCHEMA_PROCESS)) { goto fail; }
+    // 1: collect processes and resolve user names (may read memory).
+    VmmProcessListPIDs(NULL, &cProcess, VMM_FLAG_PROCESS_SHOW_TERMINATED);
+    if(!cProcess || !(pEntries = LocalAlloc(LMEM_ZEROINIT, cProcess * sizeof(MFCPROC_ENTRY)))) { goto fail; }
+    while((cEntry < cProcess) && (pObProcess = VmmProcessGetNext(pObProcess, VMM_FLAG_PROCESS_TOKEN | VMM_FLAG_PROCESS_SHOW_TERMINATED))) {
+        pe = pEntries + cEntry++;
+        pe->pProcess = Ob_INCREF(pObProcess);
+        if(!pObProcess->win.TOKEN.fSID || !VmmWinUser_GetNameW(&pObProcess->win.TOKEN.SID, pe->wszUserName, MAX_PATH, NULL, &pe->fWellKnownAccount)) {
+            pe->wszUserName[0] = 0;
+            pe->fWellKnownAccount = FALSE;
+        }
+    }
+    Ob_DECREF_NULL(&pObProcess);
+    // 2: insert collected processes into the database in one transaction.
     if(!(hSql = Fc_SqlReserve())) { goto fail; }
     if(SQLITE_OK != sqlite3_prepare_v2(hSql, "INSERT INTO process (id_str_name, id_str_path, id_str_user, id_str_all, pid, ppid, eprocess, dtb, dtb_user, state, wow64, peb, peb32, time_create, time_exit) VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);", -1, &hStmt, NULL)) { goto fail; }
     if(SQLITE_OK != sqlite3_prepare_v2(hSql, "INSERT INTO str (id, osz, csz, cbu, cbj, sz) VALUES (?, ?, ?, ?, ?, ?);", -1, &hStmtStr, NULL)) { goto fail; }
     sqlite3_exec(hSql, "BEGIN TRANSACTION", NULL, NULL, NULL);
-    while(pObProcess = VmmProcessGetNext(pObProcess, VMM_FLAG_PROCESS_TOKEN | VMM_FLAG_PROCESS_SHOW_TERMINATED)) {
+    for(i = 0; i < cEntry; i++) {
+        pe = pEntries + i;
+        pObProcess = pe->pProcess;
         // build and insert string data into 'str' table.
         if(!Fc_SqlInsertStr(hStmtStr, pObProcess->pObPersistent->wszNameLong, 0, &SqlStrInsert[0])) { goto fail_transact; }
         if(!Fc_SqlInsertStr(hStmtStr, pObProcess->pObPersistent->wszPathKernel, 0, &SqlStrInsert[1])) { goto fail_transact; }
-        if(!pObProcess->win.TOKEN.fSID || !VmmWinUser_GetNameW(&pObProcess->win.TOKEN.SID, wszUserName, MAX_PATH, NULL, &fWellKnownAccount)) { wszUserName[0] = 0; }
-        if(!Fc_SqlInsertStr(hStmtStr, wszUserName, 0, &SqlStrInsert[2])) { goto fail_transact; }
-        _snwprintf_s(wszFullInfo, 2048 - 2, 2048 - 3, L"%s [%s%s] %s", pObProcess->pObPersistent->wszNameLong, (fWellKnownAccount ? L"*" : L""), wszUserName, pObProcess->pObPersistent->wszPathKernel);
+        if(!Fc_SqlInsertStr(hStmtStr, pe->wszUserName, 0, &SqlStrInsert[2])) { goto fail_transact; }
+        _snwprintf_s(wszFullInfo, 2048 - 2, 2048 - 3, L"%s [%s%s] %s", pObProcess->pObPersistent->wszNameLong, (pe->fWellKnownAccount ? L"*" : L""), pe->wszUserName, pObProcess->pObPersistent->wszPathKernel);
         if(!Fc_SqlInsertStr(hStmtStr, wszFullInfo, 0, &SqlStrInsert[3])) { goto fail_transact; }
         // insert into 'process' table.
         sqlite3_reset(hStmt);
@@ -68,10 +92,15 @@ PVOID M_FcProc_FcInitialize()
     }
     sqlite3_exec(hSql, "COMMIT TRANSACTION", NULL, NULL, NULL);
 fail:
-    Ob_DECREF(pObProcess);
     sqlite3_finalize(hStmt);
     sqlite3_finalize(hStmtStr);
     Fc_SqlReserveReturn(hSql);
+    if(pEntries) {
+        for(i = 0; i < cEntry; i++) {
+            Ob_DECREF(pEntries[i].pProcess);
+        }
+        LocalFree(pEntries);
+    }
     return NULL;
 fail_transact:
     sqlite3_exec(hSql, "COMMIT TRANSACTION", NULL, NULL, NULL);
@@ -43,18 +43,25 @@ VOID M_FcRegistry_FcInitialize_Callback(_In_ HANDLE hCallback1, _In_ HANDLE hCal
 */
 PVOID M_FcRegistry_FcInitialize()
 {
+    DWORD cHive = 0;
+    QWORD tcStart = GetTickCount64(), tcSnapshot;
     POB_REGISTRY_HIVE pObHive = NULL;
     sqlite3 *hSql = NULL;
     sqlite3_stmt *hStmt = NULL, *hStmtStr = NULL;
     if(SQLITE_OK != Fc_SqlExec(FC_SQL_SCHEMA_REGISTRY)) { goto fail; }
+    // snapshot hives and build key trees in parallel before the (serial) sql insert.
+    VmmWinReg_HiveSnapshotEnsureAll();
+    tcSnapshot = GetTickCount64();
     if(!(hSql = Fc_SqlReserve())) { goto fail; }
     if(SQLITE_OK != sqlite3_prepare_v2(hSql, "INSERT INTO registry (id_str, hive, cell, cell_parent, time) VALUES (?, ?, ?, ?, ?);", -1, &hStmt, NULL)) { goto fail; }
     if(SQLITE_OK != sqlite3_prepare_v2(hSql, "INSERT INTO str (id, osz, csz, cbu, cbj, sz) VALUES (?, ?, ?, ?, ?, ?);", -1, &hStmtStr, NULL)) { goto fail; }
     sqlite3_exec(hSql, "BEGIN TRANSACTION", NULL, NULL, NULL);
     while(pObHive = VmmWinReg_HiveGetNext(pObHive)) {
         VmmWinReg_ForensicGetAllKeys(pObHive, hStmt, hStmtStr, M_FcRegistry_FcInitialize_Callback);
+        cHive++;
     }
     sqlite3_exec(hSql, "COMMIT TRANSACTION", NULL, NULL, NULL);
+    vmmprintfv_fn("hives: %i snapshot: %llims total: %llims\n", cHive, tcSnapshot - tcStart, GetTickCount64() - tcStart);
 fail:
     Ob_DECREF(pObHive);
     sqlite3_finalize(hStmt);
@@ -18,50 +18,76 @@ static LPSTR FC_SQL_SCHEMA_THREAD =
     "DROP VIEW IF EXISTS v_thread; " \
     "CREATE VIEW v_thread AS SELECT t.*, str.* FROM thread t, str WHERE t.id_str = str.id; ";
 
+/*
+* Worker thread callback: retrieve the thread map of a single process. The map
+* is cached in the process object so that the later sequential database insert
+* does not have to wait for the memory analysis to complete.
+* -- pProcess
+* -- pv
+*/
 VOID M_FcThread_FcInitialize_ThreadProc(_In_ PVMM_PROCESS pProcess, _In_ PVOID pv)
+{
+    PVMMOB_MAP_THREAD pObThreadMap = NULL;
+    VmmMap_GetThread(pProcess, &pObThreadMap);
+    Ob_DECREF(pObThreadMap);
+}
+
+/*
+* Forensic initialization function called when the forensic sub-system is initializing.
+* Thread maps are retrieved in parallel; all threads are then inserted into the
+* database by a single connection in a single transaction.
+*/
+PVOID M_FcThread_FcInitialize()
 {
     int rc;
+    DWORD i;
     sqlite3 *hSql = NULL;
     sqlite3_stmt *hStmt = NULL, *hStmtStr = NULL;
-    DWORD i;
+    PVMM_PROCESS pObProcess = NULL;
     PVMMOB_MAP_THREAD pObThreadMap = NULL;
     PVMM_MAP_THREADENTRY pe;
     WCHAR wszStr[MAX_PATH];
     FCSQL_INSERTSTRTABLE SqlStrInsert;
-    if(!VmmMap_GetThread(pProcess, &pObThreadMap)) { goto fail; }
+    if(SQLITE_OK != Fc_SqlExec(FC_SQL_SCHEMA_THREAD)) { return NULL; }
+    VmmProcessActionForeachParallel(NULL, VmmProcessActionForeachParallel_CriteriaActiveOnly, M_FcThread_FcInitialize_ThreadProc);
     if(!(hSql = Fc_SqlReserve())) { goto fail; }
     if(SQLITE_OK != sqlite3_prepare_v2(hSql, "INSERT INTO thread (id_str, pid, tid, ethread, teb, state, exitstatus, running, prio, priobase, startaddr, stackbase_u, stacklimit_u, stackbase_k, stacklimit_k, trapframe, sp, ip, time_create, time_exit) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);", -1, &hStmt, NULL)) { goto fail; }
     if(SQLITE_OK != sqlite3_prepare_v2(hSql, "INSERT INTO str (id, osz, csz, cbu, cbj, sz) VALUES (?, ?, ?, ?, ?, ?);", -1, &hStmtStr, NULL)) { goto fail; }
     sqlite3_exec(hSql, "BEGIN TRANSACTION", NULL, NULL, NULL);
-    for(i = 0; i < pObThreadMap->cMap; i++) {
-        pe = pObThreadMap->pMap + i;
-        swprintf(wszStr, _countof(wszStr), L"TID: %i", pe->dwTID);
-        if(!Fc_SqlInsertStr(hStmtStr, wszStr, 0, &SqlStrInsert)) { goto fail_transact; }
-        sqlite3_reset(hStmt);
-        rc = Fc_SqlBindMultiInt64(hStmt, 1, 20,
-            SqlStrInsert.id,
-            (QWORD)pe->dwPID,
-            (QWORD)pe->dwTID,
-            pe->vaETHREAD,
-            pe->vaTeb,
-            (QWORD)pe->bState,
-            (QWORD)pe->dwExitStatus,
-            (QWORD)pe->bRunning,
-            (QWORD)pe->bPriority,
-            (QWORD)pe->bBasePriority,
-            pe->vaStartAddress,
-            pe->vaStackBaseUser,
-            pe->vaStackLimitUser,
-            pe->vaStackBaseKernel,
-            pe->vaStackLimitKernel,
-            pe->vaTrapFrame,
-            pe->vaRSP,
-            pe->vaRIP,
-            pe->ftCreateTime,
-            pe->ftExitTime
-        );
-        if(SQLITE_OK != rc) { goto fail_transact; }
-        sqlite3_step(hStmt);
+    while((pObProcess = VmmProcessGetNext(pObProcess, 0))) {
+        if(!VmmProcessActionForeachParallel_CriteriaActiveOnly(pObProcess, NULL)) { continue; }
+        if(!VmmMap_GetThread(pObProcess, &pObThreadMap)) { continue; }
+        for(i = 0; i < pObThreadMap->cMap; i++) {
+            pe = pObThreadMap->pMap + i;
+            swprintf(wszStr, _countof(wszStr), L"TID: %i", pe->dwTID);
+            if(!Fc_SqlInsertStr(hStmtStr, wszStr, 0, &SqlStrInsert)) { goto fail_transact; }
+            sqlite3_reset(hStmt);
+            rc = Fc_SqlBindMultiInt64(hStmt, 1, 20,
+                SqlStrInsert.id,
+                (QWORD)pe->dwPID,
+                (QWORD)pe->dwTID,
+                pe->vaETHREAD,
+                pe->vaTeb,
+                (QWORD)pe->bState,
+                (QWORD)pe->dwExitStatus,
+                (QWORD)pe->bRunning,
+                (QWORD)pe->bPriority,
+                (QWORD)pe->bBasePriority,
+                pe->vaStartAddress,
+                pe->vaStackBaseUser,
+                pe->vaStackLimitUser,
+                pe->vaStackBaseKernel,
+                pe->vaStackLimitKernel,
+                pe->vaTrapFrame,
+                pe->vaRSP,
+                pe->vaRIP,
+                pe->ftCreateTime,
+                pe->ftExitTime
+            );
+            if(SQLITE_OK != rc) { goto fail_transact; }
+            sqlite3_step(hStmt);
+        }
+        Ob_DECREF_NULL(&pObThreadMap);
     }
 fail_transact:
     sqlite3_exec(hSql, "COMMIT TRANSACTION", NULL, NULL, NULL);
@@ -70,16 +96,7 @@ fail:
     sqlite3_finalize(hStmtStr);
     Fc_SqlReserveReturn(hSql);
     Ob_DECREF(pObThreadMap);
-    return;
-}
-
-/*
-* Forensic initialization function called when the forensic sub-system is initializing.
-*/
-PVOID M_FcThread_FcInitialize()
-{
-    if(SQLITE_OK != Fc_SqlExec(FC_SQL_SCHEMA_THREAD)) { return NULL; }
-    VmmProcessActionForeachParallel(NULL, VmmProcessActionForeachParallel_CriteriaActiveOnly, M_FcThread_FcInitialize_ThreadProc);
+    Ob_DECREF(pObProcess);
     return NULL;
 }
 
@@ -1,4 +1,5 @@
-// m_file_handles_vads.c : implementation of the 'files/handles/vads' built-in module.
+// m_file_handles_vads.c : implementation of the 'files/handles/vads' built-in module
+//                         and the system-wide root 'files' built-in module.
 //
 // (c) Ulf Frisk, 2020
 // Author: Ulf Frisk, pcileech@frizk.net
@@ -10,8 +11,29 @@
 #include "vmmwin.h"
 #include "vmmwinobj.h"
 
+#define M_FILEHANDLESVADS_SOURCE_VADS       0   // files from process vads
+#define M_FILEHANDLESVADS_SOURCE_HANDLES    1   // files from process handles
+#define M_FILEHANDLESVADS_SOURCE_ALL        2   // files from all processes (system-wide)
+
+/*
+* Retrieve the files of a module map source.
+* CALLER DECREF: *ppmObFiles
+* -- ctx
+* -- tpSource = M_FILEHANDLESVADS_SOURCE_*
+* -- ppmObFiles
+* -- return
+*/
+_Success_(return)
+BOOL M_FileHandlesVads_GetFiles(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _In_ DWORD tpSource, _Out_ POB_MAP *ppmObFiles)
+{
+    if(tpSource == M_FILEHANDLESVADS_SOURCE_ALL) {
+        return VmmWinObjFile_GetAll(ppmObFiles);
+    }
+    return VmmWinObjFile_GetByProcess(ctx->pProcess, ppmObFiles, (tpSource == M_FILEHANDLESVADS_SOURCE_HANDLES));
+}
+
 _Success_(return == 0)
-NTSTATUS M_FileHandlesVads_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset, _In_ BOOL fHandles)
+NTSTATUS M_FileHandlesVads_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset, _In_ DWORD tpSource)
 {
     QWORD va;
     POB_MAP pmObFiles = NULL;
@@ -19,7 +41,7 @@ NTSTATUS M_FileHandlesVads_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_
     *pcbRead = 0;
     if(!(va = wcstoull(ctx->wszPath, NULL, 16))) { return VMMDLL_STATUS_FILE_INVALID; }
     if(!(pOb = VmmWinObj_Get(va))) {
-        VmmWinObjFile_GetByProcess(ctx->pProcess, &pmObFiles, fHandles);
+        M_FileHandlesVads_GetFiles(ctx, tpSource, &pmObFiles);
         Ob_DECREF_NULL(&pmObFiles);
         pOb = VmmWinObj_Get(va);
     }
@@ -36,25 +58,32 @@ NTSTATUS M_FileHandlesVads_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_
 _Success_(return == 0)
 NTSTATUS M_FileHandles_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
 {
-    return M_FileHandlesVads_Read(ctx, pb, cb, pcbRead, cbOffset, TRUE);
+    return M_FileHandlesVads_Read(ctx, pb, cb, pcbRead, cbOffset, M_FILEHANDLESVADS_SOURCE_HANDLES);
 }
 
 _Success_(return == 0)
 NTSTATUS M_FileVads_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
 {
-    return M_FileHandlesVads_Read(ctx, pb, cb, pcbRead, cbOffset, FALSE);
+    return M_FileHandlesVads_Read(ctx, pb, cb, pcbRead, cbOffset, M_FILEHANDLESVADS_SOURCE_VADS);
 }
 
-BOOL M_FileHandlesVads_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileList, _In_ BOOL fHandles)
+_Success_(return == 0)
+NTSTATUS M_FileAll_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
+{
+    return M_FileHandlesVads_Read(ctx, pb, cb, pcbRead, cbOffset, M_FILEHANDLESVADS_SOURCE_ALL);
+}
+
+BOOL M_FileHandlesVads_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileList, _In_ DWORD tpSource)
 {
     POB_MAP pmObFiles;
     POB_VMMWINOBJ_FILE pObFile;
     WCHAR wszAddressPath[MAX_PATH];
     if(ctx->wszPath[0]) { return FALSE; }
-    if(VmmWinObjFile_GetByProcess(ctx->pProcess, &pmObFiles, fHandles)) {
+    if(M_FileHandlesVads_GetFiles(ctx, tpSource, &pmObFiles)) {
         while((pObFile = ObMap_Pop(pmObFiles))) {
             Util_PathPrependVA(wszAddressPath, pObFile->va, ctxVmm->f32, pObFile->wszName);
             VMMDLL_VfsList_AddFile(pFileList, wszAddressPath, pObFile->cb, NULL);
+            Ob_DECREF(pObFile);
         }
         Ob_DECREF_NULL(&pmObFiles);
     }
@@ -63,12 +92,17 @@ BOOL M_FileHandlesVads_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFi
 
 BOOL M_FileHandles_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileList)
 {
-    return M_FileHandlesVads_List(ctx, pFileList, TRUE);
+    return M_FileHandlesVads_List(ctx, pFileList, M_FILEHANDLESVADS_SOURCE_HANDLES);
 }
 
 BOOL M_FileVads_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileList)
 {
-    return M_FileHandlesVads_List(ctx, pFileList, FALSE);
+    return M_FileHandlesVads_List(ctx, pFileList, M_FILEHANDLESVADS_SOURCE_VADS);
+}
+
+BOOL M_FileAll_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileList)
+{
+    return M_FileHandlesVads_List(ctx, pFileList, M_FILEHANDLESVADS_SOURCE_ALL);
 }
 
 VOID M_FileHandlesVads_Initialize(_Inout_ PVMMDLL_PLUGIN_REGINFO pRI)
@@ -89,4 +123,11 @@ VOID M_FileHandlesVads_Initialize(_Inout_ PVMMDLL_PLUGIN_REGINFO pRI)
     pRI->reg_fn.pfnList = M_FileVads_List;                              // List function supported
     pRI->reg_fn.pfnRead = M_FileVads_Read;                              // Read function supported
     pRI->pfnPluginManager_Register(pRI);
+    // files system-wide (handles and vads of all processes)
+    wcscpy_s(pRI->reg_info.wszPathName, 128, L"\\files");               // module name
+    pRI->reg_info.fRootModule = TRUE;                                   // module shows in root directory
+    pRI->reg_info.fProcessModule = FALSE;                               // module shows in process directory
+    pRI->reg_fn.pfnList = M_FileAll_List;                               // List function supported
+    pRI->reg_fn.pfnRead = M_FileAll_Read;                               // Read function supported
+    pRI->pfnPluginManager_Register(pRI);
 }
@@ -11,46 +11,47 @@
 
 #define HANDLEINFO_LINELENGTH       222ULL
 
-_Success_(return == 0)
-NTSTATUS HandleInfo_Read_HandleMap(_In_ PVMMOB_MAP_HANDLE pHandleMap, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
+VOID HandleInfo_Read_HandleMap_RenderLine(_In_ PVMMOB_MAP_HANDLE pHandleMap, _In_ DWORD iLine, _Out_writes_(cszLineLength + 1) LPSTR szLine, _In_ DWORD cszLineLength)
 {
-    NTSTATUS nt;
-    LPSTR sz;
-    QWORD i, o = 0, cbMax, cStart, cEnd, cbLINELENGTH;
-    PVMM_MAP_HANDLEENTRY pH;
+    DWORD i;
+    UTIL_LN ln;
+    PVMM_MAP_HANDLEENTRY pH = pHandleMap->pMap + iLine;
     PVMMWIN_OBJECT_TYPE pOT;
-    CHAR szType[MAX_PATH] = { 0 };
-    cbLINELENGTH = HANDLEINFO_LINELENGTH;
-    cStart = (DWORD)(cbOffset / cbLINELENGTH);
-    cEnd = (DWORD)min(pHandleMap->cMap - 1, (cb + cbOffset + cbLINELENGTH - 1) / cbLINELENGTH);
-    cbMax = 1 + (1 + cEnd - cStart) * cbLINELENGTH;
-    if(!pHandleMap->cMap || (cStart > pHandleMap->cMap)) { return VMMDLL_STATUS_END_OF_FILE; }
-    if(!(sz = LocalAlloc(LMEM_ZEROINIT, cbMax))) { return VMMDLL_STATUS_FILE_INVALID; }
-    for(i = cStart; i <= cEnd; i++) {
-        pH = pHandleMap->pMap + i;
-        if((pOT = VmmWin_ObjectTypeGet((BYTE)pH->iType))) {
-            snprintf(szType, _MAX_PATH, "%S", pOT->wsz);
-            szType[16] = 0;
-        } else {
-            *(PDWORD)szType = pH->dwPoolTag;
-            szType[4] = 0;
+    CHAR szType[17] = { 0 };
+    if((pOT = VmmWin_ObjectTypeGet((BYTE)pH->iType))) {
+        for(i = 0; (i < 16) && pOT->wsz[i]; i++) {
+            szType[i] = (CHAR)pOT->wsz[i];
         }
-        o += Util_snwprintf_u8ln(
-            sz + o,
-            cbLINELENGTH,
-            L"%04x%7i%8x %16llx %6x %-16S %s",
-            (DWORD)i,
-            pH->dwPID,
-            pH->dwHandle,
-            pH->vaObject,
-            pH->dwGrantedAccess,
-            szType,
-            pH->wszText + pH->cwszText - min(128, pH->cwszText)
-        );
+    } else {
+        *(PDWORD)szType = pH->dwPoolTag;
     }
-    nt = Util_VfsReadFile_FromPBYTE(sz, cbMax - 1, pb, cb, pcbRead, cbOffset - cStart * cbLINELENGTH);
-    LocalFree(sz);
-    return nt;
+    Util_LnInit(&ln, szLine, cszLineLength);
+    Util_LnHex(&ln, iLine, 4, TRUE);
+    Util_LnDec(&ln, pH->dwPID, 7);
+    Util_LnHex(&ln, pH->dwHandle, 8, FALSE);
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, pH->vaObject, 16, FALSE);
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, pH->dwGrantedAccess, 6, FALSE);
+    Util_LnChar(&ln, ' ');
+    Util_LnStr(&ln, szType, 16);
+    Util_LnChar(&ln, ' ');
+    Util_LnWstr(&ln, pH->wszText + pH->cwszText - min(128, pH->cwszText));
+    Util_LnEnd(&ln);
+}
+
+_Success_(return == 0)
+NTSTATUS HandleInfo_Read_HandleMap(_In_ PVMMOB_MAP_HANDLE pHandleMap, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
+{
+    return VmmMapText_Read(
+        (POB)pHandleMap,
+        0,
+        pHandleMap->cMap,
+        (DWORD)HANDLEINFO_LINELENGTH,
+        pHandleMap,
+        (VMM_MAPTEXT_PFN_RENDERLINE)HandleInfo_Read_HandleMap_RenderLine,
+        pb, cb, pcbRead, cbOffset
+    );
 }
 
 /*
@@ -15,6 +15,11 @@
 
 #define MEMMAP_VADEX_LINELENGTH         162ULL
 
+typedef struct tdMEMMAP_RENDER_CONTEXT {
+    DWORD dwPID;
+    PVOID pObMap;
+} MEMMAP_RENDER_CONTEXT, *PMEMMAP_RENDER_CONTEXT;
+
 VOID MemMap_Read_VadMap_Protection(_In_ PVMM_MAP_VADENTRY pVad, _Out_writes_(6) LPSTR sz)
 {
     BYTE vh = (BYTE)pVad->Protection >> 3;
@@ -60,62 +65,53 @@ CHAR MemMap_Read_VadExMap_Type(_In_ VMM_PTE_TP tp)
     }
 }
 
+VOID MemMap_Read_VadMap_RenderLine(_In_ PMEMMAP_RENDER_CONTEXT ctx, _In_ DWORD iLine, _Out_writes_(cszLineLength + 1) LPSTR szLine, _In_ DWORD cszLineLength)
+{
+    UTIL_LN ln;
+    PVMM_MAP_VADENTRY pVad = ((PVMMOB_MAP_VAD)ctx->pObMap)->pMap + iLine;
+    DWORD cchVa = ctxVmm->f32 ? 8 : 16;
+    QWORD vaMask = ctxVmm->f32 ? 0xffffffff : (QWORD)-1;
+    CHAR szProtection[7] = { 0 };
+    MemMap_Read_VadMap_Protection(pVad, szProtection);
+    Util_LnInit(&ln, szLine, cszLineLength);
+    Util_LnHex(&ln, iLine, 4, TRUE);
+    Util_LnDec(&ln, ctx->dwPID, 7);
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, pVad->vaVad & vaMask, cchVa, TRUE);
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, (DWORD)((pVad->vaEnd - pVad->vaStart + 1) >> 12), 8, FALSE);
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, pVad->CommitCharge, 8, FALSE);
+    Util_LnChar(&ln, ' ');
+    Util_LnChar(&ln, pVad->MemCommit ? '1' : '0');
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, pVad->vaStart & vaMask, cchVa, TRUE);
+    Util_LnChar(&ln, '-');
+    Util_LnHex(&ln, pVad->vaEnd & vaMask, cchVa, TRUE);
+    Util_LnChar(&ln, ' ');
+    Util_LnStr(&ln, MemMap_Read_VadMap_Type(pVad), 0);
+    Util_LnChar(&ln, ' ');
+    Util_LnStr(&ln, szProtection, 0);
+    Util_LnChar(&ln, ' ');
+    Util_LnWstr(&ln, pVad->wszText + pVad->cwszText - min(64, pVad->cwszText));
+    Util_LnEnd(&ln);
+}
+
 _Success_(return == 0)
 NTSTATUS MemMap_Read_VadMap(_In_ PVMM_PROCESS pProcess, _In_ PVMMOB_MAP_VAD pVadMap, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
 {
-    NTSTATUS nt;
-    LPSTR sz;
-    QWORD i, o = 0, cbMax, cStart, cVad, cbLINELENGTH;
-    PVMM_MAP_VADENTRY pVad;
-    CHAR szProtection[7] = { 0 };
-    cbLINELENGTH = ctxVmm->f32 ? MEMMAP_VAD_LINELENGTH_X86 : MEMMAP_VAD_LINELENGTH_X64;
-    cStart = (DWORD)(cbOffset / cbLINELENGTH);
-    cVad = (DWORD)min(pVadMap->cMap - 1, (cb + cbOffset + cbLINELENGTH - 1) / cbLINELENGTH);
-    cbMax = 1 + (1 + cVad - cStart) * cbLINELENGTH;
-    if(!pVadMap->cMap || (cStart > pVadMap->cMap)) { return VMMDLL_STATUS_END_OF_FILE; }
-    if(!(sz = LocalAlloc(LMEM_ZEROINIT, cbMax))) { return VMMDLL_STATUS_FILE_INVALID; }
-    for(i = cStart; i <= cVad; i++) {
-        pVad = pVadMap->pMap + i;
-        MemMap_Read_VadMap_Protection(pVad, szProtection);
-        if(ctxVmm->f32) {
-            o += Util_snwprintf_u8ln(
-                sz + o,
-                cbLINELENGTH,
-                L"%04x%7i %08x %8x %8x %i %08x-%08x %S %S %s",
-                (DWORD)i,
-                pProcess->dwPID,
-                (DWORD)pVad->vaVad,
-                (DWORD)((pVad->vaEnd - pVad->vaStart + 1) >> 12),
-                pVad->CommitCharge,
-                pVad->MemCommit ? 1 : 0,
-                (DWORD)pVad->vaStart,
-                (DWORD)pVad->vaEnd,
-                MemMap_Read_VadMap_Type(pVad),
-                szProtection,
-                pVad->wszText + pVad->cwszText - min(64, pVad->cwszText)
-            );
-        } else {
-            o += Util_snwprintf_u8ln(
-                sz + o,
-                cbLINELENGTH,
-                L"%04x%7i %016llx %8x %8x %i %016llx-%016llx %S %S %s",
-                (DWORD)i,
-                pProcess->dwPID,
-                pVad->vaVad,
-                (DWORD)((pVad->vaEnd - pVad->vaStart + 1) >> 12),
-                pVad->CommitCharge,
-                pVad->MemCommit ? 1 : 0,
-                pVad->vaStart,
-                pVad->vaEnd,
-                MemMap_Read_VadMap_Type(pVad),
-                szProtection,
-                pVad->wszText + pVad->cwszText - min(64, pVad->cwszText)
-            );
-        }
-    }
-    nt = Util_VfsReadFile_FromPBYTE(sz, cbMax - 1, pb, cb, pcbRead, cbOffset - cStart * cbLINELENGTH);
-    LocalFree(sz);
-    return nt;
+    MEMMAP_RENDER_CONTEXT ctx;
+    ctx.dwPID = pProcess->dwPID;
+    ctx.pObMap = pVadMap;
+    return VmmMapText_Read(
+        (POB)pVadMap,
+        0,
+        pVadMap->cMap,
+        (DWORD)(ctxVmm->f32 ? MEMMAP_VAD_LINELENGTH_X86 : MEMMAP_VAD_LINELENGTH_X64),
+        &ctx,
+        (VMM_MAPTEXT_PFN_RENDERLINE)MemMap_Read_VadMap_RenderLine,
+        pb, cb, pcbRead, cbOffset
+    );
 }
 
 _Success_(return == 0)
@@ -199,57 +195,50 @@ NTSTATUS MemMap_Read_VadExMap(_In_ PVMM_PROCESS pProcess, _In_ LPWSTR wszFile, _
     return nt;
 }
 
+VOID MemMap_Read_PteMap_RenderLine(_In_ PMEMMAP_RENDER_CONTEXT ctx, _In_ DWORD iLine, _Out_writes_(cszLineLength + 1) LPSTR szLine, _In_ DWORD cszLineLength)
+{
+    UTIL_LN ln;
+    PVMM_MAP_PTEENTRY pPte = ((PVMMOB_MAP_PTE)ctx->pObMap)->pMap + iLine;
+    DWORD cchVa = ctxVmm->f32 ? 8 : 16;
+    QWORD vaMask = ctxVmm->f32 ? 0xffffffff : (QWORD)-1;
+    Util_LnInit(&ln, szLine, cszLineLength);
+    Util_LnHex(&ln, iLine, 4, TRUE);
+    Util_LnDec(&ln, ctx->dwPID, 7);
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, (DWORD)pPte->cPages, 8, FALSE);
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, pPte->vaBase & vaMask, cchVa, TRUE);
+    Util_LnChar(&ln, '-');
+    Util_LnHex(&ln, (pPte->vaBase + (pPte->cPages << 12) - 1) & vaMask, cchVa, TRUE);
+    Util_LnChar(&ln, ' ');
+    Util_LnChar(&ln, pPte->fPage & VMM_MEMMAP_PAGE_NS ? '-' : 's');
+    Util_LnChar(&ln, 'r');
+    Util_LnChar(&ln, pPte->fPage & VMM_MEMMAP_PAGE_W ? 'w' : '-');
+    Util_LnChar(&ln, pPte->fPage & VMM_MEMMAP_PAGE_NX ? '-' : 'x');
+    if(ctxVmm->f32) {
+        Util_LnChar(&ln, ' ');
+    } else {
+        Util_LnStr(&ln, (pPte->cwszText && pPte->fWoW64) ? " 32 " : "    ", 0);
+    }
+    Util_LnWstr(&ln, pPte->wszText + pPte->cwszText - min(64, pPte->cwszText));
+    Util_LnEnd(&ln);
+}
+
 _Success_(return == 0)
 NTSTATUS MemMap_Read_PteMap(_In_ PVMM_PROCESS pProcess, _In_ PVMMOB_MAP_PTE pPteMap, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
 {
-    NTSTATUS nt;
-    LPSTR sz;
-    QWORD i, o = 0, cbMax, cStart, cEnd, cbLINELENGTH;
-    PVMM_MAP_PTEENTRY pPte;
-    cbLINELENGTH = ctxVmm->f32 ? MEMMAP_PTE_LINELENGTH_X86 : MEMMAP_PTE_LINELENGTH_X64;
-    cStart = (DWORD)(cbOffset / cbLINELENGTH);
-    cEnd = (DWORD)min(pPteMap->cMap - 1, (cb + cbOffset + cbLINELENGTH - 1) / cbLINELENGTH);
-    cbMax = 1 + (1 + cEnd - cStart) * cbLINELENGTH;
-    if(!pPteMap->cMap || (cStart > pPteMap->cMap)) { return VMMDLL_STATUS_END_OF_FILE; }
-    if(!(sz = LocalAlloc(LMEM_ZEROINIT, cbMax))) { return VMMDLL_STATUS_FILE_INVALID; }
-    for(i = cStart; i <= cEnd; i++) {
-        pPte = pPteMap->pMap + i;
-        if(ctxVmm->f32) {
-            o += Util_snwprintf_u8ln(
-                sz + o,
-                cbLINELENGTH,
-                L"%04x%7i %8x %08x-%08x %cr%c%c %s",
-                (DWORD)i,
-                pProcess->dwPID,
-                (DWORD)pPte->cPages,
-                (DWORD)pPte->vaBase,
-                (DWORD)(pPte->vaBase + (pPte->cPages << 12) - 1),
-                pPte->fPage & VMM_MEMMAP_PAGE_NS ? '-' : 's',
-                pPte->fPage & VMM_MEMMAP_PAGE_W ? 'w' : '-',
-                pPte->fPage & VMM_MEMMAP_PAGE_NX ? '-' : 'x',
-                pPte->wszText + pPte->cwszText - min(64, pPte->cwszText)
-            );
-        } else {
-            o += Util_snwprintf_u8ln(
-                sz + o,
-                cbLINELENGTH,
-                L"%04x%7i %8x %016llx-%016llx %cr%c%c%s%s",
-                (DWORD)i,
-                pProcess->dwPID,
-                (DWORD)pPte->cPages,
-                pPte->vaBase,
-                pPte->vaBase + (pPte->cPages << 12) - 1,
-                pPte->fPage & VMM_MEMMAP_PAGE_NS ? '-' : 's',
-                pPte->fPage & VMM_MEMMAP_PAGE_W ? 'w' : '-',
-                pPte->fPage & VMM_MEMMAP_PAGE_NX ? '-' : 'x',
-                pPte->cwszText ? (pPte->fWoW64 ? L" 32 " : L"    ") : L"    ",
-                pPte->wszText + pPte->cwszText - min(64, pPte->cwszText)
-            );
-        }
-    }
-    nt = Util_VfsReadFile_FromPBYTE(sz, cbMax - 1, pb, cb, pcbRead, cbOffset - cStart * cbLINELENGTH);
-    LocalFree(sz);
-    return nt;
+    MEMMAP_RENDER_CONTEXT ctx;
+    ctx.dwPID = pProcess->dwPID;
+    ctx.pObMap = pPteMap;
+    return VmmMapText_Read(
+        (POB)pPteMap,
+        0,
+        pPteMap->cMap,
+        (DWORD)(ctxVmm->f32 ? MEMMAP_PTE_LINELENGTH_X86 : MEMMAP_PTE_LINELENGTH_X64),
+        &ctx,
+        (VMM_MAPTEXT_PFN_RENDERLINE)MemMap_Read_PteMap_RenderLine,
+        pb, cb, pcbRead, cbOffset
+    );
 }
 
 /*
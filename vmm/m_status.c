@@ -35,10 +35,11 @@
 NTSTATUS MStatus_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
 {
     DWORD cchBuffer;
-    CHAR szBuffer[0x800];
+    CHAR szBuffer[0x1000];
     DWORD cbCallStatistics = 0;
     PBYTE pbCallStatistics = NULL;
     QWORD cPageReadTotal, cPageFailTotal;
+    QWORD i, cIoLatency = 0, qwIoLatencyP99 = 0;
     NTSTATUS nt;
     if(!_wcsicmp(ctx->wszPath, L"config_process_show_terminated")) {
         return Util_VfsReadFile_FromBOOL(ctxVmm->flags & VMM_FLAG_PROCESS_SHOW_TERMINATED, pb, cb, pcbRead, cbOffset);
@@ -76,7 +77,17 @@ NTSTATUS MStatus_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbR
     if(!_wcsicmp(ctx->wszPath, L"statistics")) {
         cPageReadTotal = ctxVmm->stat.page.cPrototype + ctxVmm->stat.page.cTransition + ctxVmm->stat.page.cDemandZero + ctxVmm->stat.page.cVAD + ctxVmm->stat.page.cCacheHit + ctxVmm->stat.page.cPageFile + ctxVmm->stat.page.cCompressed;
         cPageFailTotal = ctxVmm->stat.page.cFailCacheHit + ctxVmm->stat.page.cFailVAD + ctxVmm->stat.page.cFailPageFile + ctxVmm->stat.page.cFailCompressed + ctxVmm->stat.page.cFail;
-        cchBuffer = snprintf(szBuffer, 0x800,
+        for(i = 0; i < VMM_IOSCHED_LATENCY_BUCKETS; i++) {
+            cIoLatency += ctxVmm->stat.iosched.cLatencyLog2[i];
+        }
+        for(i = 0; cIoLatency && (i < VMM_IOSCHED_LATENCY_BUCKETS); i++) {
+            qwIoLatencyP99 += ctxVmm->stat.iosched.cLatencyLog2[i];
+            if(qwIoLatencyP99 * 100 >= cIoLatency * 99) {
+                qwIoLatencyP99 = 1ULL << i;
+                break;
+            }
+        }
+        cchBuffer = snprintf(szBuffer, sizeof(szBuffer),
             "VMM STATISTICS   (4kB PAGES / COUNTS - HEXADECIMAL)\n" \
             "===================================================\n" \
             "PHYSICAL MEMORY:                      \n" \
@@ -105,12 +116,30 @@ NTSTATUS MStatus_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbR
             "PHYSICAL MEMORY REFRESH:        %16llx\n" \
             "TLB MEMORY REFRESH:             %16llx\n" \
             "PROCESS PARTIAL REFRESH:        %16llx\n" \
-            "PROCESS FULL REFRESH:           %16llx\n",
+            "PROCESS FULL REFRESH:           %16llx\n" \
+            "PROCESS KERNEL CLONE CACHE HIT: %16llx\n" \
+            "PROCESS KERNEL CLONE CREATE:    %16llx\n" \
+            "PROCESS TOKEN RESOLVE:          %16llx\n" \
+            "PROCESS TOKEN ROUND TRIPS:      %16llx\n" \
+            "BIG POOL INDEX REFRESH:         %16llx\n" \
+            "BIG POOL INDEX LOOKUP:          %16llx\n" \
+            "BIG POOL INDEX READ SAVED:      %16llx\n" \
+            "I/O SCHEDULER REQUESTS:         %16llx\n" \
+            "I/O SCHEDULER QUEUED:           %16llx\n" \
+            "I/O SCHEDULER DEVICE CALLS:     %16llx\n" \
+            "I/O SCHEDULER DEVICE MEMS:      %16llx\n" \
+            "I/O SCHEDULER P99 LATENCY (us): %16llx\n",
             ctxVmm->stat.cPhysCacheHit, ctxVmm->stat.cPhysReadSuccess, ctxVmm->stat.cPhysReadFail, ctxVmm->stat.cPhysWrite,
             cPageReadTotal, ctxVmm->stat.page.cPrototype, ctxVmm->stat.page.cTransition, ctxVmm->stat.page.cDemandZero, ctxVmm->stat.page.cVAD, ctxVmm->stat.page.cCacheHit, ctxVmm->stat.page.cPageFile, ctxVmm->stat.page.cCompressed,
             cPageFailTotal, ctxVmm->stat.page.cFailCacheHit, ctxVmm->stat.page.cFailVAD, ctxVmm->stat.page.cFailPageFile, ctxVmm->stat.page.cFailCompressed,
             ctxVmm->stat.cTlbCacheHit, ctxVmm->stat.cTlbReadSuccess, ctxVmm->stat.cTlbReadFail,
-            ctxVmm->stat.cPhysRefreshCache, ctxVmm->stat.cTlbRefreshCache, ctxVmm->stat.cProcessRefreshPartial, ctxVmm->stat.cProcessRefreshFull
+            ctxVmm->stat.cPhysRefreshCache, ctxVmm->stat.cTlbRefreshCache, ctxVmm->stat.cProcessRefreshPartial, ctxVmm->stat.cProcessRefreshFull,
+            ctxVmm->stat.cProcessCloneCacheHit, ctxVmm->stat.cProcessCloneCacheMiss,
+            ctxVmm->stat.cTokenResolve, ctxVmm->stat.cTokenResolveRoundTrip,
+            ctxVmm->stat.cPoolIndexRefresh, ctxVmm->stat.cPoolIndexLookup, ctxVmm->stat.cPoolIndexReadSaved,
+            ctxVmm->stat.iosched.cRequest, ctxVmm->stat.iosched.cRequestQueued,
+            ctxVmm->stat.iosched.cDeviceCall, ctxVmm->stat.iosched.cDeviceCallMEMs,
+            (cIoLatency ? qwIoLatencyP99 : 0)
         );
         return Util_VfsReadFile_FromPBYTE(szBuffer, cchBuffer, pb, cb, pcbRead, cbOffset);
     }
@@ -292,7 +321,7 @@ BOOL MStatus_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileList)
         VMMDLL_VfsList_AddFile(pFileList, L"config_symbolcache", strlen(ctxMain->pdb.szLocal), NULL);
         VMMDLL_VfsList_AddFile(pFileList, L"config_symbolserver", strlen(ctxMain->pdb.szServer), NULL);
         VMMDLL_VfsList_AddFile(pFileList, L"config_symbolserver_enable", 1, NULL);
-        VMMDLL_VfsList_AddFile(pFileList, L"statistics", 1103, NULL);
+        VMMDLL_VfsList_AddFile(pFileList, L"statistics", 1936, NULL);
         VMMDLL_VfsList_AddFile(pFileList, L"config_printf_enable", 1, NULL);
         VMMDLL_VfsList_AddFile(pFileList, L"config_printf_v", 1, NULL);
         VMMDLL_VfsList_AddFile(pFileList, L"config_printf_vv", 1, NULL);
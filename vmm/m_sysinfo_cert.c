@@ -45,12 +45,16 @@ typedef struct tdMSYSINFOCERT_OB_ENTRY {
     OB ObHdr;
     QWORD qwIdMapKey;
     QWORD vaHive;
-    DWORD oRegBlob;
-    DWORD oRegCellValue;
-    DWORD cbCert;
+    DWORD raKeyCell;
     DWORD dwHashUserSID;
     LPWSTR wszStore;
     LPWSTR wszIdHash;
+    // values below are only valid after MSysInfoCert_EntryEnsure()
+    BOOL fDecoded;
+    BOOL fValid;
+    DWORD oRegBlob;
+    DWORD oRegCellValue;
+    DWORD cbCert;
     LPWSTR wszIssuerCN;
     LPWSTR wszSubjectCN;
 } MSYSINFOCERT_OB_ENTRY, *PMSYSINFOCERT_OB_ENTRY;
@@ -63,28 +67,26 @@ VOID MSysInfoCert_CallbackCleanup(PMSYSINFOCERT_OB_ENTRY pOb)
     LocalFree(pOb->wszSubjectCN);
 }
 
-VOID MSysInfoCert_GetContext_UserAddSingleCert(_In_ POB_REGISTRY_HIVE pHive, _In_ POB_REGISTRY_KEY pkStore, _In_ POB_REGISTRY_KEY pkCert, _In_opt_ PVMM_MAP_USERENTRY pUser, _Inout_ POB_MAP pmCtx)
+/*
+* Read the registry blob of a certificate and decode it. Decoding is deferred
+* from enumeration since it's costly on systems with many certificates.
+* NB! must be called with ctxVmm->LockUpdateModule held.
+* -- pe
+*/
+VOID MSysInfoCert_EntryEnsure_DoWork(_In_ PMSYSINFOCERT_OB_ENTRY pe)
 {
     DWORD o, cb, cch;
     BYTE pb[0x1800];
     PCCERT_CONTEXT pCertContext = NULL;
+    POB_REGISTRY_HIVE pObHive = NULL;
+    POB_REGISTRY_KEY pObKey = NULL;
     POB_REGISTRY_VALUE pObValue = NULL;
-    PMSYSINFOCERT_OB_ENTRY pObResult = NULL;
     VMM_REGISTRY_VALUE_INFO ValueInfo = { 0 };
-    VMM_REGISTRY_KEY_INFO KeyCertInfo = { 0 };
-    VMM_REGISTRY_KEY_INFO KeyStoreInfo = { 0 };
-    if(!(pObValue = VmmWinReg_KeyValueGetByName(pHive, pkCert, L"Blob"))) {
-        goto fail;
-    }
-    if(!VmmWinReg_ValueQuery4(pHive, pObValue, NULL, pb, sizeof(pb), &cb) || (cb < 0x20)) {
-        goto fail;
-    }
-    VmmWinReg_KeyInfo(pHive, pkCert, &KeyCertInfo);
-    VmmWinReg_KeyInfo(pHive, pkStore, &KeyStoreInfo);
-    VmmWinReg_ValueInfo(pHive, pObValue, &ValueInfo);
-    if(wcslen(KeyCertInfo.wszName) != 40) {
-        goto fail;
-    }
+    if(!(pObHive = VmmWinReg_HiveGetByAddress(pe->vaHive))) { goto fail; }
+    if(!(pObKey = VmmWinReg_KeyGetByCellOffset(pObHive, pe->raKeyCell))) { goto fail; }
+    if(!(pObValue = VmmWinReg_KeyValueGetByName(pObHive, pObKey, L"Blob"))) { goto fail; }
+    if(!VmmWinReg_ValueQuery4(pObHive, pObValue, NULL, pb, sizeof(pb), &cb) || (cb < 0x20)) { goto fail; }
+    VmmWinReg_ValueInfo(pObHive, pObValue, &ValueInfo);
     // locate certificate part in registry blob
     // https://blog.nviso.eu/2019/08/28/extracting-certificates-from-the-windows-registry/
     for(o = 0; o < cb - 0x20; o++) {
@@ -94,53 +96,85 @@ VOID MSysInfoCert_GetContext_UserAddSingleCert(_In_ POB_REGISTRY_HIVE pHive, _In
             break;
         }
     }
-    if(!(pCertContext = CertCreateCertificateContext(X509_ASN_ENCODING | PKCS_7_ASN_ENCODING, pb + o, cb + 10))) {
-        goto fail;
-    }
-    if(!(pObResult = Ob_Alloc('Pcer', LMEM_ZEROINIT, sizeof(MSYSINFOCERT_OB_ENTRY), MSysInfoCert_CallbackCleanup, NULL))) {
-        goto fail;
-    }
+    if(!(pCertContext = CertCreateCertificateContext(X509_ASN_ENCODING | PKCS_7_ASN_ENCODING, pb + o, cb + 10))) { goto fail; }
     // Subject CN
     cch = CertGetNameStringW(pCertContext, CERT_NAME_SIMPLE_DISPLAY_TYPE, 0, NULL, NULL, 0);
-    if(!(pObResult->wszSubjectCN = LocalAlloc(LMEM_ZEROINIT, max(2, 2 * cch)))) { goto fail; }
-    CertGetNameStringW(pCertContext, CERT_NAME_SIMPLE_DISPLAY_TYPE, 0, NULL, pObResult->wszSubjectCN, cch);
-    if(cch > 64) { pObResult->wszSubjectCN[64] = 0; }   // max 64 characters length
+    if(!(pe->wszSubjectCN = LocalAlloc(LMEM_ZEROINIT, max(2, 2 * cch)))) { goto fail; }
+    CertGetNameStringW(pCertContext, CERT_NAME_SIMPLE_DISPLAY_TYPE, 0, NULL, pe->wszSubjectCN, cch);
+    if(cch > 64) { pe->wszSubjectCN[64] = 0; }   // max 64 characters length
     // Issuer CN
     cch = CertGetNameStringW(pCertContext, CERT_NAME_SIMPLE_DISPLAY_TYPE, CERT_NAME_ISSUER_FLAG, NULL, NULL, 0);
-    if(!(pObResult->wszIssuerCN = LocalAlloc(LMEM_ZEROINIT, max(2, 2 * cch)))) {
+    if(!(pe->wszIssuerCN = LocalAlloc(LMEM_ZEROINIT, max(2, 2 * cch)))) { goto fail; }
+    CertGetNameStringW(pCertContext, CERT_NAME_SIMPLE_DISPLAY_TYPE, CERT_NAME_ISSUER_FLAG, NULL, pe->wszIssuerCN, cch);
+    if(cch > 64) { pe->wszIssuerCN[64] = 0; }    // max 64 characters length
+    // other values and finish
+    pe->oRegBlob = o;
+    pe->oRegCellValue = ValueInfo.raValueCell;
+    pe->cbCert = cb;
+    pe->fValid = TRUE;
+fail:
+    if(pCertContext) { CertFreeCertificateContext(pCertContext); }
+    Ob_DECREF(pObValue);
+    Ob_DECREF(pObKey);
+    Ob_DECREF(pObHive);
+}
+
+/*
+* Ensure the certificate entry is decoded. The result (also if failed) is kept
+* in the entry until the certificate context is refreshed.
+* -- pe
+* -- return = TRUE if the certificate entry is valid.
+*/
+BOOL MSysInfoCert_EntryEnsure(_In_ PMSYSINFOCERT_OB_ENTRY pe)
+{
+    if(pe->fDecoded) { return pe->fValid; }
+    EnterCriticalSection(&ctxVmm->LockUpdateModule);
+    if(!pe->fDecoded) {
+        MSysInfoCert_EntryEnsure_DoWork(pe);
+        pe->fDecoded = TRUE;
+    }
+    LeaveCriticalSection(&ctxVmm->LockUpdateModule);
+    return pe->fValid;
+}
+
+VOID MSysInfoCert_GetContext_UserAddSingleCert(_In_ POB_REGISTRY_HIVE pHive, _In_ LPWSTR wszStore, _In_ POB_REGISTRY_KEY pkCert, _In_opt_ PVMM_MAP_USERENTRY pUser, _Inout_ POB_MAP pmCtx)
+{
+    PMSYSINFOCERT_OB_ENTRY pObResult = NULL;
+    VMM_REGISTRY_KEY_INFO KeyCertInfo = { 0 };
+    VmmWinReg_KeyInfo(pHive, pkCert, &KeyCertInfo);
+    if(wcslen(KeyCertInfo.wszName) != 40) {
+        goto fail;
+    }
+    if(!(pObResult = Ob_Alloc('Pcer', LMEM_ZEROINIT, sizeof(MSYSINFOCERT_OB_ENTRY), MSysInfoCert_CallbackCleanup, NULL))) {
         goto fail;
     }
-    CertGetNameStringW(pCertContext, CERT_NAME_SIMPLE_DISPLAY_TYPE, CERT_NAME_ISSUER_FLAG, NULL, pObResult->wszIssuerCN, cch);
-    if(cch > 64) { pObResult->wszIssuerCN[64] = 0; }    // max 64 characters length
     // hash and store
     if(!(pObResult->wszIdHash = Util_StrDupW(KeyCertInfo.wszName))) { goto fail; }
-    if(!(pObResult->wszStore = Util_StrDupW(KeyStoreInfo.wszName))) { goto fail; }
+    if(!(pObResult->wszStore = Util_StrDupW(wszStore))) { goto fail; }
     if(wcslen(pObResult->wszStore) > 32) { pObResult->wszStore[32] = 0; }
     // other values and finish
     pObResult->qwIdMapKey = wcstoull(pObResult->wszIdHash + 24, NULL, 16);
     pObResult->vaHive = pHive->vaCMHIVE;
-    pObResult->oRegBlob = o;
-    pObResult->oRegCellValue = ValueInfo.raValueCell;
-    pObResult->cbCert = cb;
+    pObResult->raKeyCell = KeyCertInfo.raKeyCell;
     pObResult->dwHashUserSID = pUser ? pUser->dwHashSID : 0;
     ObMap_Push(pmCtx, pObResult->qwIdMapKey, pObResult);
 fail:
-    if(pCertContext) { CertFreeCertificateContext(pCertContext); }
     Ob_DECREF(pObResult);
-    Ob_DECREF(pObValue);
 }
 
 VOID MSysInfoCert_GetContext_UserAddCerts(_In_ POB_REGISTRY_HIVE pHive, _In_ POB_REGISTRY_KEY pKeySystemCertificates, _In_opt_ PVMM_MAP_USERENTRY pUserEntry, _Inout_ POB_MAP pmCtx)
 {
     POB_REGISTRY_KEY pkObCertStore = NULL, pkObCertStoreCerts = NULL, pkObCert = NULL;
     POB_MAP pmkObCertStores = NULL, pmObCerts = NULL;
+    VMM_REGISTRY_KEY_INFO KeyStoreInfo;
     if(!(pmkObCertStores = VmmWinReg_KeyList(pHive, pKeySystemCertificates))) { return; }
     while((pkObCertStore = ObMap_GetNext(pmkObCertStores, pkObCertStore))) {
         pkObCertStoreCerts = VmmWinReg_KeyGetByChildName(pHive, pkObCertStore, L"Certificates");
         if(!pkObCertStoreCerts) { continue; }
         if((pmObCerts = VmmWinReg_KeyList(pHive, pkObCertStoreCerts))) {
+            VmmWinReg_KeyInfo(pHive, pkObCertStore, &KeyStoreInfo);
             while((pkObCert = ObMap_GetNext(pmObCerts, pkObCert))) {
-                MSysInfoCert_GetContext_UserAddSingleCert(pHive, pkObCertStore, pkObCert, pUserEntry, pmCtx);
+                MSysInfoCert_GetContext_UserAddSingleCert(pHive, KeyStoreInfo.wszName, pkObCert, pUserEntry, pmCtx);
             }
             Ob_DECREF_NULL(&pmObCerts);
         }
@@ -151,6 +185,8 @@ VOID MSysInfoCert_GetContext_UserAddCerts(_In_ POB_REGISTRY_HIVE pHive, _In_ POB
 
 /*
 * Retrieve the context map containing information about the certificates.
+* Certificates are enumerated by registry key only - the certificate blobs are
+* read and decoded on first use by MSysInfoCert_EntryEnsure().
 * CALLER DECREF: return
 * -- return
 */
@@ -158,7 +194,8 @@ POB_MAP MSysInfoCert_GetContext()
 {
     LPWSTR wszCertStoresUSER[] = { L"ROOT\\Software\\Microsoft\\SystemCertificates", L"ROOT\\Software\\Policies\\Microsoft\\SystemCertificates" };
     LPWSTR wszCertStoresSYSTEM[] = { L"HKLM\\SOFTWARE\\Microsoft\\SystemCertificates", L"HKLM\\SOFTWARE\\Policies\\Microsoft\\SystemCertificates" };
-    DWORD i;
+    DWORD i, j;
+    QWORD tcStart;
     POB_MAP pObCtx = NULL;
     PVMMOB_MAP_USER pObUserMap = NULL;
     POB_REGISTRY_KEY pObKey = NULL;
@@ -167,6 +204,7 @@ POB_MAP MSysInfoCert_GetContext()
     EnterCriticalSection(&ctxVmm->LockUpdateModule);
     if((pObCtx = ObContainer_GetOb(gp_MSYSINFO_OB_CERTCONTEXT))) { goto finish; }
     if(!(pObCtx = ObMap_New(OB_MAP_FLAGS_OBJECT_OB))) { goto finish; }
+    tcStart = GetTickCount64();
     // Retrieve system (local machine) certificates:
     for(i = 0; i < sizeof(wszCertStoresSYSTEM) / sizeof(LPWSTR); i++) {
         if(VmmWinReg_KeyHiveGetByFullPath(wszCertStoresSYSTEM[i], &pObHive, &pObKey)) {
@@ -179,8 +217,8 @@ POB_MAP MSysInfoCert_GetContext()
     if(VmmMap_GetUser(&pObUserMap)) {
         for(i = 0; i < pObUserMap->cMap; i++) {
             if((pObHive = VmmWinReg_HiveGetByAddress(pObUserMap->pMap[i].vaRegHive))) {
-                for(i = 0; i < sizeof(wszCertStoresUSER) / sizeof(LPWSTR); i++) {
-                    if((pObKey = VmmWinReg_KeyGetByPath(pObHive, wszCertStoresUSER[i]))) {
+                for(j = 0; j < sizeof(wszCertStoresUSER) / sizeof(LPWSTR); j++) {
+                    if((pObKey = VmmWinReg_KeyGetByPath(pObHive, wszCertStoresUSER[j]))) {
                         MSysInfoCert_GetContext_UserAddCerts(pObHive, pObKey, pObUserMap->pMap + i, pObCtx);
                         Ob_DECREF_NULL(&pObKey);
                     }
@@ -190,6 +228,7 @@ POB_MAP MSysInfoCert_GetContext()
         }
         Ob_DECREF_NULL(&pObUserMap);
     }
+    vmmprintfvv_fn("%i certificates enumerated in %llims\n", ObMap_Size(pObCtx), GetTickCount64() - tcStart);
     ObContainer_SetOb(gp_MSYSINFO_OB_CERTCONTEXT, pObCtx);
 finish:
     LeaveCriticalSection(&ctxVmm->LockUpdateModule);
@@ -212,10 +251,11 @@ NTSTATUS MSysInfoCert_Read_Cert(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_
     if(!(qwIdMapKey = wcstoull(ctx->wszPath + cch - 20, NULL, 16))) { goto fail; }
     if(!(pmOb = MSysInfoCert_GetContext())) { goto fail; }
     if(!(pObEntry = ObMap_GetByKey(pmOb, qwIdMapKey))) { goto fail; }
+    if(!MSysInfoCert_EntryEnsure(pObEntry)) { goto fail; }
     if(!(pObHive = VmmWinReg_HiveGetByAddress(pObEntry->vaHive))) { goto fail; }
     if(!(pObValue = VmmWinReg_KeyValueGetByOffset(pObHive, pObEntry->oRegCellValue))) { goto fail; }
     if(!VmmWinReg_ValueQuery4(pObHive, pObValue, NULL, pbCertBuffer, sizeof(pbCertBuffer), &cbCertBuffer)) { goto fail; }
-    if(cb < pObEntry->oRegBlob) { goto fail; }
+    if(cbCertBuffer < pObEntry->oRegBlob) { goto fail; }
     cbCertBuffer = min(pObEntry->cbCert, cbCertBuffer - pObEntry->oRegBlob);
     nt = Util_VfsReadFile_FromPBYTE(pbCertBuffer + pObEntry->oRegBlob, cbCertBuffer, pb, cb, pcbRead, cbOffset);
 fail:
@@ -247,7 +287,7 @@ NTSTATUS MSysInfoCert_Read_InfoFile2(_In_ POB_MAP pmCertificates, _In_ PVMMOB_MA
 {
     NTSTATUS nt = VMMDLL_STATUS_FILE_INVALID;
     LPSTR sz;
-    BOOL fWellKnown;
+    BOOL fWellKnown, fValid;
     CHAR szUserName[17];
     QWORD i, o = 0, cCertificates, cbMax, cStart, cEnd, cbLINELENGTH;
     PMSYSINFOCERT_OB_ENTRY peOb = NULL;
@@ -260,6 +300,7 @@ NTSTATUS MSysInfoCert_Read_InfoFile2(_In_ POB_MAP pmCertificates, _In_ PVMMOB_MA
     if(!(sz = LocalAlloc(LMEM_ZEROINIT, cbMax))) { return VMMDLL_STATUS_FILE_INVALID; }
     for(i = cStart; i <= cEnd; i++) {
         peOb = ObMap_GetByIndex(pmCertificates, (DWORD)i);
+        fValid = MSysInfoCert_EntryEnsure(peOb);
         fWellKnown = 0 != Util_qfind((PVOID)peOb->qwIdMapKey, sizeof(gqw_MSYSINFO_CERTWELLKNOWN) / sizeof(QWORD), gqw_MSYSINFO_CERTWELLKNOWN, sizeof(QWORD), Util_qfind_CmpFindTableQWORD);
         MSysInfoCert_Read_InfoFile_GetUserName(pUserMap, peOb->dwHashUserSID, szUserName);
         o += Util_snwprintf_u8ln(
@@ -269,8 +310,8 @@ NTSTATUS MSysInfoCert_Read_InfoFile2(_In_ POB_MAP pmCertificates, _In_ PVMMOB_MA
             (DWORD)i,
             szUserName,
             peOb->wszStore,
-            peOb->wszSubjectCN,
-            peOb->wszIssuerCN,
+            (fValid ? peOb->wszSubjectCN : L"***"),
+            (fValid ? peOb->wszIssuerCN : L"***"),
             (fWellKnown ? ' ' : '*'),
             peOb->wszIdHash
         );
@@ -320,7 +361,7 @@ BOOL MSysInfoCert_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileLis
         // USER DIR
         if(_wcsicmp(ctx->wszPath, L"LocalMachine")) {
             for(i = 0; i < pObUserMap->cMap; i++) {
-                if(_wcsicmp(ctx->wszPath, pObUserMap->pMap[i].wszText)) {
+                if(!_wcsicmp(ctx->wszPath, pObUserMap->pMap[i].wszText)) {
                     dwHashUserSID = pObUserMap->pMap[i].dwHashSID;
                     break;
                 }
@@ -329,6 +370,7 @@ BOOL MSysInfoCert_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileLis
         }
         while((pObEntry = ObMap_GetNext(pmObCtx, pObEntry))) {
             if(pObEntry->dwHashUserSID != dwHashUserSID) { continue; }
+            if(!MSysInfoCert_EntryEnsure(pObEntry)) { continue; }
             _snwprintf_s(wsz, MAX_PATH, MAX_PATH, L"%s-%s-%s.cer", pObEntry->wszStore, pObEntry->wszSubjectCN, pObEntry->wszIdHash);
             wsz[MAX_PATH - 1] = 0;
             VMMDLL_VfsList_AddFile(pFileList, wsz, pObEntry->cbCert, NULL);
@@ -61,33 +61,47 @@ PVMM_PROCESS MSyscall_GetProcessCsrssFake()
     return NULL;
 }
 
+/*
+* Build the text file for a syscall table. The table is read in one read and
+* all its entries are resolved to symbols in a single PDB batch lookup.
+*/
 VOID MSyscall_Initialize_BuildText(PMSYSCALL_CONTEXT ctx, PVMM_PROCESS pProcess, DWORD iTable, PDB_HANDLE hPDB, QWORD vaBase)
 {
-    BOOL f, f32 = ctxVmm->f32;
-    DWORD i, c, dwSymbolDisplacement, oBuffer = 0, cbBuffer;
+    BOOL f32 = ctxVmm->f32;
+    DWORD i, c, oBuffer = 0, cbBuffer;
     PBYTE pbBuffer;
     QWORD va, vaServiceTableBase;
-    PDWORD pdwTable = NULL;
-    CHAR szSymbolName[MAX_PATH];
+    PDWORD pdwTable = NULL, pdwOffset = NULL;
+    LPSTR *pszSymbolName = NULL, szSymbolMultiText = NULL;
     c = f32 ? ctx->ServiceDescriptorTable32[iTable].NumberOfServices : (DWORD)ctx->ServiceDescriptorTable64[iTable].NumberOfServices;
     vaServiceTableBase = f32 ? ctx->ServiceDescriptorTable32[iTable].ServiceTableBase : ctx->ServiceDescriptorTable64[iTable].ServiceTableBase;
     if(!(pdwTable = LocalAlloc(0, c * sizeof(DWORD)))) { goto fail; }
+    if(!(pdwOffset = LocalAlloc(LMEM_ZEROINIT, c * sizeof(DWORD)))) { goto fail; }
+    if(!(pszSymbolName = LocalAlloc(LMEM_ZEROINIT, c * sizeof(LPSTR)))) { goto fail; }
     if(!VmmRead(pProcess, vaServiceTableBase, (PBYTE)pdwTable, c * sizeof(DWORD))) { goto fail; }
+    // resolve all entries in one batch
+    for(i = 0; i < c; i++) {
+        va = f32 ? pdwTable[i] : vaServiceTableBase + (((LONG)pdwTable[i]) >> 4);
+        if(pdwTable[i] && (va > vaBase) && (va - vaBase < 0x10000000)) {
+            pdwOffset[i] = (DWORD)(va - vaBase);
+        }
+    }
+    PDB_GetSymbolFromOffsetBatch(hPDB, c, pdwOffset, pszSymbolName, &szSymbolMultiText);
+    // build text
     cbBuffer = c * (64 + MAX_PATH);
     if(!(pbBuffer = LocalAlloc(0, cbBuffer))) { goto fail; }
     for(i = 0; i < c; i++) {
-        va = 0;
-        f = pdwTable[i] &&
-            (va = f32 ? pdwTable[i] : vaServiceTableBase + (((LONG)pdwTable[i]) >> 4)) &&
-            PDB_GetSymbolFromOffset(hPDB, (DWORD)(va - vaBase), szSymbolName, &dwSymbolDisplacement) &&
-            (dwSymbolDisplacement == 0);
-        oBuffer += f ?
-            snprintf(pbBuffer + oBuffer, cbBuffer - oBuffer, "%04x %08x +%06x %llx %s %s\n", (i + 0x1000 * iTable), pdwTable[i], (DWORD)(va - vaBase), va, (iTable ? "win32k" : "nt    "), szSymbolName) :
+        va = pdwTable[i] ? (f32 ? pdwTable[i] : vaServiceTableBase + (((LONG)pdwTable[i]) >> 4)) : 0;
+        oBuffer += pszSymbolName[i] ?
+            snprintf(pbBuffer + oBuffer, cbBuffer - oBuffer, "%04x %08x +%06x %llx %s %s\n", (i + 0x1000 * iTable), pdwTable[i], pdwOffset[i], va, (iTable ? "win32k" : "nt    "), pszSymbolName[i]) :
             snprintf(pbBuffer + oBuffer, cbBuffer - oBuffer, "%04x %08x +%06x %*llx %s %s\n", (i + 0x1000 * iTable), pdwTable[i], 0, (f32 ? 8 : 16), va, (iTable ? "win32k" : "nt    "), "---");
     }
     ctx->pb[iTable] = LocalReAlloc(pbBuffer, oBuffer, 0);
     ctx->cb[iTable] = oBuffer;
 fail:
+    LocalFree(szSymbolMultiText);
+    LocalFree(pszSymbolName);
+    LocalFree(pdwOffset);
     LocalFree(pdwTable);
 }
 
@@ -114,14 +128,14 @@ VOID MSyscall_Initialize(PMSYSCALL_CONTEXT ctx)
                 (ctx->ServiceDescriptorTable32[i].NumberOfServices < 0x800) &&
                 VMM_KADDR32(ctx->ServiceDescriptorTable32[i].ParamTableBase) &&
                 (ctx->ServiceDescriptorTable32[i].ServiceTableBase < ctx->ServiceDescriptorTable32[i].ParamTableBase);
-            if(!f) { return; }
+            if(!f) { goto fail; }
         } else {
             f = VMM_KADDR64_8(ctx->ServiceDescriptorTable64[i].ServiceTableBase) &&
                 (ctx->ServiceDescriptorTable64[i].ServiceCounterTableBase == 0) &&
                 (ctx->ServiceDescriptorTable64[i].NumberOfServices < 0x800) &&
                 VMM_KADDR64(ctx->ServiceDescriptorTable64[i].ParamTableBase) &&
                 (ctx->ServiceDescriptorTable64[i].ServiceTableBase < ctx->ServiceDescriptorTable64[i].ParamTableBase);
-            if(!f) { return; }
+            if(!f) { goto fail; }
         }
     }
     // fetch win32k infos
@@ -146,15 +160,18 @@ fail:
 
 PMSYSCALL_CONTEXT MSyscall_GetContext()
 {
-    PMSYSCALL_CONTEXT ctx;;
+    QWORD tcStart;
+    PMSYSCALL_CONTEXT ctx;
     if((ctx = (PMSYSCALL_CONTEXT)g_MSYSCALL_CONTEXT)) {
         return ctx->fInit ? ctx : NULL;
     }
     EnterCriticalSection(&ctxVmm->LockPlugin);
     if((ctx = (PMSYSCALL_CONTEXT)g_MSYSCALL_CONTEXT)) { goto finish; }
     if(!(ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(MSYSCALL_CONTEXT)))) { goto finish; }
+    tcStart = GetTickCount64();
     PDB_Initialize_WaitComplete();
     MSyscall_Initialize(ctx);
+    vmmprintfvv_fn("syscall tables initialized in %llims\n", GetTickCount64() - tcStart);
 finish:
     LeaveCriticalSection(&ctxVmm->LockPlugin);
     return (ctx && ctx->fInit) ? ctx : NULL;
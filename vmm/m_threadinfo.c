@@ -66,48 +66,57 @@ NTSTATUS ThreadInfo_Read_ThreadInfo(_In_ PVMM_MAP_THREADENTRY pThreadEntry, _Out
     return Util_VfsReadFile_FromPBYTE(sz, THREADINFO_INFOFILE_LENGTH, pb, cb, pcbRead, cbOffset);
 }
 
+VOID ThreadInfo_Read_ThreadMap_RenderLine(_In_ PVMMOB_MAP_THREAD pThreadMap, _In_ DWORD iLine, _Out_writes_(cszLineLength + 1) LPSTR szLine, _In_ DWORD cszLineLength)
+{
+    UTIL_LN ln;
+    PVMM_MAP_THREADENTRY pT = pThreadMap->pMap + iLine;
+    CHAR szTimeCreate[MAX_PATH] = { 0 }, szTimeExit[MAX_PATH] = { 0 };
+    Util_FileTime2String((PFILETIME)&pT->ftCreateTime, szTimeCreate);
+    Util_FileTime2String((PFILETIME)&pT->ftExitTime, szTimeExit);
+    Util_LnInit(&ln, szLine, cszLineLength);
+    Util_LnHex(&ln, iLine, 4, TRUE);
+    Util_LnDec(&ln, pT->dwPID, 7);
+    Util_LnDec(&ln, pT->dwTID, 8);
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, pT->vaETHREAD, 16, FALSE);
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, pT->bState, 2, FALSE);
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, pT->bRunning, 2, FALSE);
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, pT->bBasePriority, 2, FALSE);
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, pT->bPriority, 2, FALSE);
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, pT->dwExitStatus, 8, FALSE);
+    Util_LnChar(&ln, ' ');
+    Util_LnHex(&ln, pT->vaStartAddress, 16, FALSE);
+    Util_LnStr(&ln, " -- ", 0);
+    Util_LnHex(&ln, pT->vaTeb, 16, FALSE);
+    Util_LnStr(&ln, " : ", 0);
+    Util_LnHex(&ln, pT->vaStackBaseUser, 16, FALSE);
+    Util_LnStr(&ln, " > ", 0);
+    Util_LnHex(&ln, pT->vaStackLimitUser, 16, FALSE);
+    Util_LnStr(&ln, " [", 0);
+    Util_LnStr(&ln, szTimeCreate, 0);
+    Util_LnStr(&ln, " :: ", 0);
+    Util_LnStr(&ln, szTimeExit, 0);
+    Util_LnChar(&ln, ']');
+    Util_LnEnd(&ln);
+}
+
 _Success_(return == 0)
 NTSTATUS ThreadInfo_Read_ThreadMap(_In_ PVMMOB_MAP_THREAD pThreadMap, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
 {
-    NTSTATUS nt;
-    LPSTR sz;
-    QWORD i, o = 0, cbMax, cStart, cEnd, cbLINELENGTH;
-    PVMM_MAP_THREADENTRY pT;
-    CHAR szTimeCreate[MAX_PATH] = { 0 }, szTimeExit[MAX_PATH] = { 0 };
-    cbLINELENGTH = THREADINFO_LINELENGTH;
-    cStart = (DWORD)(cbOffset / cbLINELENGTH);
-    cEnd = (DWORD)min(pThreadMap->cMap - 1, (cb + cbOffset + cbLINELENGTH - 1) / cbLINELENGTH);
-    cbMax = 1 + (1 + cEnd - cStart) * cbLINELENGTH;
-    if(!pThreadMap->cMap || (cStart > pThreadMap->cMap)) { return VMMDLL_STATUS_END_OF_FILE; }
-    if(!(sz = LocalAlloc(LMEM_ZEROINIT, cbMax))) { return VMMDLL_STATUS_FILE_INVALID; }
-    for(i = cStart; i <= cEnd; i++) {
-        pT = pThreadMap->pMap + i;
-        Util_FileTime2String((PFILETIME)&pT->ftCreateTime, szTimeCreate);
-        Util_FileTime2String((PFILETIME)&pT->ftExitTime, szTimeExit);
-        o += snprintf(
-            sz + o,
-            cbMax - o,
-            "%04x%7i%8i %16llx %2x %2x %2x %2x %8x %16llx -- %16llx : %16llx > %16llx [%s :: %s]\n",
-            (DWORD)i,
-            pT->dwPID,
-            pT->dwTID,
-            pT->vaETHREAD,
-            pT->bState,
-            pT->bRunning,
-            pT->bBasePriority,
-            pT->bPriority,
-            pT->dwExitStatus,
-            pT->vaStartAddress,
-            pT->vaTeb,
-            pT->vaStackBaseUser,
-            pT->vaStackLimitUser,
-            szTimeCreate,
-            szTimeExit
-        );
-    }
-    nt = Util_VfsReadFile_FromPBYTE(sz, cbMax - 1, pb, cb, pcbRead, cbOffset - cStart * cbLINELENGTH);
-    LocalFree(sz);
-    return nt;
+    return VmmMapText_Read(
+        (POB)pThreadMap,
+        0,
+        pThreadMap->cMap,
+        (DWORD)THREADINFO_LINELENGTH,
+        pThreadMap,
+        (VMM_MAPTEXT_PFN_RENDERLINE)ThreadInfo_Read_ThreadMap_RenderLine,
+        pb, cb, pcbRead, cbOffset
+    );
 }
 
 /*
@@ -13,7 +13,8 @@ typedef struct tdOB_MMPFN_CONTEXT {
     OB ObHdr;
     QWORD vaPfnDatabase;
     CRITICAL_SECTION Lock;
-    POB_CONTAINER pObCProcTableDTB;
+    POB_CONTAINER pObCProcTableDTB;         // POB_MAP: DTB pfn -> PID
+    POB_CONTAINER pObCPageTableIndex;       // POB_MAP: page table pfn -> MMPFN_PTINDEX (x64 only)
     struct {
         WORD cb;
         WORD oOriginalPte;
@@ -26,9 +27,19 @@ typedef struct tdOB_MMPFN_CONTEXT {
 } OB_MMPFN_CONTEXT, *POB_MMPFN_CONTEXT;
 
 #define MMPFN_PFN_TO_VA(ctx, i)     (ctx->vaPfnDatabase + (QWORD)i * ctx->_MMPFN.cb)
+#define MMPFN_PFN_KEY(dwPfn)        (0x80000000'00000000 | (dwPfn))
+
+// page table index entry: bits 0-31 = PID (0 = kernel), bits 32-34 = paging
+// level of the table, bits 35-61 = va[47:21] of the region mapped by table.
+#define MMPFN_PTINDEX(dwPID, iPML, va)  (0x80000000'00000000 | ((((va) >> 21) & 0x07ffffff) << 35) | ((QWORD)(iPML) << 32) | (dwPID))
+#define MMPFN_PTINDEX_PID(qw)           ((DWORD)(qw))
+#define MMPFN_PTINDEX_PML(qw)           ((BYTE)(((qw) >> 32) & 7))
+#define MMPFN_PTINDEX_VA(qw)            ((((qw) >> 35) & 0x07ffffff) << 21)
 
 VOID MmPfn_CallbackCleanup_ObContext(POB_MMPFN_CONTEXT ctx)
 {
+    Ob_DECREF(ctx->pObCProcTableDTB);
+    Ob_DECREF(ctx->pObCPageTableIndex);
     DeleteCriticalSection(&ctx->Lock);
 }
 
@@ -37,6 +48,7 @@ VOID MmPfn_Refresh()
     POB_MMPFN_CONTEXT ctx = (POB_MMPFN_CONTEXT)ctxVmm->pObPfnContext;
     if(!ctx) { return; }
     ObContainer_SetOb(ctx->pObCProcTableDTB, NULL);
+    ObContainer_SetOb(ctx->pObCPageTableIndex, NULL);
 }
 
 VOID MmPfn_Initialize(_In_ PVMM_PROCESS pSystemProcess)
@@ -46,6 +58,7 @@ VOID MmPfn_Initialize(_In_ PVMM_PROCESS pSystemProcess)
     if(!(ctx = Ob_Alloc(OB_TAG_PFN_CONTEXT, LMEM_ZEROINIT, sizeof(OB_MMPFN_CONTEXT), MmPfn_CallbackCleanup_ObContext, NULL))) { return; }
     InitializeCriticalSection(&ctx->Lock);
     f = (ctx->pObCProcTableDTB = ObContainer_New(NULL)) &&
+        (ctx->pObCPageTableIndex = ObContainer_New(NULL)) &&
         PDB_GetSymbolPTR(PDB_HANDLE_KERNEL, "MmPfnDatabase", pSystemProcess, &ctx->vaPfnDatabase) &&
         PDB_GetTypeSizeShort(PDB_HANDLE_KERNEL, "_MMPFN", &ctx->_MMPFN.cb) &&
         PDB_GetTypeChildOffsetShort(PDB_HANDLE_KERNEL, "_MMPFN", L"OriginalPte", &ctx->_MMPFN.oOriginalPte) &&
@@ -59,53 +72,36 @@ VOID MmPfn_Initialize(_In_ PVMM_PROCESS pSystemProcess)
 }
 
 /*
-* Create a new process data table sorted on DTB PFN.
+* Create a new process table hashed on DTB PFN.
 * CALLER DECREF: return
 * -- ctx
 * -- return
 */
-POB_DATA MmPfn_ProcDTB_Create(_In_ POB_MMPFN_CONTEXT ctx)
+POB_MAP MmPfn_ProcDTB_Create(_In_ POB_MMPFN_CONTEXT ctx)
 {
-    SIZE_T i, j, cPIDs = 0, cEntries;
-    POB_DATA pObData = NULL;
+    QWORD j, qwPte;
+    POB_MAP pmObDTB = NULL;
     PVMM_PROCESS pObProcess = NULL;
     PVMMOB_CACHE_MEM pObPDPT = NULL;
-    QWORD qwPte;
-    VmmProcessListPIDs(NULL, &cPIDs, 0);
-    cEntries = cPIDs * ((ctxVmm->tpMemoryModel == VMM_MEMORYMODEL_X86PAE) ? 4 : 1);
-    if(!(pObData = Ob_Alloc(OB_TAG_PFN_PROC_TABLE, LMEM_ZEROINIT, sizeof(OB) + cEntries * sizeof(QWORD), NULL, NULL))) { return NULL; }
-    VmmProcessListPIDs(pObData->pdw, &cPIDs, 0);
-    for(i = 0; i < cPIDs; i++) {
-        if((pObProcess = VmmProcessGet(pObData->pdw[cPIDs - i - 1]))) {
-            if((ctxVmm->tpMemoryModel == VMM_MEMORYMODEL_X64) || (ctxVmm->tpMemoryModel == VMM_MEMORYMODEL_X86)) {
-                if(pObProcess->fUserOnly) {
-                    pObData->pqw[cPIDs - i - 1] = pObProcess->dwPID | (pObProcess->paDTB << 20);
-                }
-            } else if(ctxVmm->tpMemoryModel == VMM_MEMORYMODEL_X86PAE) {
-                if(pObPDPT = VmmTlbGetPageTable(pObProcess->paDTB & ~0xfff, FALSE)) {
-                    for(j = 0; j < 4; j++) {
-                        if((qwPte = pObPDPT->pqw[((pObProcess->paDTB & 0xfff) >> 3) + j])) {
-                            pObData->pqw[(cPIDs - i - 1) * 4 + j] = pObProcess->dwPID | ((qwPte & 0x00000fff'fffff000) << 20) | (j << 30);
-                        }
+    if(!(pmObDTB = ObMap_New(0))) { return NULL; }
+    while((pObProcess = VmmProcessGetNext(pObProcess, 0))) {
+        if((ctxVmm->tpMemoryModel == VMM_MEMORYMODEL_X64) || (ctxVmm->tpMemoryModel == VMM_MEMORYMODEL_X86)) {
+            if(pObProcess->fUserOnly) {
+                ObMap_Push(pmObDTB, MMPFN_PFN_KEY(pObProcess->paDTB >> 12), (PVOID)(QWORD)pObProcess->dwPID);
+            }
+        } else if(ctxVmm->tpMemoryModel == VMM_MEMORYMODEL_X86PAE) {
+            if((pObPDPT = VmmTlbGetPageTable(pObProcess->paDTB & ~0xfff, FALSE))) {
+                for(j = 0; j < 4; j++) {
+                    if((qwPte = pObPDPT->pqw[((pObProcess->paDTB & 0xfff) >> 3) + j])) {
+                        ObMap_Push(pmObDTB, MMPFN_PFN_KEY((qwPte & 0x00000fff'fffff000) >> 12), (PVOID)(pObProcess->dwPID | (j << 30)));
                     }
-                    Ob_DECREF_NULL(&pObPDPT);
                 }
+                Ob_DECREF_NULL(&pObPDPT);
             }
-            Ob_DECREF_NULL(&pObProcess);
         }
     }
-    qsort(pObData->pqw, cEntries, sizeof(QWORD), Util_qsort_QWORD);
-    ObContainer_SetOb(ctx->pObCProcTableDTB, pObData);
-    return pObData;
-}
-
-int MmPfn_GetPidFromDTB_qfind(_In_ PVOID pvFind, _In_ PVOID pvEntry)
-{
-    DWORD dwKey = (DWORD)(QWORD)pvFind;
-    DWORD dwEntry = (*(PQWORD)pvEntry) >> 32;
-    if(dwEntry > dwKey) { return -1; }
-    if(dwEntry < dwKey) { return 1; }
-    return 0;
+    ObContainer_SetOb(ctx->pObCProcTableDTB, pmObDTB);
+    return pmObDTB;
 }
 
 /*
@@ -116,44 +112,265 @@ int MmPfn_GetPidFromDTB_qfind(_In_ PVOID pvFind, _In_ PVOID pvEntry)
 DWORD MmPfn_GetPidFromDTB(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD qwPfnDTB)
 {
     DWORD dwPID;
-    PVOID pvFind;
-    POB_DATA pObData = NULL;
+    POB_MAP pmObDTB = NULL;
     if(qwPfnDTB == (pSystemProcess->paDTB >> 12)) { return 0; }
-    if(!(pObData = ObContainer_GetOb(ctx->pObCProcTableDTB))) {
+    if(!(pmObDTB = ObContainer_GetOb(ctx->pObCProcTableDTB))) {
         EnterCriticalSection(&ctx->Lock);
-        if(!(pObData = ObContainer_GetOb(ctx->pObCProcTableDTB))) {
-            pObData = MmPfn_ProcDTB_Create(ctx);
+        if(!(pmObDTB = ObContainer_GetOb(ctx->pObCProcTableDTB))) {
+            pmObDTB = MmPfn_ProcDTB_Create(ctx);
         }
         LeaveCriticalSection(&ctx->Lock);
     }
-    if(!pObData) { return 0; }
-    pvFind = Util_qfind((PVOID)qwPfnDTB, pObData->ObHdr.cbData / sizeof(QWORD), pObData->pqw, sizeof(QWORD), MmPfn_GetPidFromDTB_qfind);
-    dwPID = pvFind ? (DWORD)*(PQWORD)pvFind : 0;
-    Ob_DECREF(pObData);
+    if(!pmObDTB) { return 0; }
+    dwPID = (DWORD)(QWORD)ObMap_GetByKey(pmObDTB, MMPFN_PFN_KEY(qwPfnDTB));
+    Ob_DECREF(pmObDTB);
     return dwPID;
 }
 
-VOID MmPfn_Map_GetPfn_GetVaX64(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ POB_SET psPte, _In_ POB_SET psPrefetch, _In_ BYTE iPML)
+VOID MmPfn_PageTableIndex_AddX64(_In_ POB_MAP pmIndex, _In_ DWORD dwPID, _In_ QWORD pa, _In_ QWORD vaBase, _In_ BYTE iPML, _In_ BOOL fUserOnly)
+{
+    QWORD i, pte, va;
+    PVMMOB_CACHE_MEM pObPT = NULL;
+    // tables already indexed are shared or self-referencing - skip them.
+    if(!ObMap_Push(pmIndex, MMPFN_PFN_KEY(pa >> 12), (PVOID)MMPFN_PTINDEX(dwPID, iPML, vaBase))) { return; }
+    if(iPML == 1) { return; }
+    if(!(pObPT = VmmTlbGetPageTable(pa, TRUE))) { return; }
+    for(i = 0; i < 512; i++) {
+        pte = pObPT->pqw[i];
+        if(!(pte & 0x01)) { continue; }                 // not valid
+        if(pte & 0x80) { continue; }                    // large page - not ptr to table
+        if(fUserOnly && !(pte & 0x04)) { continue; }    // supervisor entry
+        va = vaBase + (i << (iPML * 9 + 3));
+        MmPfn_PageTableIndex_AddX64(pmIndex, dwPID, pte & 0x0000ffff'fffff000, va, iPML - 1, fUserOnly);
+    }
+    Ob_DECREF(pObPT);
+}
+
+VOID MmPfn_PageTableIndex_SpiderCB(_In_ PVMM_PROCESS pProcess, _In_opt_ PVOID ctx)
+{
+    VmmTlbSpider(pProcess);
+}
+
+BOOL MmPfn_PageTableIndex_SpiderCriteriaCB(_In_ PVMM_PROCESS pProcess, _In_opt_ PVOID ctx)
+{
+    return pProcess->fUserOnly && !pProcess->fTlbSpiderDone;
+}
+
+/*
+* Create a new index mapping each page table page PFN (all levels) to its
+* owning PID and the virtual address region it maps. The index is built from
+* the spidered TLB caches of the system process and all user mode processes.
+* Currently only supported on the x64 memory model.
+* CALLER DECREF: return
+* -- ctx
+* -- pSystemProcess
+* -- return
+*/
+POB_MAP MmPfn_PageTableIndex_Create(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess)
+{
+    QWORD tmStart = GetTickCount64();
+    POB_MAP pmObIndex = NULL;
+    PVMM_PROCESS pObProcess = NULL;
+    if(ctxVmm->tpMemoryModel != VMM_MEMORYMODEL_X64) { return NULL; }
+    if(!(pmObIndex = ObMap_New(0))) { return NULL; }
+    VmmTlbSpider(pSystemProcess);
+    VmmProcessActionForeachParallel(NULL, MmPfn_PageTableIndex_SpiderCriteriaCB, MmPfn_PageTableIndex_SpiderCB);
+    MmPfn_PageTableIndex_AddX64(pmObIndex, 0, pSystemProcess->paDTB & ~0xfff, 0, 4, FALSE);
+    while((pObProcess = VmmProcessGetNext(pObProcess, 0))) {
+        if(pObProcess->fUserOnly) {
+            MmPfn_PageTableIndex_AddX64(pmObIndex, pObProcess->dwPID, pObProcess->paDTB & ~0xfff, 0, 4, TRUE);
+        }
+    }
+    ObContainer_SetOb(ctx->pObCPageTableIndex, pmObIndex);
+    vmmprintfvv_fn("%i page tables indexed in %llims\n", ObMap_Size(pmObIndex), GetTickCount64() - tmStart);
+    return pmObIndex;
+}
+
+/*
+* Retrieve the page table index - create it if required.
+* CALLER DECREF: return
+* -- ctx
+* -- pSystemProcess
+* -- return
+*/
+POB_MAP MmPfn_PageTableIndex_Get(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess)
+{
+    POB_MAP pmObIndex;
+    if(!(pmObIndex = ObContainer_GetOb(ctx->pObCPageTableIndex))) {
+        EnterCriticalSection(&ctx->Lock);
+        if(!(pmObIndex = ObContainer_GetOb(ctx->pObCPageTableIndex))) {
+            pmObIndex = MmPfn_PageTableIndex_Create(ctx, pSystemProcess);
+        }
+        LeaveCriticalSection(&ctx->Lock);
+    }
+    return pmObIndex;
+}
+
+/*
+* Walk the (cached) x64 page tables of a DTB for a virtual address and retrieve
+* the PFNs of the paging levels 2-4 - i.e. the tables containing the PTE of the
+* level 1 page table which maps the virtual address.
+* -- paDTB
+* -- va
+* -- dwPfnPte = receives PFNs of paging levels 1-4 (index 1-4).
+* -- return
+*/
+_Success_(return)
+BOOL MmPfn_Map_GetPfn_GetVaX64Index_Walk(_In_ QWORD paDTB, _In_ QWORD va, _Out_writes_(5) DWORD dwPfnPte[5])
+{
+    BYTE iPML;
+    QWORD pte, paPT = paDTB & 0x0000ffff'fffff000;
+    PVMMOB_CACHE_MEM pObPT;
+    dwPfnPte[0] = 0;
+    dwPfnPte[4] = (DWORD)(paPT >> 12);
+    for(iPML = 4; iPML > 1; iPML--) {
+        if(!(pObPT = VmmTlbGetPageTable(paPT, FALSE))) { return FALSE; }
+        pte = pObPT->pqw[0x1ff & (va >> (12 + 9 * (iPML - 1)))];
+        Ob_DECREF(pObPT);
+        if(!(pte & 0x01) || (pte & 0x80)) { return FALSE; }
+        paPT = pte & 0x0000ffff'fffff000;
+        dwPfnPte[iPML - 1] = (DWORD)(paPT >> 12);
+    }
+    return TRUE;
+}
+
+/*
+* Resolve virtual address and PID of PFNs mapped by indexed page tables in O(1).
+* The upper paging level PFNs are retrieved from the cached page tables of the
+* owning DTB so that resolved entries carry the same information and extended
+* type as entries resolved by the page table walk (MmPfn_Map_GetPfn_GetVaX64).
+* Entries not resolved are pushed onto psUnresolved for a page table walk.
+* -- ctx
+* -- pSystemProcess
+* -- psPte
+* -- pmIndex
+* -- psUnresolved
+*/
+VOID MmPfn_Map_GetPfn_GetVaX64Index(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ POB_SET psPte, _In_ POB_MAP pmIndex, _In_ POB_SET psUnresolved)
+{
+    PMMPFN_MAP_ENTRY pe;
+    DWORD i, c, dwPidIndex, dwPfnPte[5];
+    QWORD qw, va, pa, paDTB;
+    POB_MAP pmObDTB = NULL;
+    PVMM_PROCESS pObProcess;
+    if(!(pmObDTB = ObMap_New(0))) { return; }
+    for(i = 0, c = ObSet_Size(psPte); i < c; i++) {
+        pe = (PMMPFN_MAP_ENTRY)ObSet_Get(psPte, i);
+        if(!pe) { continue; }
+        qw = (QWORD)ObMap_GetByKey(pmIndex, MMPFN_PFN_KEY(pe->AddressInfo.dwPfnPte[1]));
+        if(!qw || (MMPFN_PTINDEX_PML(qw) != 1)) {
+            ObSet_Push(psUnresolved, (QWORD)pe);
+            continue;
+        }
+        va = MMPFN_PTINDEX_VA(qw) + ((pe->vaPte & 0xff8) << 9);
+        if(va >> 47) {
+            va = va | 0xffff0000'00000000;
+        }
+        // retrieve upper paging level PFNs from the DTB the table was indexed from.
+        dwPidIndex = MMPFN_PTINDEX_PID(qw);
+        if(!(paDTB = (QWORD)ObMap_GetByKey(pmObDTB, MMPFN_PFN_KEY(dwPidIndex)))) {
+            if(!dwPidIndex) {
+                paDTB = pSystemProcess->paDTB;
+            } else if((pObProcess = VmmProcessGet(dwPidIndex))) {
+                paDTB = pObProcess->paDTB;
+                Ob_DECREF(pObProcess);
+            }
+            if(paDTB) { ObMap_Push(pmObDTB, MMPFN_PFN_KEY(dwPidIndex), (PVOID)paDTB); }
+        }
+        if(!paDTB || !MmPfn_Map_GetPfn_GetVaX64Index_Walk(paDTB, va, dwPfnPte) || (dwPfnPte[1] != pe->AddressInfo.dwPfnPte[1])) {
+            ObSet_Push(psUnresolved, (QWORD)pe);
+            continue;
+        }
+        pe->AddressInfo.dwPfnPte[2] = dwPfnPte[2];
+        pe->AddressInfo.dwPfnPte[3] = dwPfnPte[3];
+        pe->AddressInfo.dwPfnPte[4] = dwPfnPte[4];
+        // pid, verification and extended type - same as the page table walk.
+        pe->AddressInfo.va = va;
+        pe->AddressInfo.dwPid = MmPfn_GetPidFromDTB(ctx, pSystemProcess, (QWORD)pe->AddressInfo.dwPfnPte[4]);
+        if(pe->AddressInfo.dwPid && (pe->AddressInfo.dwPid != 4)) {
+            pe->tpExtended = MmPfnExType_ProcessPrivate;
+        }
+        if(!pe->AddressInfo.dwPid && (!VmmVirt2Phys(pSystemProcess, pe->AddressInfo.va, &pa) || (pe->dwPfn != pa >> 12))) {
+            pe->AddressInfo.va = 0;
+        }
+        if(pe->AddressInfo.va && (pe->AddressInfo.dwPfnPte[3] == pe->AddressInfo.dwPfnPte[4])) {
+            pe->tpExtended = MmPfnExType_PageTable;
+        }
+    }
+    Ob_DECREF(pmObDTB);
+}
+
+#define MMPFN_PARALLEL_THRESHOLD        0x00004000      // min # pfns per parallel decode work item
+#define MMPFN_PARALLEL_MAX              0x10            // max # parallel decode work items
+#define MMPFN_READ_CHUNK_PAGES          0x100           // # pfn database pages per bulk read
+
+// memoized page table _MMPFN entry: bits 0-31 = u4 (containing pte frame),
+// bits 32-43 = PteAddress[11:0], bits 44-46 = PageLocation, bit 47 = read ok.
+#define MMPFN_PTE_MEMO                  0x80000000'00000000
+#define MMPFN_PTE_READ                  0x00008000'00000000
+#define MMPFN_PTE_TP(qw)                ((BYTE)(((qw) >> 44) & 7))
+#define MMPFN_PTE_OFFSET(qw)            ((DWORD)(((qw) >> 32) & 0xfff))
+
+typedef struct tdMMPFN_MAP_CONTEXT {
+    POB_MMPFN_CONTEXT ctx;
+    PVMM_PROCESS pSystemProcess;
+    PMMPFNOB_MAP pPfnMap;
+    POB_SET psEnrichAddress;
+    POB_SET psPrefetch;
+    BOOL fExtended;
+    BOOL fSequential;
+    DWORD cWork;
+} MMPFN_MAP_CONTEXT, *PMMPFN_MAP_CONTEXT;
+
+/*
+* Retrieve the relevant parts of the _MMPFN entry of a page table page. All
+* pages mapped by the same page table share the same page table chain - so the
+* result is memoized in pmPte to avoid re-reading the same _MMPFN entries once
+* for each page.
+* -- ctx
+* -- pSystemProcess
+* -- pmPte
+* -- dwPfn = PFN of page table page.
+* -- return = MMPFN_PTE_* encoded value.
+*/
+QWORD MmPfn_Map_GetPfn_ReadPte(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ POB_MAP pmPte, _In_ DWORD dwPfn)
+{
+    QWORD qw;
+    DWORD cbRead;
+    BYTE pbPfn[0x30];
+    if((qw = (QWORD)ObMap_GetByKey(pmPte, MMPFN_PFN_KEY(dwPfn)))) { return qw; }
+    VmmReadEx(pSystemProcess, MMPFN_PFN_TO_VA(ctx, dwPfn), pbPfn, ctx->_MMPFN.cb, &cbRead, 0);
+    qw = MMPFN_PTE_MEMO;
+    if(cbRead) {
+        qw |= MMPFN_PTE_READ |
+            ((QWORD)(pbPfn[ctx->_MMPFN.ou3 + 2] & 0x7) << 44) |                            // "PageLocation"
+            ((QWORD)(*(PDWORD)(pbPfn + ctx->_MMPFN.oPteAddress) & 0xfff) << 32) |
+            *(PDWORD)(pbPfn + ctx->_MMPFN.ou4);                                             // "Containing" PTE
+    }
+    ObMap_Push(pmPte, MMPFN_PFN_KEY(dwPfn), (PVOID)qw);
+    return qw;
+}
+
+VOID MmPfn_Map_GetPfn_GetVaX64(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ POB_SET psPte, _In_ POB_SET psPrefetch, _In_ POB_MAP pmPte, _In_ BYTE iPML)
 {
     BOOL f;
-    BYTE tp, pbPfn[0x30];
+    BYTE tp;
     PMMPFN_MAP_ENTRY pe;
-    DWORD i, c, iPfnNext, cbRead;
-    QWORD pa;
-    PVMMOB_CACHE_MEM pObPD = NULL;
+    DWORD i, c, iPfnNext;
+    QWORD pa, qwPte;
     VmmCachePrefetchPages(pSystemProcess, psPrefetch, 0);
     ObSet_Clear(psPrefetch);
     for(i = 0, c = ObSet_Size(psPte); i < c; i++) {
         pe = (PMMPFN_MAP_ENTRY)ObSet_Get(psPte, i);
         if(!pe || !pe->AddressInfo.va) { continue; }
-        VmmReadEx(pSystemProcess, MMPFN_PFN_TO_VA(ctx, pe->AddressInfo.dwPfnPte[iPML]), pbPfn, ctx->_MMPFN.cb, &cbRead, 0);
-        f = cbRead &&
-            (tp = (pbPfn[ctx->_MMPFN.ou3 + 2] & 0x7)) &&                                    // "PageLocation"
+        qwPte = MmPfn_Map_GetPfn_ReadPte(ctx, pSystemProcess, pmPte, pe->AddressInfo.dwPfnPte[iPML]);
+        f = (qwPte & MMPFN_PTE_READ) &&
+            (tp = MMPFN_PTE_TP(qwPte)) &&
             ((tp == MmPfnTypeActive) || (pe->PageLocation == MmPfnTypeStandby) || (tp == MmPfnTypeModified) || (tp == MmPfnTypeModifiedNoWrite)) &&
-            (iPfnNext = *(PDWORD)(pbPfn + ctx->_MMPFN.ou4)) &&                              // "Containing" PTE
+            (iPfnNext = (DWORD)qwPte) &&
             (iPfnNext <= ctx->iPfnMax) && (pe->AddressInfo.dwPfnPte[iPML + 1] = iPfnNext);
         if(f) {
-            pe->AddressInfo.va += (*(PQWORD)(pbPfn + ctx->_MMPFN.oPteAddress) & 0xff8) << (iPML + 1) * 9;
+            pe->AddressInfo.va += (QWORD)(MMPFN_PTE_OFFSET(qwPte) & 0xff8) << (iPML + 1) * 9;
             if(iPML == 3) {
                 pe->AddressInfo.va = pe->AddressInfo.va & ~0xfff;
                 if(pe->AddressInfo.va >> 47) {
@@ -171,7 +388,7 @@ VOID MmPfn_Map_GetPfn_GetVaX64(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSy
                         pe->tpExtended = MmPfnExType_PageTable;
                     }
                 }
-            } else {
+            } else if(!ObMap_ExistsKey(pmPte, MMPFN_PFN_KEY(iPfnNext))) {
                 ObSet_Push_PageAlign(psPrefetch, MMPFN_PFN_TO_VA(ctx, iPfnNext), ctx->_MMPFN.cb);
             }
         } else {
@@ -179,17 +396,17 @@ VOID MmPfn_Map_GetPfn_GetVaX64(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSy
         }
     }
     if(iPML < 3) {
-        MmPfn_Map_GetPfn_GetVaX64(ctx, pSystemProcess, psPte, psPrefetch, iPML + 1);
+        MmPfn_Map_GetPfn_GetVaX64(ctx, pSystemProcess, psPte, psPrefetch, pmPte, iPML + 1);
     }
 }
 
-VOID MmPfn_Map_GetPfn_GetVaX86PAE(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ POB_SET psPte, _In_ POB_SET psPrefetch, _In_ BYTE iPML)
+VOID MmPfn_Map_GetPfn_GetVaX86PAE(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ POB_SET psPte, _In_ POB_SET psPrefetch, _In_ POB_MAP pmPte, _In_ BYTE iPML)
 {
     BOOL f;
-    BYTE tp, pbPfn[0x30];
+    BYTE tp;
     PMMPFN_MAP_ENTRY pe;
-    QWORD pa;
-    DWORD i, c, iPfnNext, cbRead, dwPidEx, iPfn, dwPid;
+    QWORD pa, qwPte;
+    DWORD i, c, iPfnNext, dwPidEx, iPfn, dwPid;
     VmmCachePrefetchPages(pSystemProcess, psPrefetch, 0);
     ObSet_Clear(psPrefetch);
     for(i = 0, c = ObSet_Size(psPte); i < c; i++) {
@@ -211,31 +428,33 @@ VOID MmPfn_Map_GetPfn_GetVaX86PAE(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS
             }
             continue;
         }
-        VmmReadEx(pSystemProcess, MMPFN_PFN_TO_VA(ctx, pe->AddressInfo.dwPfnPte[iPML]), pbPfn, ctx->_MMPFN.cb, &cbRead, 0);
-        f = cbRead &&
-            (tp = (pbPfn[ctx->_MMPFN.ou3 + 2] & 0x7)) &&                                    // "PageLocation"
+        qwPte = MmPfn_Map_GetPfn_ReadPte(ctx, pSystemProcess, pmPte, pe->AddressInfo.dwPfnPte[iPML]);
+        f = (qwPte & MMPFN_PTE_READ) &&
+            (tp = MMPFN_PTE_TP(qwPte)) &&
             ((tp == MmPfnTypeActive) || (pe->PageLocation == MmPfnTypeStandby) || (tp == MmPfnTypeModified) || (tp == MmPfnTypeModifiedNoWrite)) &&
-            (iPfnNext = *(PDWORD)(pbPfn + ctx->_MMPFN.ou4) & 0x00ffffff) &&                 // "Containing" PTE
+            (iPfnNext = (DWORD)qwPte & 0x00ffffff) &&
             (iPfnNext <= ctx->iPfnMax) && (pe->AddressInfo.dwPfnPte[iPML + 1] = iPfnNext);
         if(f) {
-            pe->AddressInfo.va += (QWORD)((*(PDWORD)(pbPfn + ctx->_MMPFN.oPteAddress) & 0xff8)) << (iPML + 1) * 9;
-            ObSet_Push_PageAlign(psPrefetch, MMPFN_PFN_TO_VA(ctx, iPfnNext), ctx->_MMPFN.cb);
+            pe->AddressInfo.va += (QWORD)(MMPFN_PTE_OFFSET(qwPte) & 0xff8) << (iPML + 1) * 9;
+            if(!ObMap_ExistsKey(pmPte, MMPFN_PFN_KEY(iPfnNext))) {
+                ObSet_Push_PageAlign(psPrefetch, MMPFN_PFN_TO_VA(ctx, iPfnNext), ctx->_MMPFN.cb);
+            }
         } else {
             pe->AddressInfo.va = 0;
         }
     }
     if(iPML < 2) {
-        MmPfn_Map_GetPfn_GetVaX86PAE(ctx, pSystemProcess, psPte, psPrefetch, iPML + 1);
+        MmPfn_Map_GetPfn_GetVaX86PAE(ctx, pSystemProcess, psPte, psPrefetch, pmPte, iPML + 1);
     }
 }
 
-VOID MmPfn_Map_GetPfn_GetVaX86(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ POB_SET psPte, _In_ POB_SET psPrefetch)
+VOID MmPfn_Map_GetPfn_GetVaX86(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ POB_SET psPte, _In_ POB_SET psPrefetch, _In_ POB_MAP pmPte)
 {
     BOOL f;
-    BYTE tp, pbPfn[0x30];
+    BYTE tp;
     PMMPFN_MAP_ENTRY pe;
-    DWORD i, c, iPfnNext, cbRead, dwPID, dwPte;
-    QWORD pa;
+    DWORD i, c, iPfnNext, dwPID, dwPte;
+    QWORD pa, qwPte;
     PVMMOB_CACHE_MEM pObPD = NULL;
     VmmCachePrefetchPages(pSystemProcess, psPrefetch, 0);
     ObSet_Clear(psPrefetch);
@@ -243,14 +462,14 @@ VOID MmPfn_Map_GetPfn_GetVaX86(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSy
         pe = (PMMPFN_MAP_ENTRY)ObSet_Get(psPte, i);
         if(!pe) { continue; }
         pe->AddressInfo.va = 0;
-        VmmReadEx(pSystemProcess, MMPFN_PFN_TO_VA(ctx, pe->AddressInfo.dwPfnPte[1]), pbPfn, ctx->_MMPFN.cb, &cbRead, 0);
-        f = cbRead &&
-            (tp = (pbPfn[ctx->_MMPFN.ou3 + 2] & 0x7)) &&                                    // "PageLocation"
+        qwPte = MmPfn_Map_GetPfn_ReadPte(ctx, pSystemProcess, pmPte, pe->AddressInfo.dwPfnPte[1]);
+        f = (qwPte & MMPFN_PTE_READ) &&
+            (tp = MMPFN_PTE_TP(qwPte)) &&
             ((tp == MmPfnTypeActive) || (pe->PageLocation == MmPfnTypeStandby) || (tp == MmPfnTypeModified) || (tp == MmPfnTypeModifiedNoWrite)) &&
-            (iPfnNext = *(PDWORD)(pbPfn + ctx->_MMPFN.ou4)) &&                              // "Containing" PTE
+            (iPfnNext = (DWORD)qwPte) &&
             (iPfnNext <= ctx->iPfnMax) && (pe->AddressInfo.dwPfnPte[2] = iPfnNext);
         if(!f) { continue; }
-        pe->AddressInfo.va += ((QWORD)(*(PDWORD)(pbPfn + ctx->_MMPFN.oPteAddress) & 0xffc) << 20) + ((pe->vaPte & 0xffc) << 10);
+        pe->AddressInfo.va += ((QWORD)(MMPFN_PTE_OFFSET(qwPte) & 0xffc) << 20) + ((pe->vaPte & 0xffc) << 10);
         dwPID = MmPfn_GetPidFromDTB(ctx, pSystemProcess, (QWORD)pe->AddressInfo.dwPfnPte[2]);
         if(dwPID && (dwPID != 4)) {
             pe->AddressInfo.dwPid = dwPID;
@@ -274,103 +493,230 @@ VOID MmPfn_Map_GetPfn_GetVaX86(_In_ POB_MMPFN_CONTEXT ctx, _In_ PVMM_PROCESS pSy
     }
 }
 
-_Success_(return)
-BOOL MmPfn_Map_GetPfnScatter(_In_ POB_SET psPfn, _Out_ PMMPFNOB_MAP *ppObPfnMap, _In_ BOOL fExtended)
+/*
+* Decode a single _MMPFN entry into its map entry.
+* -- mctx
+* -- pe
+* -- pbPfn = _MMPFN entry of size ctx->_MMPFN.cb.
+*/
+VOID MmPfn_Map_GetPfn_DecodeEntry(_In_ PMMPFN_MAP_CONTEXT mctx, _Inout_ PMMPFN_MAP_ENTRY pe, _In_ PBYTE pbPfn)
 {
-    POB_MMPFN_CONTEXT ctx = (POB_MMPFN_CONTEXT)ctxVmm->pObPfnContext;
+    POB_MMPFN_CONTEXT ctx = mctx->ctx;
     BOOL f32 = ctxVmm->f32;
+    QWORD qw;
+    DWORD tp;
+    pe->_u3 = *(PDWORD)(pbPfn + ctx->_MMPFN.ou3);
+    qw = *(PQWORD)(pbPfn + ctx->_MMPFN.ou4);
+    if(f32) {
+        pe->PteFrame = qw & 0x00ffffff;
+        pe->PteFrameHigh = (qw >> 20) & 0xf;
+        pe->PrototypePte = (qw >> 27) & 0x1;
+        pe->PageColor = (qw >> 28) & 0xf;
+    } else {
+        pe->_u4 = qw;
+    }
+    pe->vaPte = VMM_PTR_OFFSET(f32, pbPfn, ctx->_MMPFN.oPteAddress);
+    pe->OriginalPte = VMM_PTR_OFFSET(f32, pbPfn, ctx->_MMPFN.oOriginalPte);
+    tp = pe->PageLocation;
+    if(mctx->fExtended && (tp == MmPfnTypeActive) || (tp == MmPfnTypeStandby) || (tp == MmPfnTypeModified) || (tp == MmPfnTypeModifiedNoWrite)) {
+        if(!pe->PrototypePte && !pe->PteFrameHigh && (pe->PteFrame <= ctx->iPfnMax)) {
+            pe->AddressInfo.va = ((pe->vaPte << 9) & 0x1ff000) | 0xfff;
+            pe->AddressInfo.dwPfnPte[1] = pe->PteFrame;
+            ObSet_Push(mctx->psEnrichAddress, (QWORD)pe);
+            ObSet_Push_PageAlign(mctx->psPrefetch, MMPFN_PFN_TO_VA(ctx, pe->AddressInfo.dwPfnPte[1]), ctx->_MMPFN.cb);
+        } else if((tp == MmPfnTypeActive) && (pe->PteFrameHigh == 0xf)) {
+            pe->tpExtended = MmPfnExType_DriverLocked;
+        } else if(pe->PrototypePte) {
+            if(pe->Modified) {
+                pe->tpExtended = MmPfnExType_Shareable;
+            } else {
+                pe->tpExtended = MmPfnExType_File;
+            }
+        }
+    } else if((tp == MmPfnTypeZero) || (tp == MmPfnTypeFree) || (tp == MmPfnTypeBad)) {
+        pe->tpExtended = MmPfnExType_Unused;
+    }
+}
+
+/*
+* Decode a range of sequential PFNs by streaming the PFN database in large
+* sequential reads instead of one read per _MMPFN entry.
+* -- mctx
+* -- iStart = start index in map (inclusive).
+* -- iEnd = end index in map (exclusive).
+*/
+VOID MmPfn_Map_GetPfn_DecodeRangeSequential(_In_ PMMPFN_MAP_CONTEXT mctx, _In_ DWORD iStart, _In_ DWORD iEnd)
+{
+    POB_MMPFN_CONTEXT ctx = mctx->ctx;
+    PMMPFN_MAP_ENTRY pe;
+    PBYTE pbBuffer;
+    PMEM_SCATTER pMEMs;
+    PPMEM_SCATTER ppMEMs;
+    QWORD vaBase, o;
+    DWORD i, iChunk, iChunkEnd, iPage, cPage, cPfnChunk;
+    cPfnChunk = (MMPFN_READ_CHUNK_PAGES << 12) / ctx->_MMPFN.cb;
+    if(!(pbBuffer = LocalAlloc(0, ((MMPFN_READ_CHUNK_PAGES + 1) << 12) + (MMPFN_READ_CHUNK_PAGES + 1) * (sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER))))) { return; }
+    pMEMs = (PMEM_SCATTER)(pbBuffer + ((MMPFN_READ_CHUNK_PAGES + 1) << 12));
+    ppMEMs = (PPMEM_SCATTER)(pMEMs + MMPFN_READ_CHUNK_PAGES + 1);
+    for(iChunk = iStart; iChunk < iEnd; iChunk = iChunkEnd) {
+        iChunkEnd = (DWORD)min(iEnd, (QWORD)iChunk + cPfnChunk);
+        vaBase = MMPFN_PFN_TO_VA(ctx, mctx->pPfnMap->pMap[iChunk].dwPfn) & ~0xfff;
+        cPage = (DWORD)((MMPFN_PFN_TO_VA(ctx, mctx->pPfnMap->pMap[iChunkEnd - 1].dwPfn) + ctx->_MMPFN.cb - vaBase + 0xfff) >> 12);
+        ZeroMemory(pMEMs, cPage * sizeof(MEM_SCATTER));
+        for(iPage = 0; iPage < cPage; iPage++) {
+            ppMEMs[iPage] = pMEMs + iPage;
+            pMEMs[iPage].version = MEM_SCATTER_VERSION;
+            pMEMs[iPage].qwA = vaBase + ((QWORD)iPage << 12);
+            pMEMs[iPage].cb = 0x1000;
+            pMEMs[iPage].pb = pbBuffer + ((QWORD)iPage << 12);
+        }
+        VmmReadScatterVirtual(mctx->pSystemProcess, ppMEMs, cPage, 0);
+        for(i = iChunk; i < iChunkEnd; i++) {
+            pe = mctx->pPfnMap->pMap + i;
+            if(pe->dwPfn > ctx->iPfnMax) { continue; }
+            o = MMPFN_PFN_TO_VA(ctx, pe->dwPfn) - vaBase;
+            if(pMEMs[o >> 12].f && pMEMs[(o + ctx->_MMPFN.cb - 1) >> 12].f) {
+                MmPfn_Map_GetPfn_DecodeEntry(mctx, pe, pbBuffer + o);
+            }
+        }
+    }
+    LocalFree(pbBuffer);
+}
+
+/*
+* Decode a range of scattered PFNs - prefetch the pages of the range and read
+* each _MMPFN entry individually from the cache.
+* -- mctx
+* -- iStart = start index in map (inclusive).
+* -- iEnd = end index in map (exclusive).
+*/
+VOID MmPfn_Map_GetPfn_DecodeRangeScatter(_In_ PMMPFN_MAP_CONTEXT mctx, _In_ DWORD iStart, _In_ DWORD iEnd)
+{
+    POB_MMPFN_CONTEXT ctx = mctx->ctx;
     BYTE pbPfn[0x30] = { 0 };
-    PVMM_PROCESS pObSystemProcess = NULL;
+    PMMPFN_MAP_ENTRY pe;
+    POB_SET psObPrefetch;
+    DWORD i, cbRead;
+    if(!(psObPrefetch = ObSet_New())) { return; }
+    for(i = iStart; i < iEnd; i++) {
+        pe = mctx->pPfnMap->pMap + i;
+        if(pe->dwPfn > ctx->iPfnMax) { continue; }
+        ObSet_Push_PageAlign(psObPrefetch, MMPFN_PFN_TO_VA(ctx, pe->dwPfn), ctx->_MMPFN.cb);
+    }
+    VmmCachePrefetchPages(mctx->pSystemProcess, psObPrefetch, 0);
+    for(i = iStart; i < iEnd; i++) {
+        pe = mctx->pPfnMap->pMap + i;
+        if(pe->dwPfn > ctx->iPfnMax) { continue; }
+        VmmReadEx(mctx->pSystemProcess, MMPFN_PFN_TO_VA(ctx, pe->dwPfn), pbPfn, ctx->_MMPFN.cb, &cbRead, 0);
+        if(!cbRead) { continue; }
+        MmPfn_Map_GetPfn_DecodeEntry(mctx, pe, pbPfn);
+    }
+    Ob_DECREF(psObPrefetch);
+}
+
+VOID MmPfn_Map_GetPfn_DecodeRange(_In_ PMMPFN_MAP_CONTEXT mctx, _In_ DWORD iStart, _In_ DWORD iEnd)
+{
+    if(mctx->fSequential) {
+        MmPfn_Map_GetPfn_DecodeRangeSequential(mctx, iStart, iEnd);
+    } else {
+        MmPfn_Map_GetPfn_DecodeRangeScatter(mctx, iStart, iEnd);
+    }
+}
+
+VOID MmPfn_Map_GetPfn_DecodeWork(_In_ PMMPFN_MAP_CONTEXT mctx, _In_ DWORD iWork)
+{
+    QWORD cPfn = mctx->pPfnMap->cMap;
+    MmPfn_Map_GetPfn_DecodeRange(mctx, (DWORD)(cPfn * iWork / mctx->cWork), (DWORD)(cPfn * (iWork + 1) / mctx->cWork));
+}
+
+/*
+* Retrieve information about PFNs - either scattered PFNs in psPfn or if psPfn
+* is NULL the sequential PFNs [dwPfnStart, dwPfnStart + cPfn). Large requests
+* are split and decoded in parallel on the worker threads (VmmWorkParallelForeach).
+* CALLER DECREF: pObPfnMap
+* -- psPfn
+* -- dwPfnStart
+* -- cPfn
+* -- ppObPfnMap
+* -- fExtended
+* -- return
+*/
+_Success_(return)
+BOOL MmPfn_Map_GetPfn_DoWork(_In_opt_ POB_SET psPfn, _In_ DWORD dwPfnStart, _In_ DWORD cPfn, _Out_ PMMPFNOB_MAP *ppObPfnMap, _In_ BOOL fExtended)
+{
+    QWORD tmStart = GetTickCount64(), tmElapsed;
+    MMPFN_MAP_CONTEXT mctx = { 0 };
     PMMPFNOB_MAP pObPfnMap = NULL;
+    POB_MAP pmObPte = NULL, pmObPtIndex = NULL;
+    POB_SET psObUnresolved = NULL;
     PMMPFN_MAP_ENTRY pe;
-    QWORD qw;
-    DWORD cPfn, i, tp, cbRead;
-    POB_SET psObEnrichAddress = NULL, psObPrefetch = NULL;
-    if(!ctx) { goto fail; }
+    DWORD i, c;
+    mctx.ctx = (POB_MMPFN_CONTEXT)ctxVmm->pObPfnContext;
+    mctx.fExtended = fExtended;
+    mctx.fSequential = !psPfn;
+    if(!mctx.ctx) { goto fail; }
     // initialization
-    if(!(cPfn = ObSet_Size(psPfn))) { goto fail; }
-    if(!(pObSystemProcess = VmmProcessGet(4))) { goto fail; }
-    if(!(psObEnrichAddress = ObSet_New())) { goto fail; }
-    if(!(psObPrefetch = ObSet_New())) { goto fail; }
-    if(!(pObPfnMap = Ob_Alloc(OB_TAG_MAP_PFN, LMEM_ZEROINIT, sizeof(MMPFNOB_MAP) + cPfn * sizeof(MMPFN_MAP_ENTRY), NULL, NULL))) { goto fail; }
+    if(!cPfn) { goto fail; }
+    if(!(mctx.pSystemProcess = VmmProcessGet(4))) { goto fail; }
+    if(!(mctx.psEnrichAddress = ObSet_New())) { goto fail; }
+    if(!(mctx.psPrefetch = ObSet_New())) { goto fail; }
+    if(!(pmObPte = ObMap_New(0))) { goto fail; }
+    if(!(pObPfnMap = Ob_Alloc(OB_TAG_MAP_PFN, LMEM_ZEROINIT, sizeof(MMPFNOB_MAP) + (QWORD)cPfn * sizeof(MMPFN_MAP_ENTRY), NULL, NULL))) { goto fail; }
     pObPfnMap->cMap = cPfn;
-    // translate pfn# to pfn va and prefetch
+    mctx.pPfnMap = pObPfnMap;
     for(i = 0; i < cPfn; i++) {
-        pe = pObPfnMap->pMap + i;
-        pe->dwPfn = (DWORD)ObSet_Get(psPfn, i);
-        ObSet_Push_PageAlign(psObPrefetch, MMPFN_PFN_TO_VA(ctx, pe->dwPfn), ctx->_MMPFN.cb);
+        pObPfnMap->pMap[i].dwPfn = psPfn ? (DWORD)ObSet_Get(psPfn, i) : dwPfnStart + i;
     }
-    VmmCachePrefetchPages(pObSystemProcess, psObPrefetch, 0);
-    ObSet_Clear(psObPrefetch);
-    // iterate and fetch pfns
-    for(i = 0; i < cPfn; i++) {
-        pe = pObPfnMap->pMap + i;
-        if(pe->dwPfn > ctx->iPfnMax) { continue; }
-        VmmReadEx(pObSystemProcess, MMPFN_PFN_TO_VA(ctx, pe->dwPfn), pbPfn, ctx->_MMPFN.cb, &cbRead, 0);
-        if(!cbRead) { continue; }
-        pe->_u3 = *(PDWORD)(pbPfn + ctx->_MMPFN.ou3);
-        qw = *(PQWORD)(pbPfn + ctx->_MMPFN.ou4);
-        if(f32) {
-            pe->PteFrame = qw & 0x00ffffff;
-            pe->PteFrameHigh = (qw >> 20) & 0xf;
-            pe->PrototypePte = (qw >> 27) & 0x1;
-            pe->PageColor = (qw >> 28) & 0xf;
-        } else {
-            pe->_u4 = qw;
-        }
-        pe->vaPte = VMM_PTR_OFFSET(f32, pbPfn, ctx->_MMPFN.oPteAddress);
-        pe->OriginalPte = VMM_PTR_OFFSET(f32, pbPfn, ctx->_MMPFN.oOriginalPte);
-        tp = pe->PageLocation;
-        if(fExtended && (tp == MmPfnTypeActive) || (tp == MmPfnTypeStandby) || (tp == MmPfnTypeModified) || (tp == MmPfnTypeModifiedNoWrite)) {
-            if(!pe->PrototypePte && !pe->PteFrameHigh && (pe->PteFrame <= ctx->iPfnMax)) {
-                pe->AddressInfo.va = ((pe->vaPte << 9) & 0x1ff000) | 0xfff;
-                pe->AddressInfo.dwPfnPte[1] = pe->PteFrame;
-                ObSet_Push(psObEnrichAddress, (QWORD)pe);
-                ObSet_Push_PageAlign(psObPrefetch, MMPFN_PFN_TO_VA(ctx, pe->AddressInfo.dwPfnPte[1]), ctx->_MMPFN.cb);
-            } else if((tp == MmPfnTypeActive) && (pe->PteFrameHigh == 0xf)) {
-                pe->tpExtended = MmPfnExType_DriverLocked;
-            } else if(pe->PrototypePte) {
-                if(pe->Modified) {
-                    pe->tpExtended = MmPfnExType_Shareable;
-                } else {
-                    pe->tpExtended = MmPfnExType_File;
-                }
+    // decode pfn entries - in parallel if many
+    mctx.cWork = max(1, min(MMPFN_PARALLEL_MAX, cPfn / MMPFN_PARALLEL_THRESHOLD));
+    VmmWorkParallelForeach(mctx.cWork, &mctx, (VOID(*)(PVOID, DWORD))MmPfn_Map_GetPfn_DecodeWork);
+    // encrich result with virtual addresses and additional info - large x64
+    // requests are resolved via the page table index (if possible) first.
+    if(ObSet_Size(mctx.psEnrichAddress) && (ctxVmm->tpMemoryModel == VMMDLL_MEMORYMODEL_X64) && (cPfn >= MMPFN_PARALLEL_THRESHOLD)) {
+        if((pmObPtIndex = MmPfn_PageTableIndex_Get(mctx.ctx, mctx.pSystemProcess)) && (psObUnresolved = ObSet_New())) {
+            MmPfn_Map_GetPfn_GetVaX64Index(mctx.ctx, mctx.pSystemProcess, mctx.psEnrichAddress, pmObPtIndex, psObUnresolved);
+            Ob_DECREF(mctx.psEnrichAddress);
+            mctx.psEnrichAddress = psObUnresolved;
+            psObUnresolved = NULL;
+            ObSet_Clear(mctx.psPrefetch);
+            for(i = 0, c = ObSet_Size(mctx.psEnrichAddress); i < c; i++) {
+                pe = (PMMPFN_MAP_ENTRY)ObSet_Get(mctx.psEnrichAddress, i);
+                ObSet_Push_PageAlign(mctx.psPrefetch, MMPFN_PFN_TO_VA(mctx.ctx, pe->AddressInfo.dwPfnPte[1]), mctx.ctx->_MMPFN.cb);
             }
-        } else if((tp == MmPfnTypeZero) || (tp == MmPfnTypeFree) || (tp == MmPfnTypeBad)) {
-            pe->tpExtended = MmPfnExType_Unused;
         }
     }
-    // encrich result with virtual addresses and additional info
-    if(ObSet_Size(psObEnrichAddress)) {
+    if(ObSet_Size(mctx.psEnrichAddress)) {
         if(ctxVmm->tpMemoryModel == VMMDLL_MEMORYMODEL_X64) {
-            MmPfn_Map_GetPfn_GetVaX64(ctx, pObSystemProcess, psObEnrichAddress, psObPrefetch, 1);
+            MmPfn_Map_GetPfn_GetVaX64(mctx.ctx, mctx.pSystemProcess, mctx.psEnrichAddress, mctx.psPrefetch, pmObPte, 1);
         } else if(ctxVmm->tpMemoryModel == VMMDLL_MEMORYMODEL_X86PAE) {
-            MmPfn_Map_GetPfn_GetVaX86PAE(ctx, pObSystemProcess, psObEnrichAddress, psObPrefetch, 1);
+            MmPfn_Map_GetPfn_GetVaX86PAE(mctx.ctx, mctx.pSystemProcess, mctx.psEnrichAddress, mctx.psPrefetch, pmObPte, 1);
         } else if(ctxVmm->tpMemoryModel == VMMDLL_MEMORYMODEL_X86) {
-            MmPfn_Map_GetPfn_GetVaX86(ctx, pObSystemProcess, psObEnrichAddress, psObPrefetch);
+            MmPfn_Map_GetPfn_GetVaX86(mctx.ctx, mctx.pSystemProcess, mctx.psEnrichAddress, mctx.psPrefetch, pmObPte);
         }
     }
+    tmElapsed = GetTickCount64() - tmStart;
+    vmmprintfvv_fn("%i PFNs in %llims [%llims / 1M PFNs]\n", cPfn, tmElapsed, tmElapsed * 1000000 / cPfn);
     // fall through to cleanup
     Ob_INCREF(pObPfnMap);
 fail:
-    Ob_DECREF(pObSystemProcess);
-    Ob_DECREF(psObPrefetch);
-    Ob_DECREF(psObEnrichAddress);
+    Ob_DECREF(mctx.pSystemProcess);
+    Ob_DECREF(mctx.psPrefetch);
+    Ob_DECREF(mctx.psEnrichAddress);
+    Ob_DECREF(pmObPte);
+    Ob_DECREF(pmObPtIndex);
+    Ob_DECREF(psObUnresolved);
     *ppObPfnMap = Ob_DECREF(pObPfnMap);
     return *ppObPfnMap ? TRUE : FALSE;
 }
 
+_Success_(return)
+BOOL MmPfn_Map_GetPfnScatter(_In_ POB_SET psPfn, _Out_ PMMPFNOB_MAP *ppObPfnMap, _In_ BOOL fExtended)
+{
+    return MmPfn_Map_GetPfn_DoWork(psPfn, 0, ObSet_Size(psPfn), ppObPfnMap, fExtended);
+}
+
 _Success_(return)
 BOOL MmPfn_Map_GetPfn(_In_ DWORD dwPfnStart, _In_ DWORD cPfn, _Out_ PMMPFNOB_MAP *ppObPfnMap, _In_ BOOL fExtended)
 {
-    BOOL fResult;
-    POB_SET psObPfn;
-    QWORD iPfn, iPfnEnd;
-    if(!(psObPfn = ObSet_New())) { return FALSE; }
-    for(iPfn = dwPfnStart, iPfnEnd = (QWORD)dwPfnStart + cPfn; iPfn < iPfnEnd; iPfn++) {
-        ObSet_Push(psObPfn, 0x80000000'00000000 | iPfn);
-    }
-    fResult = MmPfn_Map_GetPfnScatter(psObPfn, ppObPfnMap, fExtended);
-    Ob_DECREF(psObPfn);
-    return fResult;
+    return MmPfn_Map_GetPfn_DoWork(NULL, dwPfnStart, cPfn, ppObPfnMap, fExtended);
 }
@@ -1051,11 +1051,16 @@ fail:
 }
 
 _Success_(return)
-BOOL MmVad_PrototypePteArray_FetchNew_PoolHdrVerify(_In_ PBYTE pb, _In_ DWORD cbDataOffsetPoolHdr)
+BOOL MmVad_PrototypePteArray_FetchNew_PoolHdrVerify(_In_ QWORD va, _In_ PBYTE pb, _In_ DWORD cbDataOffsetPoolHdr)
 {
-    DWORD o;
+    DWORD o, dwPoolTag;
+    if(!cbDataOffsetPoolHdr) {
+        // page-aligned allocation without pool header - verify by the big pool
+        // index if it is already built (it must not be built from within reads).
+        return !VmmMap_GetPoolTagByAddress(va, FALSE, &dwPoolTag) || VMM_POOLTAG(dwPoolTag, 'MmSt');
+    }
     if(cbDataOffsetPoolHdr < 0x10) {
-        return !cbDataOffsetPoolHdr || ('tSmM' == *(PDWORD)pb);
+        return ('tSmM' == *(PDWORD)pb);
     }
     for(o = 0; o < cbDataOffsetPoolHdr; o += 4) {
         if('tSmM' == *(PDWORD)(pb + o)) { return TRUE; }    // check for MmSt pool header in various locations
@@ -1094,7 +1099,7 @@ VOID MmVad_PrototypePteArray_FetchNew(_In_ PVMM_PROCESS pSystemProcess, _In_ PVM
     // 3: fetch prototype page table entries
     if(!(pbData = LocalAlloc(0, cbData))) { return; }
     if(VmmRead2(pSystemProcess, pVad->vaPrototypePte - cbDataOffsetPoolHdr, pbData, cbData, fVmmRead)) {
-        if(MmVad_PrototypePteArray_FetchNew_PoolHdrVerify(pbData, cbDataOffsetPoolHdr)) {
+        if(MmVad_PrototypePteArray_FetchNew_PoolHdrVerify(pVad->vaPrototypePte, pbData, cbDataOffsetPoolHdr)) {
             if((e = Ob_Alloc('MmSt', 0, sizeof(OB) + cbData - cbDataOffsetPoolHdr, NULL, NULL))) {
                 memcpy(e->pb, pbData + cbDataOffsetPoolHdr, cbData - cbDataOffsetPoolHdr);
             }
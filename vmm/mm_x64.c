@@ -239,6 +239,72 @@ BOOL MmX64_Virt2Phys(_In_ QWORD paPT, _In_ BOOL fUserOnly, _In_ BYTE iPML, _In_
     return MmX64_Virt2Phys(pte, fUserOnly, iPML - 1, va, ppa);
 }
 
+/*
+* Translate a virtual address by an iterative page walk. Page tables used by
+* previous translations within the same batch are kept referenced in ppObPT
+* (indexed by iPML) and are re-used without a TLB cache lookup if possible.
+* Upon fail the PTE will be returned in ppa (if possible).
+* -- paDTB
+* -- fUserOnly
+* -- va
+* -- ppObPT = page tables referenced by previous translations (CALLER DECREF).
+* -- ppa
+* -- return
+*/
+_Success_(return)
+inline BOOL MmX64_Virt2PhysIterative(_In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ QWORD va, _Inout_updates_(5) PVMMOB_CACHE_MEM ppObPT[5], _Out_ PQWORD ppa)
+{
+    BYTE iPML;
+    QWORD pte, qwMask, paPT = paDTB & 0x0000fffffffff000;
+    *ppa = 0;
+    for(iPML = 4; iPML; iPML--) {
+        if(!ppObPT[iPML] || (ppObPT[iPML]->h.qwA != paPT)) {
+            Ob_DECREF_NULL(&ppObPT[iPML]);
+            if(!(ppObPT[iPML] = VmmTlbGetPageTable(paPT, FALSE))) { return FALSE; }
+        }
+        pte = ppObPT[iPML]->pqw[0x1ff & (va >> MMX64_PAGETABLEMAP_PML_REGION_SIZE[iPML])];
+        if(!MMX64_PTE_IS_VALID(pte, iPML)) {
+            if(iPML == 1) { *ppa = pte; }                   // NOT VALID
+            return FALSE;
+        }
+        if(fUserOnly && !(pte & 0x04)) { return FALSE; }    // SUPERVISOR PAGE & USER MODE REQ
+        if(pte & 0x000f000000000000) { return FALSE; }      // RESERVED
+        if((iPML == 1) || (pte & 0x80) /* PS */) {
+            if(iPML == 4) { return FALSE; }                 // NO SUPPORT IN PML4
+            qwMask = 0xffffffffffffffff << MMX64_PAGETABLEMAP_PML_REGION_SIZE[iPML];
+            *ppa = (pte & 0x0000fffffffff000 & qwMask) | (~qwMask & va);
+            return TRUE;
+        }
+        paPT = pte & 0x0000fffffffff000;
+    }
+    return FALSE;
+}
+
+/*
+* Translate multiple virtual addresses. Addresses are translated by the inlined
+* iterative page walk - page tables are re-used between consecutive addresses
+* of the batch without repeated TLB cache lookups.
+* -- paDTB
+* -- fUserOnly
+* -- cva
+* -- pqwA = virtual addresses on entry, physical addresses (or PTE on fail) on exit.
+* -- pfResult
+*/
+VOID MmX64_Virt2PhysBatch(_In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ DWORD cva, _Inout_updates_(cva) PQWORD pqwA, _Out_writes_(cva) PBOOL pfResult)
+{
+    DWORD i;
+    QWORD va;
+    PVMMOB_CACHE_MEM ppObPT[5] = { 0 };
+    for(i = 0; i < cva; i++) {
+        va = pqwA[i];
+        pqwA[i] = 0;
+        pfResult[i] = va && MmX64_Virt2PhysIterative(paDTB, fUserOnly, va, ppObPT, pqwA + i);
+    }
+    for(i = 1; i < 5; i++) {
+        Ob_DECREF(ppObPT[i]);
+    }
+}
+
 VOID MmX64_Virt2PhysVadEx(_In_ QWORD paPT, _Inout_ PVMMOB_MAP_VADEX pVadEx, _In_ BYTE iPML, _Inout_ PDWORD piVadEx)
 {
     QWORD pa, pte, iPte, iVadEx, qwMask;
@@ -376,6 +442,7 @@ VOID MmX64_Initialize()
     }
     ctxVmm->fnMemoryModel.pfnClose = MmX64_Close;
     ctxVmm->fnMemoryModel.pfnVirt2Phys = MmX64_Virt2Phys;
+    ctxVmm->fnMemoryModel.pfnVirt2PhysBatch = MmX64_Virt2PhysBatch;
     ctxVmm->fnMemoryModel.pfnVirt2PhysVadEx = MmX64_Virt2PhysVadEx;
     ctxVmm->fnMemoryModel.pfnVirt2PhysGetInformation = MmX64_Virt2PhysGetInformation;
     ctxVmm->fnMemoryModel.pfnPhys2VirtGetInformation = MmX64_Phys2VirtGetInformation;
@@ -20,7 +20,8 @@ BOOL MmX86_TlbPageTableVerify(_Inout_ PBYTE pb, _In_ QWORD pa, _In_ BOOL fSelfRe
 }
 
 /*
-* Iterate over the PD to retrieve uncached PT pages and then commit them to the cache.
+* Iterate over the PD to retrieve uncached PT pages and then commit them to the
+* cache in one prefetch. Already cached PT pages are not re-read.
 */
 VOID MmX86_TlbSpider(_In_ PVMM_PROCESS pProcess)
 {
@@ -36,6 +37,7 @@ VOID MmX86_TlbSpider(_In_ PVMM_PROCESS pProcess)
         if(!(pte & 0x01)) { continue; }                 // not valid
         if(pte & 0x80) { continue; }                    // not valid ptr to PT
         if(pProcess->fUserOnly && !(pte & 0x04)) { continue; }    // supervisor page when fUserOnly -> not valid
+        if(VmmCacheExists(VMM_CACHE_TAG_TLB, pte & 0xfffff000)) { continue; }  // already cached
         ObSet_Push(pObPageSet, pte & 0xfffff000);
     }
     VmmTlbPrefetch(pObPageSet);
@@ -177,6 +179,47 @@ BOOL MmX86_Virt2Phys(_In_ QWORD paPT, _In_ BOOL fUserOnly, _In_ BYTE iPML, _In_
     return TRUE;
 }
 
+/*
+* Translate multiple virtual addresses. The PTs required by the batch are
+* fetched with one prefetch before the addresses are translated one-by-one
+* from the TLB cache.
+* -- paDTB
+* -- fUserOnly
+* -- cva
+* -- pqwA = virtual addresses on entry, physical addresses (or PTE on fail) on exit.
+* -- pfResult
+*/
+VOID MmX86_Virt2PhysBatch(_In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ DWORD cva, _Inout_updates_(cva) PQWORD pqwA, _Out_writes_(cva) PBOOL pfResult)
+{
+    DWORD i, pte, pa, paLast = (DWORD)-1;
+    QWORD va;
+    POB_SET psObPrefetch = NULL;
+    PVMMOB_CACHE_MEM pObPD = NULL;
+    // 1: stage and prefetch uncached PTs
+    if((cva > 1) && (paDTB <= 0xffffffff) && (psObPrefetch = ObSet_New()) && (pObPD = VmmTlbGetPageTable(paDTB & 0xfffff000, FALSE))) {
+        for(i = 0; i < cva; i++) {
+            va = pqwA[i];
+            if(!va || (va > 0xffffffff)) { continue; }
+            pte = pObPD->pdw[va >> 22];
+            if(!(pte & 0x01) || (pte & 0x80)) { continue; }
+            if(fUserOnly && !(pte & 0x04)) { continue; }
+            pa = pte & 0xfffff000;
+            if(pa == paLast) { continue; }
+            paLast = pa;
+            if(!VmmCacheExists(VMM_CACHE_TAG_TLB, pa)) { ObSet_Push(psObPrefetch, pa); }
+        }
+        VmmTlbPrefetch(psObPrefetch);
+    }
+    // 2: translate from the TLB cache
+    for(i = 0; i < cva; i++) {
+        va = pqwA[i];
+        pqwA[i] = 0;
+        pfResult[i] = va && MmX86_Virt2Phys(paDTB, fUserOnly, -1, va, pqwA + i);
+    }
+    Ob_DECREF(pObPD);
+    Ob_DECREF(psObPrefetch);
+}
+
 VOID MmX86_Virt2PhysVadEx(_In_ QWORD paPT, _Inout_ PVMMOB_MAP_VADEX pVadEx, _In_ BYTE iPML, _Inout_ PDWORD piVadEx)
 {
     DWORD pte, iPte, iVadEx;
@@ -316,6 +359,7 @@ VOID MmX86_Initialize()
     }
     ctxVmm->fnMemoryModel.pfnClose = MmX86_Close;
     ctxVmm->fnMemoryModel.pfnVirt2Phys = MmX86_Virt2Phys;
+    ctxVmm->fnMemoryModel.pfnVirt2PhysBatch = MmX86_Virt2PhysBatch;
     ctxVmm->fnMemoryModel.pfnVirt2PhysVadEx = MmX86_Virt2PhysVadEx;
     ctxVmm->fnMemoryModel.pfnVirt2PhysGetInformation = MmX86_Virt2PhysGetInformation;
     ctxVmm->fnMemoryModel.pfnPhys2VirtGetInformation = MmX86_Phys2VirtGetInformation;
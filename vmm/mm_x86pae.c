@@ -19,67 +19,60 @@ BOOL MmX86PAE_TlbPageTableVerify(_Inout_ PBYTE pb, _In_ QWORD pa, _In_ BOOL fSel
     return TRUE;
 }
 
-VOID MmX86PAE_TlbSpider_PD_PT(_In_ QWORD pa, _In_ BYTE iPML, _In_ BOOL fUserOnly, _In_ POB_SET pPageSet)
-{
-    QWORD i, pte;
-    PVMMOB_CACHE_MEM pObPT = NULL;
-    // 1: retrieve from cache, add to staging if not found
-    pObPT = VmmCacheGet(VMM_CACHE_TAG_TLB, pa);
-    if(!pObPT) {
-        ObSet_Push(pPageSet, pa);
-        return;
-    }
-    if(iPML == 1) {
-        Ob_DECREF(pObPT);
-        return;
-    }
-    // 2: walk trough all entries for PD
-    for(i = 0; i < 512; i++) {
-        pte = pObPT->pqw[i];
-        if(!(pte & 0x01)) { continue; }                 // not valid
-        if(pte & 0x80) { continue; }                    // not valid ptr to PT
-        if(fUserOnly && !(pte & 0x04)) { continue; }    // supervisor page when fUserOnly -> not valid
-        MmX86PAE_TlbSpider_PD_PT(pte & 0x0000fffffffff000, 1, fUserOnly, pPageSet);
-    }
-    Ob_DECREF(pObPT);
-}
-
-VOID MmX86PAE_TlbSpider_PDPT(_In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ POB_SET pPageSet)
+/*
+* Stage the page tables referenced by a PDPT (iPML = 3) or PD (iPML = 2). All
+* referenced page tables are added to the optional psPageTable and uncached
+* page tables are also added to psPrefetch.
+*/
+VOID MmX86PAE_TlbSpider_Stage(_In_reads_(cPTEs) PQWORD pPTEs, _In_ DWORD cPTEs, _In_ BYTE iPML, _In_ BOOL fUserOnly, _In_opt_ POB_SET psPageTable, _In_ POB_SET psPrefetch)
 {
-    BOOL fSpiderComplete = TRUE;
-    PVMMOB_CACHE_MEM pObPDPT;
-    PBYTE pbPDPT;
-    QWORD i, pte;
-    // 1: retrieve PDPT
-    pObPDPT = VmmTlbGetPageTable(paDTB & 0xfffff000, FALSE);
-    if(!pObPDPT) { return; }
-    pbPDPT = pObPDPT->pb + (paDTB & 0xfe0);
-    // 2: walk through all four (4) PDPTEs
-    for(i = 0; i < 0x20; i += 8) {
-        pte = *(PQWORD)(pbPDPT + i);
-        if(!(pte & 0x01)) { continue; }             // not valid
-        if(pte & 0xffff0000000001e6) { continue; }  // RESERVED BITS IN PDPTE
-        MmX86PAE_TlbSpider_PD_PT(pte & 0x0000fffffffff000, 2, fUserOnly, pPageSet);
+    DWORD i;
+    QWORD pte, pa;
+    for(i = 0; i < cPTEs; i++) {
+        pte = pPTEs[i];
+        if(!(pte & 0x01)) { continue; }                     // not valid
+        if(iPML == 3) {
+            if(pte & 0xffff0000000001e6) { continue; }      // RESERVED BITS IN PDPTE
+        } else {
+            if(pte & 0x80) { continue; }                    // not valid ptr to PT
+            if(fUserOnly && !(pte & 0x04)) { continue; }    // supervisor page when fUserOnly -> not valid
+        }
+        pa = pte & 0x0000fffffffff000;
+        if(pa > ctxMain->dev.paMax) { continue; }
+        if(psPageTable) { ObSet_Push(psPageTable, pa); }
+        if(!VmmCacheExists(VMM_CACHE_TAG_TLB, pa)) { ObSet_Push(psPrefetch, pa); }
     }
-    Ob_DECREF(pObPDPT);
 }
 
 /*
-* Iterate over PTPT, PD (3 times in total) to first stage uncached pages
-* and then commit them to the cache.
+* Spider the PDPT, PDs and PTs level-by-level. Uncached page tables of each
+* level are committed to the cache in one prefetch before the next level is
+* staged - i.e. at most two (2) prefetch rounds per process.
 */
 VOID MmX86PAE_TlbSpider(_In_ PVMM_PROCESS pProcess)
 {
-    DWORD i;
-    POB_SET pObPageSet = NULL;
+    QWORD pa;
+    POB_SET psObPD = NULL, psObPrefetch = NULL;
+    PVMMOB_CACHE_MEM pObPDPT = NULL, pObPD;
     if(pProcess->fTlbSpiderDone) { return; }
-    if(!(pObPageSet = ObSet_New())) { return; }
-    for(i = 0; i < 3; i++) {
-        MmX86PAE_TlbSpider_PDPT(pProcess->paDTB, pProcess->fUserOnly, pObPageSet);
-        VmmTlbPrefetch(pObPageSet);
+    if(!(psObPD = ObSet_New()) || !(psObPrefetch = ObSet_New())) { goto fail; }
+    // 1: PDPT -> PDs
+    if(!(pObPDPT = VmmTlbGetPageTable(pProcess->paDTB & 0xfffff000, FALSE))) { goto fail; }
+    MmX86PAE_TlbSpider_Stage((PQWORD)(pObPDPT->pb + (pProcess->paDTB & 0xfe0)), 4, 3, pProcess->fUserOnly, psObPD, psObPrefetch);
+    VmmTlbPrefetch(psObPrefetch);
+    // 2: PDs -> PTs
+    while(ObSet_Size(psObPD)) {
+        pa = ObSet_Pop(psObPD);
+        if(!(pObPD = VmmTlbGetPageTable(pa, TRUE))) { continue; }
+        MmX86PAE_TlbSpider_Stage(pObPD->pqw, 512, 2, pProcess->fUserOnly, NULL, psObPrefetch);
+        Ob_DECREF(pObPD);
     }
+    VmmTlbPrefetch(psObPrefetch);
     pProcess->fTlbSpiderDone = TRUE;
-    Ob_DECREF(pObPageSet);
+fail:
+    Ob_DECREF(pObPDPT);
+    Ob_DECREF(psObPrefetch);
+    Ob_DECREF(psObPD);
 }
 
 const DWORD MMX86PAE_PAGETABLEMAP_PML_REGION_SIZE[4] = { 0, 12, 21, 30 };
@@ -239,6 +232,62 @@ BOOL MmX86PAE_Virt2Phys(_In_ QWORD paPT, _In_ BOOL fUserOnly, _In_ BYTE iPML, _I
     return MmX86PAE_Virt2Phys(pte, fUserOnly, 1, va, ppa);
 }
 
+/*
+* Translate multiple virtual addresses. The PDs and then the PTs required by
+* the batch are fetched with one prefetch per level before the addresses are
+* translated one-by-one from the TLB cache.
+* -- paDTB
+* -- fUserOnly
+* -- cva
+* -- pqwA = virtual addresses on entry, physical addresses (or PTE on fail) on exit.
+* -- pfResult
+*/
+VOID MmX86PAE_Virt2PhysBatch(_In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ DWORD cva, _Inout_updates_(cva) PQWORD pqwA, _Out_writes_(cva) PBOOL pfResult)
+{
+    DWORD i, iPML;
+    QWORD va, pte, pa, paLast;
+    PQWORD pqwPDPT;
+    POB_SET psObPrefetch = NULL;
+    PVMMOB_CACHE_MEM pObPDPT = NULL, pObPD = NULL;
+    // 1: stage and prefetch uncached PDs (iPML = 2) and then PTs (iPML = 1)
+    if((cva > 1) && (psObPrefetch = ObSet_New()) && (pObPDPT = VmmTlbGetPageTable(paDTB & 0xfffff000, FALSE))) {
+        pqwPDPT = (PQWORD)(pObPDPT->pb + (paDTB & 0xfe0));
+        for(iPML = 2; iPML >= 1; iPML--) {
+            paLast = (QWORD)-1;
+            for(i = 0; i < cva; i++) {
+                va = pqwA[i];
+                if(!va || (va > 0xffffffff)) { continue; }
+                pte = pqwPDPT[va >> 30];
+                if(!(pte & 0x01) || (pte & 0xffff0000000001e6)) { continue; }
+                pa = pte & 0x0000fffffffff000;
+                if(iPML == 1) {
+                    if(!pObPD || (pObPD->h.qwA != pa)) {
+                        Ob_DECREF_NULL(&pObPD);
+                        if(!(pObPD = VmmTlbGetPageTable(pa, TRUE))) { continue; }
+                    }
+                    pte = pObPD->pqw[0x1ff & (va >> 21)];
+                    if(!(pte & 0x01) || (pte & 0x80)) { continue; }
+                    if(fUserOnly && !(pte & 0x04)) { continue; }
+                    pa = pte & 0x0000fffffffff000;
+                }
+                if((pa == paLast) || (pa > ctxMain->dev.paMax)) { continue; }
+                paLast = pa;
+                if(!VmmCacheExists(VMM_CACHE_TAG_TLB, pa)) { ObSet_Push(psObPrefetch, pa); }
+            }
+            VmmTlbPrefetch(psObPrefetch);
+        }
+    }
+    // 2: translate from the TLB cache
+    for(i = 0; i < cva; i++) {
+        va = pqwA[i];
+        pqwA[i] = 0;
+        pfResult[i] = va && MmX86PAE_Virt2Phys(paDTB, fUserOnly, -1, va, pqwA + i);
+    }
+    Ob_DECREF(pObPD);
+    Ob_DECREF(pObPDPT);
+    Ob_DECREF(psObPrefetch);
+}
+
 VOID MmX86PAE_Virt2PhysVadEx(_In_ QWORD paPT, _Inout_ PVMMOB_MAP_VADEX pVadEx, _In_ BYTE iPML, _Inout_ PDWORD piVadEx)
 {
     PBYTE pbPTEs;
@@ -403,6 +452,7 @@ VOID MmX86PAE_Initialize()
     }
     ctxVmm->fnMemoryModel.pfnClose = MmX86PAE_Close;
     ctxVmm->fnMemoryModel.pfnVirt2Phys = MmX86PAE_Virt2Phys;
+    ctxVmm->fnMemoryModel.pfnVirt2PhysBatch = MmX86PAE_Virt2PhysBatch;
     ctxVmm->fnMemoryModel.pfnVirt2PhysVadEx = MmX86PAE_Virt2PhysVadEx;
     ctxVmm->fnMemoryModel.pfnVirt2PhysGetInformation = MmX86PAE_Virt2PhysGetInformation;
     ctxVmm->fnMemoryModel.pfnPhys2VirtGetInformation = MmX86PAE_Phys2VirtGetInformation;
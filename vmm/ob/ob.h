@@ -22,10 +22,12 @@ typedef unsigned __int64                QWORD, *PQWORD;
 #define OB_TAG_MAP_THREAD               'Mthr'
 #define OB_TAG_MAP_HANDLE               'Mhnd'
 #define OB_TAG_MAP_PHYSMEM              'Mmem'
+#define OB_TAG_MAP_POOL                 'Mpol'
 #define OB_TAG_MAP_USER                 'Musr'
 #define OB_TAG_MAP_SERVICE              'Msvc'
 #define OB_TAG_MAP_NET                  'Mnet'
 #define OB_TAG_MAP_PFN                  'Mpfn'
+#define OB_TAG_MAP_TEXT                 'Mtxt'
 #define OB_TAG_MOD_MINIDUMP_CTX         'mMDx'
 #define OB_TAG_OBJ_ERROR                'Oerr'
 #define OB_TAG_OBJ_FILE                 'Ofil'
@@ -391,6 +391,63 @@ fail:
     return fResult;
 }
 
+_Success_(return)
+BOOL PDB_GetSymbolFromOffsetBatch(_In_opt_ PDB_HANDLE hPDB, _In_ DWORD cOffsets, _In_reads_(cOffsets) PDWORD pdwOffsets, _Out_writes_(cOffsets) LPSTR *pszSymbolNames, _Out_ LPSTR *pszMultiText)
+{
+    PVMMWIN_PDB_CONTEXT ctx = (PVMMWIN_PDB_CONTEXT)ctxVmm->pPdbContext;
+    SYMBOL_INFO_PACKAGE SymbolInfo = { 0 };
+    DWORD i, iOffset, dwOffset, dwOffsetPrev = 0, cch, o = 0;
+    QWORD qwDisplacement, *pqwSort = NULL;
+    LPSTR sz = NULL, szPrev = NULL;
+    PPDB_ENTRY pObPdbEntry = NULL;
+    BOOL fResult = FALSE;
+    *pszMultiText = NULL;
+    ZeroMemory(pszSymbolNames, cOffsets * sizeof(LPSTR));
+    if(!ctx || ctx->fDisabled || !hPDB || !cOffsets) { return FALSE; }
+    if(hPDB == PDB_HANDLE_KERNEL) { hPDB = PDB_GetHandleFromModuleName("ntoskrnl"); }
+    if(!(pObPdbEntry = ObMap_GetByKey(ctx->pmPdbByHash, hPDB))) { return FALSE; }
+    if(!(pqwSort = LocalAlloc(0, cOffsets * sizeof(QWORD)))) { goto fail_nolock; }
+    if(!(sz = LocalAlloc(0, (QWORD)cOffsets * MAX_PATH))) { goto fail_nolock; }
+    // sort offsets (offset in high dword, index in low dword)
+    for(i = 0; i < cOffsets; i++) {
+        pqwSort[i] = ((QWORD)pdwOffsets[i] << 32) | i;
+    }
+    qsort(pqwSort, cOffsets, sizeof(QWORD), Util_qsort_QWORD);
+    // resolve unique offsets under a single lock acquisition
+    EnterCriticalSection(&ctx->Lock);
+    if(!PDB_LoadEnsureEx(pObPdbEntry)) { goto fail; }
+    SymbolInfo.si.SizeOfStruct = sizeof(SYMBOL_INFO);
+    SymbolInfo.si.MaxNameLen = MAX_SYM_NAME;
+    for(i = 0; i < cOffsets; i++) {
+        dwOffset = (DWORD)(pqwSort[i] >> 32);
+        iOffset = (DWORD)pqwSort[i];
+        if(!dwOffset) { continue; }
+        if(dwOffset != dwOffsetPrev) {
+            dwOffsetPrev = dwOffset;
+            szPrev = NULL;
+            if(ctx->pfn.SymFromAddr(ctx->hSym, pObPdbEntry->qwLoadAddress + dwOffset, &qwDisplacement, &SymbolInfo.si) && !qwDisplacement) {
+                cch = min(MAX_PATH - 1, SymbolInfo.si.NameLen);
+                memcpy(sz + o, SymbolInfo.si.Name, cch);
+                sz[o + cch] = 0;
+                szPrev = sz + o;
+                o += cch + 1;
+            }
+        }
+        pszSymbolNames[iOffset] = szPrev;
+    }
+    *pszMultiText = sz;
+    sz = NULL;
+    fResult = TRUE;
+fail:
+    LeaveCriticalSection(&ctx->Lock);
+fail_nolock:
+    if(!fResult) { ZeroMemory(pszSymbolNames, cOffsets * sizeof(LPSTR)); }
+    LocalFree(sz);
+    LocalFree(pqwSort);
+    Ob_DECREF(pObPdbEntry);
+    return fResult;
+}
+
 /*
 * Read memory at the PDB acquired symbol offset. If szSymbolName contains
 * wildcard '?*' characters and matches multiple symbols the offset of the
@@ -111,6 +111,22 @@ BOOL PDB_GetSymbolAddress(_In_opt_ PDB_HANDLE hPDB, _In_ LPSTR szSymbolName, _Ou
 _Success_(return)
 BOOL PDB_GetSymbolFromOffset(_In_opt_ PDB_HANDLE hPDB, _In_ DWORD dwSymbolOffset, _Out_writes_opt_(MAX_PATH) LPSTR szSymbolName, _Out_opt_ PDWORD pdwSymbolDisplacement);
 
+/*
+* Query the PDB for the symbol names located exactly at multiple offsets from
+* the module base address in one batch. The offsets are resolved in sorted
+* order and duplicate offsets are only resolved once. Offsets not matching the
+* start of a symbol (or zero offsets) will receive a NULL name.
+* CALLER LocalFree: *pszMultiText
+* -- hPDB
+* -- cOffsets
+* -- pdwOffsets = the offsets from the module base to query.
+* -- pszSymbolNames = array to receive symbol names (pointing into *pszMultiText).
+* -- pszMultiText = buffer holding the symbol names upon success.
+* -- return
+*/
+_Success_(return)
+BOOL PDB_GetSymbolFromOffsetBatch(_In_opt_ PDB_HANDLE hPDB, _In_ DWORD cOffsets, _In_reads_(cOffsets) PDWORD pdwOffsets, _Out_writes_(cOffsets) LPSTR *pszSymbolNames, _Out_ LPSTR *pszMultiText);
+
 /*
 * Read memory at the PDB acquired symbol offset. If szSymbolName contains
 * wildcard '?*' characters and matches multiple symbols the offset of the
@@ -281,17 +281,25 @@ BOOL PluginManager_Notify(_In_ DWORD fEvent, _In_opt_ PVOID pvEvent, _In_opt_ DW
 
 /*
 * Initialize plugins with forensic mode capabilities.
+* Plugin initializers are run sequentially - the forensic sqlite connection
+* pool is in single connection mode during initialization and database access
+* would be serialized anyway. Plugins parallelize their memory analysis
+* internally before reserving the database connection.
 */
 VOID PluginManager_FcInitialize()
 {
     QWORD tmStart = Statistics_CallStart();
+    QWORD tcStart = GetTickCount64(), tcModuleStart;
     PPLUGIN_ENTRY pModule = (PPLUGIN_ENTRY)ctxVmm->PluginManager.FLinkForensic;
     while(pModule) {
         if(pModule->fc.pfnInitialize) {
+            tcModuleStart = GetTickCount64();
             pModule->fc.ctxfc = pModule->fc.pfnInitialize();
+            vmmprintfvv_fn("%S: %llims\n", pModule->wszName, GetTickCount64() - tcModuleStart);
         }
         pModule = pModule->FLinkForensic;
     }
+    vmmprintfvv_fn("TOTAL: %llims\n", GetTickCount64() - tcStart);
     Statistics_CallEnd(STATISTICS_ID_PluginManager_FcInitialize, tmStart);
 }
 
@@ -269,8 +269,9 @@ VOID Statistics_CallToString(_In_opt_ PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcb)
             STATISTICS_ID_STR[i],
             0, 0, 0ULL);
     }
-    // leechcore statistics
-    result = LcCommand(ctxMain->hLC, LC_CMD_STATISTICS_GET, 0, NULL, &(PBYTE)pLcStatistics, NULL);
+    // leechcore statistics - compressed memory image reads (if opened instead
+    // of a leechcore device) are accounted for as VMM_PmemzReadScatter above.
+    result = !ctxMain->hPmemz && LcCommand(ctxMain->hLC, LC_CMD_STATISTICS_GET, 0, NULL, &(PBYTE)pLcStatistics, NULL);
     if(result && (pLcStatistics->dwVersion == LC_STATISTICS_VERSION) && pLcStatistics->qwFreq) {
         for(i = 0; i <= LC_STATISTICS_ID_MAX; i++) {
             if(pLcStatistics->Call[i].c) {
@@ -125,7 +125,10 @@ VOID PageStatUpdate(_In_opt_ PPAGE_STATISTICS pPageStat, _In_ QWORD qwAddr, _In_
 #define STATISTICS_ID_VMMDLL_PdbTypeSize                        0x37
 #define STATISTICS_ID_VMMDLL_PdbTypeChildOffset                 0x38
 #define STATISTICS_ID_VMM_PagedCompressedMemory                 0x39
-#define STATISTICS_ID_MAX                                       0x39
+#define STATISTICS_ID_VMM_ProcessCloneKernel                    0x3a
+#define STATISTICS_ID_VMMDLL_MemExportCompressedImage           0x3b
+#define STATISTICS_ID_VMM_PmemzReadScatter                      0x3c
+#define STATISTICS_ID_MAX                                       0x3c
 #define STATISTICS_ID_NOLOG                                     0xffffffff
 
 static LPCSTR STATISTICS_ID_STR[] = {
@@ -187,6 +190,9 @@ static LPCSTR STATISTICS_ID_STR[] = {
     "VMMDLL_PdbTypeSize",
     "VMMDLL_PdbTypeChildOffset",
     "VMM_PagedCompressedMemory",
+    "VMM_ProcessCloneKernel",
+    "VMMDLL_MemExportCompressedImage",
+    "VMM_PmemzReadScatter",
 };
 
 VOID Statistics_CallSetEnabled(_In_ BOOL fEnabled);
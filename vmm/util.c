@@ -416,6 +416,110 @@ fail:
     return (DWORD)cszLineLength;
 }
 
+VOID Util_LnInit(_Out_ PUTIL_LN pLn, _Out_writes_(cszLineLength + 1) LPSTR szBuffer, _In_ DWORD cszLineLength)
+{
+    pLn->sz = szBuffer;
+    pLn->o = 0;
+    pLn->cszMax = cszLineLength - 1;
+}
+
+VOID Util_LnChar(_Inout_ PUTIL_LN pLn, _In_ CHAR ch)
+{
+    if(pLn->o < pLn->cszMax) {
+        pLn->sz[pLn->o++] = ch;
+    }
+}
+
+VOID Util_LnStr(_Inout_ PUTIL_LN pLn, _In_ LPSTR sz, _In_ DWORD cWidth)
+{
+    DWORD oEnd = pLn->o + cWidth;
+    while(*sz && (pLn->o < pLn->cszMax)) {
+        pLn->sz[pLn->o++] = *sz++;
+    }
+    while((pLn->o < oEnd) && (pLn->o < pLn->cszMax)) {
+        pLn->sz[pLn->o++] = ' ';
+    }
+}
+
+VOID Util_LnWstr(_Inout_ PUTIL_LN pLn, _In_ LPWSTR wsz)
+{
+    DWORD c, cch;
+    BYTE pb[4];
+    while((c = *wsz++)) {
+        if(c < 0x80) {
+            if(pLn->o >= pLn->cszMax) { return; }
+            pLn->sz[pLn->o++] = (CHAR)c;
+            continue;
+        }
+        if((c >= 0xd800) && (c <= 0xdbff) && (*wsz >= 0xdc00) && (*wsz <= 0xdfff)) {
+            c = 0x10000 + ((c - 0xd800) << 10) + (*wsz++ - 0xdc00);
+        } else if((c >= 0xd800) && (c <= 0xdfff)) {
+            c = 0xfffd;
+        }
+        if(c < 0x800) {
+            pb[0] = (BYTE)(0xc0 | (c >> 6));
+            pb[1] = (BYTE)(0x80 | (c & 0x3f));
+            cch = 2;
+        } else if(c < 0x10000) {
+            pb[0] = (BYTE)(0xe0 | (c >> 12));
+            pb[1] = (BYTE)(0x80 | ((c >> 6) & 0x3f));
+            pb[2] = (BYTE)(0x80 | (c & 0x3f));
+            cch = 3;
+        } else {
+            pb[0] = (BYTE)(0xf0 | (c >> 18));
+            pb[1] = (BYTE)(0x80 | ((c >> 12) & 0x3f));
+            pb[2] = (BYTE)(0x80 | ((c >> 6) & 0x3f));
+            pb[3] = (BYTE)(0x80 | (c & 0x3f));
+            cch = 4;
+        }
+        if(pLn->o + cch > pLn->cszMax) { return; }
+        memcpy(pLn->sz + pLn->o, pb, cch);
+        pLn->o += cch;
+    }
+}
+
+VOID Util_LnHex(_Inout_ PUTIL_LN pLn, _In_ QWORD qw, _In_ DWORD cWidth, _In_ BOOL fZeroPad)
+{
+    CHAR sz[16];
+    DWORD i = 16, c;
+    do {
+        sz[--i] = "0123456789abcdef"[qw & 0xf];
+        qw >>= 4;
+    } while(qw);
+    for(c = 16 - i; c < cWidth; c++) {
+        Util_LnChar(pLn, fZeroPad ? '0' : ' ');
+    }
+    while(i < 16) {
+        Util_LnChar(pLn, sz[i++]);
+    }
+}
+
+VOID Util_LnDec(_Inout_ PUTIL_LN pLn, _In_ QWORD qw, _In_ DWORD cWidth)
+{
+    CHAR sz[20];
+    DWORD i = 20, c;
+    do {
+        sz[--i] = '0' + (CHAR)(qw % 10);
+        qw /= 10;
+    } while(qw);
+    for(c = 20 - i; c < cWidth; c++) {
+        Util_LnChar(pLn, ' ');
+    }
+    while(i < 20) {
+        Util_LnChar(pLn, sz[i++]);
+    }
+}
+
+DWORD Util_LnEnd(_Inout_ PUTIL_LN pLn)
+{
+    if(pLn->o < pLn->cszMax) {
+        memset(pLn->sz + pLn->o, ' ', pLn->cszMax - pLn->o);
+    }
+    pLn->sz[pLn->cszMax] = '\n';
+    pLn->sz[pLn->cszMax + 1] = '\0';
+    return pLn->cszMax + 1;
+}
+
 VOID Util_GetPathDll(_Out_writes_(MAX_PATH) PCHAR szPath, _In_opt_ HMODULE hModule)
 {
     SIZE_T i;
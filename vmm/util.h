@@ -240,6 +240,60 @@ DWORD Util_snwprintf_u8ln(
     ...
 );
 
+/*
+* Fixed-width utf-8 line builder - a fast alternative to Util_snwprintf_u8ln
+* when rendering large numbers of lines. Fields are emitted directly as utf-8
+* and silently truncated at the line length. Util_LnEnd space pads the line
+* and terminates it with newline '\n' and NULL char (linelength + 1).
+*/
+typedef struct tdUTIL_LN {
+    LPSTR sz;
+    DWORD o;                        // current write offset.
+    DWORD cszMax;                   // max # chars excl. newline.
+} UTIL_LN, *PUTIL_LN;
+
+/*
+* Initialize a line builder.
+* -- pLn
+* -- szBuffer
+* -- cszLineLength = line length in bytes including newline, excluding NULL (> 0).
+*/
+VOID Util_LnInit(_Out_ PUTIL_LN pLn, _Out_writes_(cszLineLength + 1) LPSTR szBuffer, _In_ DWORD cszLineLength);
+
+/*
+* Emit a single char / a null-terminated char string.
+* -- pLn
+* -- ch / sz
+* -- cWidth = min field width, left aligned space padded (printf: %-*s).
+*/
+VOID Util_LnChar(_Inout_ PUTIL_LN pLn, _In_ CHAR ch);
+VOID Util_LnStr(_Inout_ PUTIL_LN pLn, _In_ LPSTR sz, _In_ DWORD cWidth);
+
+/*
+* Emit a wide string converted to utf-8. Invalid surrogates are replaced with
+* U+FFFD and multi-byte characters are never split at the line end.
+* -- pLn
+* -- wsz
+*/
+VOID Util_LnWstr(_Inout_ PUTIL_LN pLn, _In_ LPWSTR wsz);
+
+/*
+* Emit a number in lowercase hexadecimal / decimal notation.
+* -- pLn
+* -- qw
+* -- cWidth = min field width, right aligned (printf: %*llx / %*llu).
+* -- fZeroPad = pad with zeroes instead of spaces (printf: %0*llx).
+*/
+VOID Util_LnHex(_Inout_ PUTIL_LN pLn, _In_ QWORD qw, _In_ DWORD cWidth, _In_ BOOL fZeroPad);
+VOID Util_LnDec(_Inout_ PUTIL_LN pLn, _In_ QWORD qw, _In_ DWORD cWidth);
+
+/*
+* Finish the line - space pad, terminate with newline and NULL char.
+* -- pLn
+* -- return = line length in bytes including newline.
+*/
+DWORD Util_LnEnd(_Inout_ PUTIL_LN pLn);
+
 /*
 * Return the path of the specified hModule (DLL) - ending with a backslash, or current Executable.
 * -- szPath
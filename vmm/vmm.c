@@ -14,7 +14,9 @@
 #include "vmmwinreg.h"
 #include "vmmwinsvc.h"
 #include "vmmnet.h"
+#include "vmmpmemz.h"
 #include "pluginmanager.h"
+#include "statistics.h"
 #include "util.h"
 #include <sddl.h>
 
@@ -329,7 +331,7 @@ PVMMOB_CACHE_MEM VmmCacheGet_FromDeviceOnMiss(_In_ DWORD dwTblTag, _In_ DWORD dw
             pObMEM = NULL;
         }
         if(!pMEM->f) {
-            LcReadScatter(ctxMain->hLC, 1, &pMEM);
+            VmmIoScheduler_ReadScatter(1, &pMEM);
         }
         if(pMEM->f) {
             Ob_INCREF(pObReservedMEM);
@@ -392,7 +394,7 @@ VOID VmmTlbPrefetch(_In_ POB_SET pTlbPrefetch)
             ppMEMs[i] = &ppObMEMs[i]->h;
             ppMEMs[i]->qwA = ObSet_Pop(pTlbPrefetch);
         }
-        LcReadScatter(ctxMain->hLC, cTlbs, ppMEMs);
+        VmmIoScheduler_ReadScatter(cTlbs, ppMEMs);
         for(i = 0; i < cTlbs; i++) {
             if(ppMEMs[i]->f && !VmmTlbPageTableVerify(ppMEMs[i]->pb, ppMEMs[i]->qwA, FALSE)) {
                 ppMEMs[i]->f = FALSE;  // "fail" invalid page table read
@@ -787,6 +789,301 @@ BOOL VmmMap_GetService(_Out_ PVMMOB_MAP_SERVICE *ppObServiceMap)
     return pObSvcMap != NULL;
 }
 
+/*
+* Retrieve the kernel BIG POOL map.
+* CALLER DECREF: ppObPoolMap
+* -- ppObPoolMap
+* -- return
+*/
+_Success_(return)
+BOOL VmmMap_GetPool(_Out_ PVMMOB_MAP_POOL *ppObPoolMap)
+{
+    PVMMOB_MAP_POOL pObPoolMap = ObContainer_GetOb(ctxVmm->pObCMapPool);
+    if(!pObPoolMap) {
+        pObPoolMap = VmmWinPool_Initialize();
+    }
+    *ppObPoolMap = pObPoolMap;
+    return pObPoolMap != NULL;
+}
+
+/*
+* Retrieve the big pool allocation containing the address va.
+* -- pPoolMap
+* -- va
+* -- return = the pool entry or NULL if va is not within a tracked allocation.
+*/
+PVMM_MAP_POOLENTRY VmmMap_GetPoolEntry(_In_ PVMMOB_MAP_POOL pPoolMap, _In_ QWORD va)
+{
+    DWORD iMap, cMap;
+    PVMM_MAP_POOLENTRY pe;
+    // last entry starting at or below va:
+    if(!(cMap = VmmMap_GetPoolRange(pPoolMap, 0, va + 1, &iMap))) { return NULL; }
+    pe = pPoolMap->pMap + iMap + cMap - 1;
+    return (va < pe->va + pe->cb) ? pe : NULL;
+}
+
+/*
+* Retrieve the big pool allocations starting within the address range
+* [vaStart, vaEnd). Matching entries are pPoolMap->pMap[*piMap + 0..return-1].
+* -- pPoolMap
+* -- vaStart
+* -- vaEnd
+* -- piMap
+* -- return = the number of matching entries.
+*/
+DWORD VmmMap_GetPoolRange(_In_ PVMMOB_MAP_POOL pPoolMap, _In_ QWORD vaStart, _In_ QWORD vaEnd, _Out_ PDWORD piMap)
+{
+    DWORD iLo, iHi, iMid, iStart;
+    // lower bound of vaStart:
+    iLo = 0; iHi = pPoolMap->cMap;
+    while(iLo < iHi) {
+        iMid = (iLo + iHi) >> 1;
+        if(pPoolMap->pMap[iMid].va < vaStart) { iLo = iMid + 1; } else { iHi = iMid; }
+    }
+    *piMap = iStart = iLo;
+    // lower bound of vaEnd:
+    iHi = pPoolMap->cMap;
+    while(iLo < iHi) {
+        iMid = (iLo + iHi) >> 1;
+        if(pPoolMap->pMap[iMid].va < vaEnd) { iLo = iMid + 1; } else { iHi = iMid; }
+    }
+    return iLo - iStart;
+}
+
+/*
+* Retrieve the big pool allocations with a given pool tag. Matching entries are
+* pPoolMap->pMap[pPoolMap->piTag[*piTag + 0..return-1]] in address order.
+* -- pPoolMap
+* -- dwPoolTag = pool tag as multi-character constant, i.e. 'Obtb'.
+* -- piTag
+* -- return = the number of matching entries.
+*/
+DWORD VmmMap_GetPoolTag(_In_ PVMMOB_MAP_POOL pPoolMap, _In_ DWORD dwPoolTag, _Out_ PDWORD piTag)
+{
+    DWORD iLo, iHi, iMid, iStart;
+    dwPoolTag = _byteswap_ulong(dwPoolTag);
+    iLo = 0; iHi = pPoolMap->cMap;
+    while(iLo < iHi) {
+        iMid = (iLo + iHi) >> 1;
+        if(pPoolMap->pMap[pPoolMap->piTag[iMid]].dwPoolTag < dwPoolTag) { iLo = iMid + 1; } else { iHi = iMid; }
+    }
+    *piTag = iStart = iLo;
+    iHi = pPoolMap->cMap;
+    while(iLo < iHi) {
+        iMid = (iLo + iHi) >> 1;
+        if(pPoolMap->pMap[pPoolMap->piTag[iMid]].dwPoolTag <= dwPoolTag) { iLo = iMid + 1; } else { iHi = iMid; }
+    }
+    return iLo - iStart;
+}
+
+/*
+* Retrieve the pool tag of the big pool allocation starting at va from the big
+* pool index.
+* -- va
+* -- fBuild = build the index if not already built.
+* -- pdwPoolTag
+* -- return = TRUE if va is the start of a tracked big pool allocation.
+*/
+_Success_(return)
+BOOL VmmMap_GetPoolTagByAddress(_In_ QWORD va, _In_ BOOL fBuild, _Out_ PDWORD pdwPoolTag)
+{
+    BOOL fResult = FALSE;
+    DWORD iMap;
+    PVMMOB_MAP_POOL pObPoolMap = NULL;
+    if(fBuild) {
+        if(!VmmMap_GetPool(&pObPoolMap)) { return FALSE; }
+    } else {
+        if(!(pObPoolMap = ObContainer_GetOb(ctxVmm->pObCMapPool))) { return FALSE; }
+    }
+    if(VmmMap_GetPoolRange(pObPoolMap, va, va + 1, &iMap)) {
+        *pdwPoolTag = pObPoolMap->pMap[iMap].dwPoolTag;
+        InterlockedIncrement64(&ctxVmm->stat.cPoolIndexLookup);
+        fResult = TRUE;
+    }
+    Ob_DECREF(pObPoolMap);
+    return fResult;
+}
+
+// ----------------------------------------------------------------------------
+// MAP TEXT FUNCTIONALITY:
+// Fixed-width text files rendered from map objects are cached as rendered text
+// keyed by the map object. The cached text keeps a reference to the map object
+// which guarantees that the key address is not re-used while cached.
+// ----------------------------------------------------------------------------
+
+#define VMM_MAPTEXT_ENTRY_MAX           0x02000000      // max size of a single cached text
+#define VMM_MAPTEXT_TOTAL_MAX           0x08000000      // max total size of cached texts
+
+VOID VmmMapText_CloseObCallback(_In_ PVOID pVmmOb)
+{
+    Ob_DECREF(((PVMMOB_MAP_TEXT)pVmmOb)->pObMap);
+}
+
+VOID VmmMapText_Clear()
+{
+    ObMap_Clear(ctxVmm->Cache.pmMapText);
+    ctxVmm->Cache.cbMapText = 0;
+}
+
+/*
+* Render lines [iLineStart, iLineStart + cLine) into sz.
+*/
+VOID VmmMapText_Render(_In_ DWORD iLineStart, _In_ DWORD cLine, _In_ DWORD cszLineLength, _In_opt_ PVOID ctx, _In_ VMM_MAPTEXT_PFN_RENDERLINE pfnRenderLine, _Out_writes_(cLine * cszLineLength + 1) LPSTR sz)
+{
+    DWORD i;
+    for(i = 0; i < cLine; i++) {
+        pfnRenderLine(ctx, iLineStart + i, sz + (QWORD)i * cszLineLength, cszLineLength);
+    }
+}
+
+_Success_(return == 0)
+NTSTATUS VmmMapText_Read(
+    _In_ POB pObMap,
+    _In_ DWORD dwRenderId,
+    _In_ DWORD cLine,
+    _In_ DWORD cszLineLength,
+    _In_opt_ PVOID ctx,
+    _In_ VMM_MAPTEXT_PFN_RENDERLINE pfnRenderLine,
+    _Out_writes_to_(cb, *pcbRead) PBYTE pb,
+    _In_ DWORD cb,
+    _Out_ PDWORD pcbRead,
+    _In_ QWORD cbOffset
+) {
+    NTSTATUS nt;
+    LPSTR sz;
+    QWORD qwKey, cbText, cStart, cEnd;
+    PVMMOB_MAP_TEXT pObText = NULL;
+    if(!cLine || !cszLineLength) { return VMMDLL_STATUS_END_OF_FILE; }
+    cbText = (QWORD)cLine * cszLineLength;
+    qwKey = (QWORD)pObMap | (dwRenderId & 0x0f);
+    // 1: cached text
+    if((pObText = ObMap_GetByKey(ctxVmm->Cache.pmMapText, qwKey))) {
+        nt = Util_VfsReadFile_FromPBYTE(pObText->pb, pObText->cb, pb, cb, pcbRead, cbOffset);
+        Ob_DECREF(pObText);
+        return nt;
+    }
+    // 2: render and cache complete text
+    if((cbText <= VMM_MAPTEXT_ENTRY_MAX) && (pObText = Ob_Alloc(OB_TAG_MAP_TEXT, 0, sizeof(VMMOB_MAP_TEXT) + cbText + 1, VmmMapText_CloseObCallback, NULL))) {
+        pObText->pObMap = Ob_INCREF(pObMap);
+        pObText->dwRenderId = dwRenderId;
+        pObText->cszLineLength = cszLineLength;
+        pObText->cb = cbText;
+        VmmMapText_Render(0, cLine, cszLineLength, ctx, pfnRenderLine, (LPSTR)pObText->pb);
+        if(ctxVmm->Cache.cbMapText + cbText > VMM_MAPTEXT_TOTAL_MAX) {
+            VmmMapText_Clear();
+        }
+        if(ObMap_Push(ctxVmm->Cache.pmMapText, qwKey, pObText)) {
+            InterlockedAdd64((PLONG64)&ctxVmm->Cache.cbMapText, cbText);
+        }
+        nt = Util_VfsReadFile_FromPBYTE(pObText->pb, pObText->cb, pb, cb, pcbRead, cbOffset);
+        Ob_DECREF(pObText);
+        return nt;
+    }
+    // 3: render requested lines only (large texts)
+    cStart = cbOffset / cszLineLength;
+    if(cStart >= cLine) { return VMMDLL_STATUS_END_OF_FILE; }
+    cEnd = min(cLine - 1, (cb + cbOffset + cszLineLength - 1) / cszLineLength);
+    if(!(sz = LocalAlloc(0, 1 + (1 + cEnd - cStart) * cszLineLength))) { return VMMDLL_STATUS_FILE_INVALID; }
+    VmmMapText_Render((DWORD)cStart, (DWORD)(1 + cEnd - cStart), cszLineLength, ctx, pfnRenderLine, sz);
+    nt = Util_VfsReadFile_FromPBYTE(sz, (1 + cEnd - cStart) * cszLineLength, pb, cb, pcbRead, cbOffset - cStart * cszLineLength);
+    LocalFree(sz);
+    return nt;
+}
+
+// ----------------------------------------------------------------------------
+// OFFSET CACHE FUNCTIONALITY:
+// Structure offsets located by heuristics (fuzzing) are cached keyed by a tag
+// and the build identity of the module they belong to. The cache lives for the
+// session and is optionally persisted to the file given by -offsetcache as a
+// sequence of fixed size VMM_OFFSETCACHE_ENTRY records.
+// ----------------------------------------------------------------------------
+
+#define VMM_OFFSETCACHE_MAGIC           'VmOC'
+#define VMM_OFFSETCACHE_CBMAX           0x80
+#define VMM_OFFSETCACHE_KEY(tag, id)    ((((QWORD)(tag)) << 32) ^ (QWORD)(id) ^ (tag))
+
+typedef struct tdVMM_OFFSETCACHE_ENTRY {
+    DWORD dwMagic;
+    DWORD dwTag;
+    QWORD qwBuildId;
+    DWORD cTickCost;
+    DWORD cb;
+    BYTE pb[VMM_OFFSETCACHE_CBMAX];
+} VMM_OFFSETCACHE_ENTRY, *PVMM_OFFSETCACHE_ENTRY;
+
+/*
+* Load the offset cache file (if configured) into the offset cache on first use.
+*/
+VOID VmmOffsetCache_LoadEnsure()
+{
+    FILE *hFile = NULL;
+    PVMM_OFFSETCACHE_ENTRY pe = NULL;
+    if(ctxVmm->OffsetCache.fLoaded) { return; }
+    EnterCriticalSection(&ctxVmm->LockMaster);
+    if(!ctxVmm->OffsetCache.fLoaded && ctxMain->cfg.szOffsetCache[0] && !fopen_s(&hFile, ctxMain->cfg.szOffsetCache, "rb") && hFile) {
+        while(TRUE) {
+            if(!pe && !(pe = LocalAlloc(0, sizeof(VMM_OFFSETCACHE_ENTRY)))) { break; }
+            if(1 != fread(pe, sizeof(VMM_OFFSETCACHE_ENTRY), 1, hFile)) { break; }
+            if((pe->dwMagic != VMM_OFFSETCACHE_MAGIC) || (pe->cb > VMM_OFFSETCACHE_CBMAX)) { break; }
+            if(ObMap_Push(ctxVmm->OffsetCache.pm, VMM_OFFSETCACHE_KEY(pe->dwTag, pe->qwBuildId), pe)) {
+                pe = NULL;
+            }
+        }
+        fclose(hFile);
+        vmmprintfvv_fn("loaded %i entries from '%s'\n", ObMap_Size(ctxVmm->OffsetCache.pm), ctxMain->cfg.szOffsetCache);
+    }
+    LocalFree(pe);
+    ctxVmm->OffsetCache.fLoaded = TRUE;
+    LeaveCriticalSection(&ctxVmm->LockMaster);
+}
+
+_Success_(return)
+BOOL VmmOffsetCache_Get(_In_ DWORD dwTag, _In_ QWORD qwBuildId, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb)
+{
+    BOOL fResult;
+    PVMM_OFFSETCACHE_ENTRY pe;
+    VmmOffsetCache_LoadEnsure();
+    pe = ObMap_GetByKey(ctxVmm->OffsetCache.pm, VMM_OFFSETCACHE_KEY(dwTag, qwBuildId));
+    fResult = pe && (pe->dwTag == dwTag) && (pe->qwBuildId == qwBuildId) && (pe->cb == cb);
+    if(fResult) {
+        memcpy(pb, pe->pb, cb);
+        InterlockedIncrement64((PLONG64)&ctxVmm->OffsetCache.cHit);
+        InterlockedAdd64((PLONG64)&ctxVmm->OffsetCache.cTickSaved, pe->cTickCost);
+    } else {
+        InterlockedIncrement64((PLONG64)&ctxVmm->OffsetCache.cMiss);
+    }
+    vmmprintfvv_fn("tag=%08x build=%016llx %s [hit=%lli miss=%lli saved=%llims]\n",
+        dwTag, qwBuildId, (fResult ? "HIT" : "MISS"),
+        ctxVmm->OffsetCache.cHit, ctxVmm->OffsetCache.cMiss, ctxVmm->OffsetCache.cTickSaved);
+    return fResult;
+}
+
+VOID VmmOffsetCache_Put(_In_ DWORD dwTag, _In_ QWORD qwBuildId, _In_ QWORD cTickCost, _In_reads_(cb) PBYTE pb, _In_ DWORD cb)
+{
+    FILE *hFile = NULL;
+    PVMM_OFFSETCACHE_ENTRY pe;
+    if(cb > VMM_OFFSETCACHE_CBMAX) { return; }
+    VmmOffsetCache_LoadEnsure();
+    if(!(pe = LocalAlloc(LMEM_ZEROINIT, sizeof(VMM_OFFSETCACHE_ENTRY)))) { return; }
+    pe->dwMagic = VMM_OFFSETCACHE_MAGIC;
+    pe->dwTag = dwTag;
+    pe->qwBuildId = qwBuildId;
+    pe->cTickCost = (DWORD)min(cTickCost, 0xffffffff);
+    pe->cb = cb;
+    memcpy(pe->pb, pb, cb);
+    EnterCriticalSection(&ctxVmm->LockMaster);
+    if(ctxMain->cfg.szOffsetCache[0] && !ObMap_ExistsKey(ctxVmm->OffsetCache.pm, VMM_OFFSETCACHE_KEY(dwTag, qwBuildId))) {
+        if(!fopen_s(&hFile, ctxMain->cfg.szOffsetCache, "ab") && hFile) {
+            fwrite(pe, sizeof(VMM_OFFSETCACHE_ENTRY), 1, hFile);
+            fclose(hFile);
+        }
+    }
+    if(!ObMap_Push(ctxVmm->OffsetCache.pm, VMM_OFFSETCACHE_KEY(dwTag, qwBuildId), pe)) {
+        LocalFree(pe);
+    }
+    LeaveCriticalSection(&ctxVmm->LockMaster);
+}
+
 // ----------------------------------------------------------------------------
 // PROCESS MANAGEMENT FUNCTIONALITY:
 //
@@ -814,37 +1111,251 @@ BOOL VmmMap_GetService(_Out_ PVMMOB_MAP_SERVICE *ppObServiceMap)
 // The process table object (only used internally): VMMOB_PROCESS_TABLE
 // ----------------------------------------------------------------------------
 
+#define VMM_PROCESSTABLE_HASH(pt, dwPID)    ((((dwPID) >> 2) ^ (dwPID)) & ((pt)->cSlot - 1))
+
+/*
+* Locate the slot of a process in the process table.
+* -- pt
+* -- dwPID
+* -- piSlot = slot index on success.
+* -- return
+*/
+_Success_(return)
+BOOL VmmProcessTable_Find(_In_ PVMMOB_PROCESS_TABLE pt, _In_ DWORD dwPID, _Out_ PDWORD piSlot)
+{
+    DWORD i, iProbe;
+    if(!pt->cSlot) { return FALSE; }
+    i = VMM_PROCESSTABLE_HASH(pt, dwPID);
+    for(iProbe = 0; iProbe < pt->cSlot; iProbe++) {
+        if(!pt->_M[i]) { return FALSE; }
+        if(pt->_M[i]->dwPID == dwPID) {
+            *piSlot = i;
+            return TRUE;
+        }
+        i = (i + 1) & (pt->cSlot - 1);
+    }
+    return FALSE;
+}
+
+/*
+* Insert a process into a free slot in the process table as the new list head.
+* The process is "consumed" by the table (no refcount increase).
+* -- pt
+* -- pProcess
+* -- cProbeMax
+* -- return = FALSE if no free slot is found within cProbeMax probes.
+*/
+_Success_(return)
+BOOL VmmProcessTable_InsertSlot(_In_ PVMMOB_PROCESS_TABLE pt, _In_ PVMM_PROCESS pProcess, _In_ DWORD cProbeMax)
+{
+    DWORD i, iProbe;
+    i = VMM_PROCESSTABLE_HASH(pt, pProcess->dwPID);
+    for(iProbe = 0; iProbe < cProbeMax; iProbe++) {
+        if(!pt->_M[i]) {
+            pt->_M[i] = pProcess;
+            pt->_iFLinkM[i] = pt->_iFLink;
+            pt->_iFLink = i + 1;
+            pt->c++;
+            pt->cActive += (pProcess->dwState == 0) ? 1 : 0;
+            return TRUE;
+        }
+        i = (i + 1) & (pt->cSlot - 1);
+    }
+    return FALSE;
+}
+
+/*
+* Rebuild the process table slots with a new slot count - keeping list order.
+* Terminated processes exceeding cTerminatedMax are dropped - starting with the
+* least recently inserted ones.
+* -- pt
+* -- cSlot = new slot count (power of two, larger than 2x process count).
+* -- cTerminatedMax
+* -- return
+*/
+_Success_(return)
+BOOL VmmProcessTable_Rebuild(_In_ PVMMOB_PROCESS_TABLE pt, _In_ DWORD cSlot, _In_ DWORD cTerminatedMax)
+{
+    DWORD i, iM, cProcess = 0, cTerminated = 0;
+    PBYTE pbSlots = NULL;
+    PVMM_PROCESS *ppProcess = NULL;
+    if(!(ppProcess = LocalAlloc(0, max(1, pt->c) * sizeof(PVMM_PROCESS)))) { goto fail; }
+    if(!(pbSlots = LocalAlloc(LMEM_ZEROINIT, cSlot * (sizeof(PVMM_PROCESS) + sizeof(DWORD))))) { goto fail; }
+    // 1: collect processes - most recently inserted first.
+    iM = pt->_iFLink;
+    while(iM && (cProcess < pt->c)) {
+        ppProcess[cProcess++] = pt->_M[iM - 1];
+        iM = pt->_iFLinkM[iM - 1];
+    }
+    // 2: replace slots and re-insert - oldest first to keep list order.
+    LocalFree(pt->_M);
+    pt->_M = (PVMM_PROCESS*)pbSlots;
+    pt->_iFLinkM = (PDWORD)(pbSlots + cSlot * sizeof(PVMM_PROCESS));
+    pt->cSlot = cSlot;
+    pt->_iFLink = 0;
+    pt->c = 0;
+    pt->cActive = 0;
+    for(i = 0; i < cProcess; i++) {
+        if(ppProcess[i]->dwState && (++cTerminated > cTerminatedMax)) {
+            Ob_DECREF_NULL(&ppProcess[i]);
+        }
+    }
+    while(cProcess) {
+        cProcess--;
+        if(ppProcess[cProcess]) {
+            VmmProcessTable_InsertSlot(pt, ppProcess[cProcess], cSlot);
+        }
+    }
+    LocalFree(ppProcess);
+    return TRUE;
+fail:
+    LocalFree(pbSlots);
+    LocalFree(ppProcess);
+    return FALSE;
+}
+
+/*
+* Insert a process into the process table. The table is grown if it's more
+* than half full or if the probe length would exceed VMM_PROCESSTABLE_PROBE_MAX.
+* The process is "consumed" by the table (no refcount increase).
+* -- pt
+* -- pProcess
+* -- return
+*/
+_Success_(return)
+BOOL VmmProcessTable_Insert(_In_ PVMMOB_PROCESS_TABLE pt, _In_ PVMM_PROCESS pProcess)
+{
+    if(((pt->c + 1) << 1) > pt->cSlot) {
+        if(!VmmProcessTable_Rebuild(pt, pt->cSlot << 1, (DWORD)-1)) { return FALSE; }
+    }
+    while(!VmmProcessTable_InsertSlot(pt, pProcess, VMM_PROCESSTABLE_PROBE_MAX)) {
+        if((pt->cSlot >= 0x01000000) || !VmmProcessTable_Rebuild(pt, pt->cSlot << 1, (DWORD)-1)) { return FALSE; }
+    }
+    return TRUE;
+}
+
+/*
+* Object manager callback before 'process table' object cleanup - decrease
+* refcount of all contained 'process' objects.
+*/
+VOID VmmProcessTable_CloseObCallback(_In_ PVOID pVmmOb)
+{
+    PVMMOB_PROCESS_TABLE pt = (PVMMOB_PROCESS_TABLE)pVmmOb;
+    DWORD iM;
+    // Close NewPROC
+    Ob_DECREF_NULL(&pt->pObCNewPROC);
+    // DECREF all pProcess in table
+    iM = pt->_iFLink;
+    while(iM) {
+        Ob_DECREF(pt->_M[iM - 1]);
+        iM = pt->_iFLinkM[iM - 1];
+    }
+    LocalFree(pt->_M);
+}
+
+/*
+* Create a new empty process table.
+* CALLER DECREF: return
+* -- return
+*/
+PVMMOB_PROCESS_TABLE VmmProcessTable_New()
+{
+    PVMMOB_PROCESS_TABLE pt;
+    if(!(pt = (PVMMOB_PROCESS_TABLE)Ob_Alloc(OB_TAG_VMM_PROCESSTABLE, LMEM_ZEROINIT, sizeof(VMMOB_PROCESS_TABLE), VmmProcessTable_CloseObCallback, NULL))) { return NULL; }
+    pt->cSlot = VMM_PROCESSTABLE_SLOTS_INITIAL;
+    pt->_M = LocalAlloc(LMEM_ZEROINIT, pt->cSlot * (sizeof(PVMM_PROCESS) + sizeof(DWORD)));
+    pt->_iFLinkM = (PDWORD)((PBYTE)pt->_M + pt->cSlot * sizeof(PVMM_PROCESS));
+    pt->pObCNewPROC = ObContainer_New(NULL);
+    if(!pt->_M || !pt->pObCNewPROC) {
+        Ob_DECREF_NULL(&pt);
+    }
+    return pt;
+}
+
+#define VMM_TOKENCACHE_MAX          0x4000
+
+typedef struct tdVMM_TOKENCACHE_ENTRY {
+    QWORD va;
+    QWORD qwLUID;
+    QWORD qwModifiedId;
+    BYTE pbSID[SECURITY_MAX_SID_SIZE];
+} VMM_TOKENCACHE_ENTRY, *PVMM_TOKENCACHE_ENTRY;
+
+/*
+* Store a resolved token summary in the token cache which survives refreshes.
+* The entry is validated against TokenId and ModifiedId upon later use.
+* -- pProcess
+* -- qwModifiedId
+*/
+VOID VmmProcess_TokenCachePut(_In_ PVMM_PROCESS pProcess, _In_ QWORD qwModifiedId)
+{
+    PVMM_TOKENCACHE_ENTRY pe;
+    if(!(pe = ObMap_GetByKey(ctxVmm->UserCache.pmToken, pProcess->win.TOKEN.va))) {
+        if(ObMap_Size(ctxVmm->UserCache.pmToken) >= VMM_TOKENCACHE_MAX) {
+            ObMap_Clear(ctxVmm->UserCache.pmToken);
+        }
+        if(!(pe = LocalAlloc(0, sizeof(VMM_TOKENCACHE_ENTRY)))) { return; }
+        if(!ObMap_Push(ctxVmm->UserCache.pmToken, pProcess->win.TOKEN.va, pe)) {
+            LocalFree(pe);
+            return;
+        }
+    }
+    pe->va = pProcess->win.TOKEN.va;
+    pe->qwLUID = pProcess->win.TOKEN.qwLUID;
+    pe->qwModifiedId = qwModifiedId;
+    memcpy(pe->pbSID, pProcess->win.TOKEN.pbSID, SECURITY_MAX_SID_SIZE);
+}
+
+/*
+* Resolve token information (LUID, session and SID) for all processes in the
+* process table not yet initialized. Tokens already resolved in a previous
+* process table (i.e. before a refresh) are validated by token address and
+* ModifiedId and their SID is then taken from the token cache.
+* NB! must be called with ctxVmm->LockMaster held.
+* -- pt
+*/
 VOID VmmProcess_TokenTryEnsure(_In_ PVMMOB_PROCESS_TABLE pt)
 {
-    BOOL f, f32 = ctxVmm->f32;
-    DWORD j, i = 0, iM, cbHdr, cb;
-    QWORD va, *pva = NULL;
+    BOOL f, f32 = ctxVmm->f32, fCache;
+    DWORD j, i = 0, iM, cbHdr, cb, cCacheHit = 0, cRead = 0, cRoundTrip = 0;
+    QWORD va, *pva = NULL, *pqwModifiedId = NULL;
     BYTE pb[0x1000];
     PVMM_PROCESS *ppProcess = NULL, pObSystemProcess = NULL;
+    PVMM_TOKENCACHE_ENTRY peCache;
     PVMM_OFFSET_EPROCESS oep = &ctxVmm->offset.EPROCESS;
     f = oep->opt.TOKEN_TokenId &&                                               // token offsets/symbols initialized.
         (pObSystemProcess = VmmProcessGet(4)) &&
         (pva = LocalAlloc(LMEM_ZEROINIT, pt->c * sizeof(QWORD))) &&
+        (pqwModifiedId = LocalAlloc(LMEM_ZEROINIT, pt->c * sizeof(QWORD))) &&
         (ppProcess = LocalAlloc(LMEM_ZEROINIT, pt->c * sizeof(PVMM_PROCESS)));
     if(!f) { goto fail; }
     cbHdr = f32 ? 0x2c : 0x5c;
     cb = cbHdr + oep->opt.TOKEN_UserAndGroups + 8;
+    fCache = oep->opt.TOKEN_ModifiedId && (oep->opt.TOKEN_ModifiedId + 8 <= oep->opt.TOKEN_UserAndGroups);
     // 1: Get Process and Token VA:
     iM = pt->_iFLink;
     while(iM && i < pt->c) {
-        if((ppProcess[i] = pt->_M[iM]) && !ppProcess[i]->win.TOKEN.fInitialized) {
+        if((ppProcess[i] = pt->_M[iM - 1]) && !ppProcess[i]->win.TOKEN.fInitialized) {
             va = VMM_PTR_OFFSET(f32, ppProcess[i]->win.EPROCESS.pb, oep->opt.Token) & (f32 ? ~0x7 : ~0xf);
             if(VMM_KADDR(va)) {
                 ppProcess[i]->win.TOKEN.va = va;
                 pva[i] = va - cbHdr; // adjust for _OBJECT_HEADER and Pool Header
+                cRead++;
             }
+        } else {
+            ppProcess[i] = NULL;
         }
-        iM = pt->_iFLinkM[iM];
+        iM = pt->_iFLinkM[iM - 1];
         i++;
     }
-    // 2: Read Token:
-    VmmCachePrefetchPages4(pObSystemProcess, (DWORD)pt->c, pva, cb, 0);
-    for(i = 0; i < pt->c; i++) {
+    ctxVmm->fTokenResolveAsync = TRUE;
+    InterlockedIncrement64(&ctxVmm->stat.cTokenResolve);
+    // 2: Read Token (and validate against token cache):
+    if(cRead) {
+        VmmCachePrefetchPages4(pObSystemProcess, (DWORD)pt->c, pva, cb, 0);
+        cRoundTrip++;
+    }
+    for(i = 0, cRead = 0; i < pt->c; i++) {
         f = pva[i] && VmmRead2(pObSystemProcess, pva[i], pb, cb, VMM_FLAG_FORCECACHE_READ) &&
             (pva[i] = VMM_PTR_OFFSET(f32, pb, cb - 8)) &&
             VMM_KADDR(pva[i]);
@@ -855,22 +1366,41 @@ VOID VmmProcess_TokenTryEnsure(_In_ PVMMOB_PROCESS_TABLE pt)
             if(f) {
                 ppProcess[i]->win.TOKEN.qwLUID = *(PQWORD)(pb + cbHdr + ctxVmm->offset.EPROCESS.opt.TOKEN_TokenId);
                 ppProcess[i]->win.TOKEN.dwSessionId = *(PDWORD)(pb + cbHdr + ctxVmm->offset.EPROCESS.opt.TOKEN_SessionId);
+                if(fCache) {
+                    pqwModifiedId[i] = *(PQWORD)(pb + cbHdr + oep->opt.TOKEN_ModifiedId);
+                    peCache = ObMap_GetByKey(ctxVmm->UserCache.pmToken, ppProcess[i]->win.TOKEN.va);
+                    if(peCache && (peCache->qwLUID == ppProcess[i]->win.TOKEN.qwLUID) && (peCache->qwModifiedId == pqwModifiedId[i])) {
+                        memcpy(ppProcess[i]->win.TOKEN.pbSID, peCache->pbSID, SECURITY_MAX_SID_SIZE);
+                        ppProcess[i]->win.TOKEN.fSID = IsValidSid(&ppProcess[i]->win.TOKEN.SID);
+                        pqwModifiedId[i] = 0;
+                        cCacheHit++;
+                        f = FALSE;
+                    }
+                }
             }
         }
         if(!f) { pva[i] = 0; }
+        if(pva[i]) { cRead++; }
     }
     // 3: Read SID ptr:
-    VmmCachePrefetchPages4(pObSystemProcess, (DWORD)pt->c, pva, 8, 0);
-    for(i = 0; i < pt->c; i++) {
+    if(cRead) {
+        VmmCachePrefetchPages4(pObSystemProcess, (DWORD)pt->c, pva, 8, 0);
+        cRoundTrip++;
+    }
+    for(i = 0, cRead = 0; i < pt->c; i++) {
         f = pva[i] && VmmRead2(pObSystemProcess, pva[i], pb, 8, VMM_FLAG_FORCECACHE_READ) &&
             (pva[i] = VMM_PTR_OFFSET(f32, pb, 0)) &&
             VMM_KADDR(pva[i]);
         if(!f) { pva[i] = 0; };
+        if(pva[i]) { cRead++; }
     }
     // 4: Get SID:
-    VmmCachePrefetchPages4(pObSystemProcess, (DWORD)pt->c, pva, SECURITY_MAX_SID_SIZE, 0);
+    if(cRead) {
+        VmmCachePrefetchPages4(pObSystemProcess, (DWORD)pt->c, pva, SECURITY_MAX_SID_SIZE, 0);
+        cRoundTrip++;
+    }
     for(i = 0; i < pt->c; i++) {
-        if(!ppProcess[i]) { continue; }
+        if(!ppProcess[i] || ppProcess[i]->win.TOKEN.fSID) { continue; }
         ppProcess[i]->win.TOKEN.fSID =
             (va = pva[i]) &&
             VmmRead2(pObSystemProcess, va, (PBYTE)&ppProcess[i]->win.TOKEN.pbSID, SECURITY_MAX_SID_SIZE, VMM_FLAG_FORCECACHE_READ) &&
@@ -884,9 +1414,15 @@ VOID VmmProcess_TokenTryEnsure(_In_ PVMMOB_PROCESS_TABLE pt)
             ConvertSidToStringSidA(&ppProcess[i]->win.TOKEN.SID, &ppProcess[i]->win.TOKEN.szSID) &&
             (ppProcess[i]->win.TOKEN.dwHashSID = Util_HashStringA(ppProcess[i]->win.TOKEN.szSID));
         ppProcess[i]->win.TOKEN.fInitialized = TRUE;
+        if(pqwModifiedId[i] && ppProcess[i]->win.TOKEN.fSID) {
+            VmmProcess_TokenCachePut(ppProcess[i], pqwModifiedId[i]);
+        }
     }
+    InterlockedAdd64(&ctxVmm->stat.cTokenResolveRoundTrip, cRoundTrip);
+    vmmprintfvv_fn("processes: %i token cache hits: %i round trips: %i\n", (DWORD)pt->c, cCacheHit, cRoundTrip);
 fail:
     LocalFree(pva);
+    LocalFree(pqwModifiedId);
     LocalFree(ppProcess);
     Ob_DECREF(pObSystemProcess);
 }
@@ -906,6 +1442,33 @@ VOID VmmProcess_TokenTryEnsureLock(_In_ PVMMOB_PROCESS_TABLE pt, _In_ PVMM_PROCE
     LeaveCriticalSection(&ctxVmm->LockMaster);
 }
 
+/*
+* Check whether tokens of published process tables are resolved in the
+* background. Background resolution is a warm-up only - lookups requesting
+* tokens still resolve uninitialized tokens inline (serialized by LockMaster).
+* -- return
+*/
+inline BOOL VmmProcess_TokenIsResolveAsync()
+{
+    return ctxVmm->Work.fEnabled && (ctxVmm->fTokenResolveAsync || (ctxVmm->flags & VMM_FLAG_PROCESS_TOKEN));
+}
+
+/*
+* Worker thread entry point: resolve tokens of the active process table in the
+* background so that token lookups are not resolved on the lookup path.
+*/
+DWORD VmmProcess_TokenTryEnsureAsync_ThreadProc(_In_ LPVOID lpThreadParameter)
+{
+    PVMMOB_PROCESS_TABLE pObTable;
+    if((pObTable = (PVMMOB_PROCESS_TABLE)ObContainer_GetOb(ctxVmm->pObCPROC))) {
+        EnterCriticalSection(&ctxVmm->LockMaster);
+        VmmProcess_TokenTryEnsure(pObTable);
+        LeaveCriticalSection(&ctxVmm->LockMaster);
+        Ob_DECREF(pObTable);
+    }
+    return 1;
+}
+
 /*
 * Retrieve a process for a given PID and optional PVMMOB_PROCESS_TABLE.
 * CALLER DECREF: return
@@ -919,30 +1482,21 @@ PVMM_PROCESS VmmProcessGetEx(_In_opt_ PVMMOB_PROCESS_TABLE pt, _In_ DWORD dwPID,
     BOOL fToken = ((flags | ctxVmm->flags) & VMM_FLAG_PROCESS_TOKEN);
     PVMM_PROCESS pObProcess, pObProcessClone;
     PVMMOB_PROCESS_TABLE pObTable;
-    DWORD i, iStart;
+    DWORD i;
     if(!pt) {
         pObTable = (PVMMOB_PROCESS_TABLE)ObContainer_GetOb(ctxVmm->pObCPROC);
         pObProcess = VmmProcessGetEx(pObTable, dwPID, flags);
         Ob_DECREF(pObTable);
         return pObProcess;
     }
-    i = iStart = dwPID % VMM_PROCESSTABLE_ENTRIES_MAX;
-    while(TRUE) {
-        if(!pt->_M[i]) { goto fail; }
-        if(pt->_M[i]->dwPID == dwPID) {
-            pObProcess = (PVMM_PROCESS)Ob_INCREF(pt->_M[i]);
-            if(pObProcess && fToken && !pObProcess->win.TOKEN.fInitialized) { VmmProcess_TokenTryEnsureLock(pt, pObProcess); }
-            return pObProcess;
-        }
-        if(++i == VMM_PROCESSTABLE_ENTRIES_MAX) { i = 0; }
-        if(i == iStart) { goto fail; }
+    if(VmmProcessTable_Find(pt, dwPID, &i)) {
+        pObProcess = (PVMM_PROCESS)Ob_INCREF(pt->_M[i]);
+        if(pObProcess && fToken && !pObProcess->win.TOKEN.fInitialized) { VmmProcess_TokenTryEnsureLock(pt, pObProcess); }
+        return pObProcess;
     }
-fail:
     if(dwPID & VMM_PID_PROCESS_CLONE_WITH_KERNELMEMORY) {
         if((pObProcess = VmmProcessGetEx(pt, dwPID & ~VMM_PID_PROCESS_CLONE_WITH_KERNELMEMORY, flags))) {
-            if((pObProcessClone = VmmProcessClone(pObProcess))) {
-                pObProcessClone->fUserOnly = FALSE;
-            }
+            pObProcessClone = VmmProcessCloneKernel(pObProcess);
             Ob_DECREF(pObProcess);
             return pObProcessClone;
         }
@@ -968,7 +1522,7 @@ PVMM_PROCESS VmmProcessGetNextEx(_In_opt_ PVMMOB_PROCESS_TABLE pt, _In_opt_ PVMM
     BOOL fToken = ((flags | ctxVmm->flags) & VMM_FLAG_PROCESS_TOKEN);
     BOOL fShowTerminated = ((flags | ctxVmm->flags) & VMM_FLAG_PROCESS_SHOW_TERMINATED);
     PVMM_PROCESS pProcessNew;
-    DWORD i, iStart;
+    DWORD i;
     if(!pt) {
         pt = (PVMMOB_PROCESS_TABLE)ObContainer_GetOb(ctxVmm->pObCPROC);
         if(!pt) { goto fail; }
@@ -979,31 +1533,18 @@ PVMM_PROCESS VmmProcessGetNextEx(_In_opt_ PVMMOB_PROCESS_TABLE pt, _In_opt_ PVMM
 restart:
     if(!pProcess) {
         i = pt->_iFLink;
-        if(!pt->_M[i]) { goto fail; }
-        pProcessNew = (PVMM_PROCESS)Ob_INCREF(pt->_M[i]);
-        Ob_DECREF(pProcess);
-        pProcess = pProcessNew;
-        if(pProcess && pProcess->dwState && !fShowTerminated) { goto restart; }
-        if(pProcess && fToken && !pProcess->win.TOKEN.fInitialized) { VmmProcess_TokenTryEnsureLock(pt, pProcess); }
-        return pProcess;
-    }
-    i = iStart = pProcess->dwPID % VMM_PROCESSTABLE_ENTRIES_MAX;
-    while(TRUE) {
-        if(!pt->_M[i]) { goto fail; }
-        if(pt->_M[i]->dwPID == pProcess->dwPID) {
-            // current process -> retrieve next!
-            i = pt->_iFLinkM[i];
-            if(!pt->_M[i]) { goto fail; }
-            pProcessNew = (PVMM_PROCESS)Ob_INCREF(pt->_M[i]);
-            Ob_DECREF(pProcess);
-            pProcess = pProcessNew;
-            if(pProcess && pProcess->dwState && !fShowTerminated) { goto restart; }
-            if(pProcess && fToken && !pProcess->win.TOKEN.fInitialized) { VmmProcess_TokenTryEnsureLock(pt, pProcess); }
-            return pProcess;
-        }
-        if(++i == VMM_PROCESSTABLE_ENTRIES_MAX) { i = 0; }
-        if(i == iStart) { goto fail; }
+    } else {
+        // current process -> retrieve next!
+        if(!VmmProcessTable_Find(pt, pProcess->dwPID, &i)) { goto fail; }
+        i = pt->_iFLinkM[i];
     }
+    if(!i || !pt->_M[i - 1]) { goto fail; }
+    pProcessNew = (PVMM_PROCESS)Ob_INCREF(pt->_M[i - 1]);
+    Ob_DECREF(pProcess);
+    pProcess = pProcessNew;
+    if(pProcess && pProcess->dwState && !fShowTerminated) { goto restart; }
+    if(pProcess && fToken && !pProcess->win.TOKEN.fInitialized) { VmmProcess_TokenTryEnsureLock(pt, pProcess); }
+    return pProcess;
 fail:
     Ob_DECREF(pProcess);
     return NULL;
@@ -1076,6 +1617,16 @@ VOID VmmProcess_CloseObCallback(_In_ PVOID pVmmOb)
 VOID VmmProcessClone_CloseObCallback(_In_ PVOID pVmmOb)
 {
     PVMM_PROCESS pProcessClone = (PVMM_PROCESS)pVmmOb;
+    PVMM_PROCESS pParent = pProcessClone->pObProcessCloneParent;
+    // decref maps created by the clone itself (not shared with clone parent)
+    if(pParent) {
+        if(pProcessClone->Map.pObPte != pParent->Map.pObPte) { Ob_DECREF(pProcessClone->Map.pObPte); }
+        if(pProcessClone->Map.pObVad != pParent->Map.pObVad) { Ob_DECREF(pProcessClone->Map.pObVad); }
+        if(pProcessClone->Map.pObModule != pParent->Map.pObModule) { Ob_DECREF(pProcessClone->Map.pObModule); }
+        if(pProcessClone->Map.pObHeap != pParent->Map.pObHeap) { Ob_DECREF(pProcessClone->Map.pObHeap); }
+        if(pProcessClone->Map.pObThread != pParent->Map.pObThread) { Ob_DECREF(pProcessClone->Map.pObThread); }
+        if(pProcessClone->Map.pObHandle != pParent->Map.pObHandle) { Ob_DECREF(pProcessClone->Map.pObHandle); }
+    }
     // decref clone parent
     Ob_DECREF(pProcessClone->pObProcessCloneParent);
     // delete lock
@@ -1085,28 +1636,6 @@ VOID VmmProcessClone_CloseObCallback(_In_ PVOID pVmmOb)
     DeleteCriticalSection(&pProcessClone->Map.LockUpdateExtendedInfo);
 }
 
-/*
-* Object manager callback before 'process table' object cleanup - decrease
-* refcount of all contained 'process' objects.
-*/
-VOID VmmProcessTable_CloseObCallback(_In_ PVOID pVmmOb)
-{
-    PVMMOB_PROCESS_TABLE pt = (PVMMOB_PROCESS_TABLE)pVmmOb;
-    PVMM_PROCESS pProcess;
-    WORD iProcess;
-    // Close NewPROC
-    Ob_DECREF_NULL(&pt->pObCNewPROC);
-    // DECREF all pProcess in table
-    iProcess = pt->_iFLink;
-    pProcess = pt->_M[iProcess];
-    while(pProcess) {
-        Ob_DECREF(pProcess);
-        iProcess = pt->_iFLinkM[iProcess];
-        pProcess = pt->_M[iProcess];
-        if(!pProcess || iProcess == pt->_iFLink) { break; }
-    }
-}
-
 /*
 * Clone an original process entry creating a shallow clone. The user of this
 * shallow clone may use it to set the fUserOnly flag to FALSE on an otherwise
@@ -1132,6 +1661,66 @@ PVMM_PROCESS VmmProcessClone(_In_ PVMM_PROCESS pProcess)
     return pObProcessClone;
 }
 
+/*
+* Retrieve a kernel-memory clone (fUserOnly = FALSE) of a process. Clones are
+* cached per PID and re-used as long as the clone parent remains the process
+* object in the process table - making repeated retrievals a refcount increase.
+* Stale clones are removed from the cache on process table refresh.
+* CALLER DECREF: return
+* -- pProcess
+* -- return
+*/
+PVMM_PROCESS VmmProcessCloneKernel(_In_ PVMM_PROCESS pProcess)
+{
+    QWORD tmStart;
+    PVMM_PROCESS pObProcessClone;
+    if((pObProcessClone = ObMap_GetByKey(ctxVmm->Cache.pmProcessClone, pProcess->dwPID))) {
+        if(pObProcessClone->pObProcessCloneParent == pProcess) {
+            // clone may have been taken before the parent token was resolved -
+            // refresh token from parent (szSID is owned by the parent which is
+            // kept alive by the clone). fInitialized is set last for lock-free readers.
+            if(pProcess->win.TOKEN.fInitialized && !pObProcessClone->win.TOKEN.fInitialized) {
+                EnterCriticalSection(&ctxVmm->LockMaster);
+                if(!pObProcessClone->win.TOKEN.fInitialized) {
+                    memcpy(&pObProcessClone->win.TOKEN.fSID, &pProcess->win.TOKEN.fSID, sizeof(pProcess->win.TOKEN) - sizeof(BOOL));
+                    MemoryBarrier();
+                    pObProcessClone->win.TOKEN.fInitialized = TRUE;
+                }
+                LeaveCriticalSection(&ctxVmm->LockMaster);
+            }
+            InterlockedIncrement64(&ctxVmm->stat.cProcessCloneCacheHit);
+            return pObProcessClone;
+        }
+        Ob_DECREF_NULL(&pObProcessClone);
+    }
+    tmStart = Statistics_CallStart();
+    InterlockedIncrement64(&ctxVmm->stat.cProcessCloneCacheMiss);
+    if((pObProcessClone = VmmProcessClone(pProcess))) {
+        pObProcessClone->fUserOnly = FALSE;
+        EnterCriticalSection(&ctxVmm->LockUpdateMap);
+        Ob_DECREF(ObMap_RemoveByKey(ctxVmm->Cache.pmProcessClone, pProcess->dwPID));
+        ObMap_Push(ctxVmm->Cache.pmProcessClone, pProcess->dwPID, pObProcessClone);
+        LeaveCriticalSection(&ctxVmm->LockUpdateMap);
+    }
+    Statistics_CallEnd(STATISTICS_ID_VMM_ProcessCloneKernel, tmStart);
+    return pObProcessClone;
+}
+
+/*
+* ObMap filter function: remove cached kernel-memory process clones whose
+* clone parent is no longer the process object in the active process table.
+*/
+BOOL VmmProcessCloneKernel_FilterStale(_In_ QWORD k, _In_ PVOID v)
+{
+    BOOL fStale;
+    DWORD i;
+    PVMMOB_PROCESS_TABLE pObTable;
+    pObTable = (PVMMOB_PROCESS_TABLE)ObContainer_GetOb(ctxVmm->pObCPROC);
+    fStale = !pObTable || !VmmProcessTable_Find(pObTable, (DWORD)k, &i) || (pObTable->_M[i] != ((PVMM_PROCESS)v)->pObProcessCloneParent);
+    Ob_DECREF(pObTable);
+    return fStale;
+}
+
 /*
 * Create a new process object. New process object are created in a separate
 * data structure and won't become visible to the "Process" functions until
@@ -1153,7 +1742,6 @@ PVMM_PROCESS VmmProcessClone(_In_ PVMM_PROCESS pProcess)
 PVMM_PROCESS VmmProcessCreateEntry(_In_ BOOL fTotalRefresh, _In_ DWORD dwPID, _In_ DWORD dwPPID, _In_ DWORD dwState, _In_ QWORD paDTB, _In_ QWORD paDTB_UserOpt, _In_ CHAR szName[16], _In_ BOOL fUserOnly, _In_reads_opt_(cbEPROCESS) PBYTE pbEPROCESS, _In_ DWORD cbEPROCESS)
 {
     PVMMOB_PROCESS_TABLE ptOld = NULL, ptNew = NULL;
-    QWORD i, iStart, cEmpty = 0, cValid = 0;
     PVMM_PROCESS pProcess = NULL, pProcessOld = NULL;
     PVMMOB_CACHE_MEM pObDTB = NULL;
     BOOL result;
@@ -1170,9 +1758,8 @@ PVMM_PROCESS VmmProcessCreateEntry(_In_ BOOL fTotalRefresh, _In_ DWORD dwPID, _I
     if(!ptOld) { goto fail; }
     ptNew = (PVMMOB_PROCESS_TABLE)ObContainer_GetOb(ptOld->pObCNewPROC);
     if(!ptNew) {
-        ptNew = (PVMMOB_PROCESS_TABLE)Ob_Alloc(OB_TAG_VMM_PROCESSTABLE, LMEM_ZEROINIT, sizeof(VMMOB_PROCESS_TABLE), VmmProcessTable_CloseObCallback, NULL);
+        ptNew = VmmProcessTable_New();
         if(!ptNew) { goto fail; }
-        ptNew->pObCNewPROC = ObContainer_New(NULL);
         ObContainer_SetOb(ptOld->pObCNewPROC, ptNew);
     }
     // 3: Sanity check - process to create not already in 'new' table.
@@ -1216,21 +1803,11 @@ PVMM_PROCESS VmmProcessCreateEntry(_In_ BOOL fTotalRefresh, _In_ DWORD dwPID, _I
         pProcessOld = NULL;
     }
     // 5: Install new PID
-    i = iStart = dwPID % VMM_PROCESSTABLE_ENTRIES_MAX;
-    while(TRUE) {
-        if(!ptNew->_M[i]) {
-            ptNew->_M[i] = pProcess;
-            ptNew->_iFLinkM[i] = ptNew->_iFLink;
-            ptNew->_iFLink = (WORD)i;
-            ptNew->c++;
-            ptNew->cActive += (pProcess->dwState == 0) ? 1 : 0;
-            Ob_DECREF(ptOld);
-            Ob_DECREF(ptNew);
-            // pProcess already "consumed" by table insertion so increase before returning ... 
-            return (PVMM_PROCESS)Ob_INCREF(pProcess);
-        }
-        if(++i == VMM_PROCESSTABLE_ENTRIES_MAX) { i = 0; }
-        if(i == iStart) { goto fail; }
+    if(VmmProcessTable_Insert(ptNew, pProcess)) {
+        Ob_DECREF(ptOld);
+        Ob_DECREF(ptNew);
+        // pProcess already "consumed" by table insertion so increase before returning ... 
+        return (PVMM_PROCESS)Ob_INCREF(pProcess);
     }
 fail:
     Ob_DECREF(pProcess);
@@ -1253,10 +1830,20 @@ VOID VmmProcessCreateFinish()
         Ob_DECREF(ptOld);
         return;
     }
+    // Apply terminated process retention policy before the table is published.
+    if(ptNew->c - ptNew->cActive > VMM_PROCESSTABLE_TERMINATED_MAX) {
+        VmmProcessTable_Rebuild(ptNew, ptNew->cSlot, VMM_PROCESSTABLE_TERMINATED_MAX);
+    }
     // Replace "existing" old process table with new.
     ObContainer_SetOb(ctxVmm->pObCPROC, ptNew);
     Ob_DECREF(ptNew);
     Ob_DECREF(ptOld);
+    // Remove kernel-memory process clones of no longer active process objects.
+    ObMap_RemoveByFilter(ctxVmm->Cache.pmProcessClone, VmmProcessCloneKernel_FilterStale);
+    // Resolve tokens of new processes in the background if tokens are in use.
+    if(VmmProcess_TokenIsResolveAsync()) {
+        VmmWork(VmmProcess_TokenTryEnsureAsync_ThreadProc, NULL, 0);
+    }
 }
 
 /*
@@ -1265,16 +1852,12 @@ VOID VmmProcessCreateFinish()
 VOID VmmProcessTlbClear()
 {
     PVMMOB_PROCESS_TABLE pt = (PVMMOB_PROCESS_TABLE)ObContainer_GetOb(ctxVmm->pObCPROC);
-    PVMM_PROCESS pProcess;
-    WORD iProcess;
+    DWORD iM;
     if(!pt) { return; }
-    iProcess = pt->_iFLink;
-    pProcess = pt->_M[iProcess];
-    while(pProcess) {
-        pProcess->fTlbSpiderDone = FALSE;
-        iProcess = pt->_iFLinkM[iProcess];
-        pProcess = pt->_M[iProcess];
-        if(!pProcess || iProcess == pt->_iFLink) { break; }
+    iM = pt->_iFLink;
+    while(iM) {
+        pt->_M[iM - 1]->fTlbSpiderDone = FALSE;
+        iM = pt->_iFLinkM[iM - 1];
     }
     Ob_DECREF(pt);
 }
@@ -1290,8 +1873,7 @@ VOID VmmProcessListPIDs(_Out_writes_opt_(*pcPIDs) PDWORD pPIDs, _Inout_ PSIZE_T
     PVMMOB_PROCESS_TABLE pt = (PVMMOB_PROCESS_TABLE)ObContainer_GetOb(ctxVmm->pObCPROC);
     BOOL fShowTerminated = ((flags | ctxVmm->flags) & VMM_FLAG_PROCESS_SHOW_TERMINATED);
     PVMM_PROCESS pProcess;
-    WORD iProcess;
-    DWORD i = 0;
+    DWORD i = 0, iM;
     if(!pPIDs) {
         *pcPIDs = fShowTerminated ? pt->c : pt->cActive;
         Ob_DECREF(pt);
@@ -1303,16 +1885,14 @@ VOID VmmProcessListPIDs(_Out_writes_opt_(*pcPIDs) PDWORD pPIDs, _Inout_ PSIZE_T
         return;
     }
     // copy all PIDs
-    iProcess = pt->_iFLink;
-    pProcess = pt->_M[iProcess];
-    while(pProcess) {
+    iM = pt->_iFLink;
+    while(iM) {
+        pProcess = pt->_M[iM - 1];
         if(!pProcess->dwState || fShowTerminated) {
             *(pPIDs + i) = pProcess->dwPID;
             i++;
         }
-        iProcess = pt->_iFLinkM[iProcess];
-        pProcess = pt->_M[iProcess];
-        if(!pProcess || (iProcess == pt->_iFLink)) { break; }
+        iM = pt->_iFLinkM[iM - 1];
     }
     *pcPIDs = i;
     Ob_DECREF(pt);
@@ -1323,9 +1903,8 @@ VOID VmmProcessListPIDs(_Out_writes_opt_(*pcPIDs) PDWORD pPIDs, _Inout_ PSIZE_T
 */
 BOOL VmmProcessTableCreateInitial()
 {
-    PVMMOB_PROCESS_TABLE pt = (PVMMOB_PROCESS_TABLE)Ob_Alloc(OB_TAG_VMM_PROCESSTABLE, LMEM_ZEROINIT, sizeof(VMMOB_PROCESS_TABLE), VmmProcessTable_CloseObCallback, NULL);
+    PVMMOB_PROCESS_TABLE pt = VmmProcessTable_New();
     if(!pt) { return FALSE; }
-    pt->pObCNewPROC = ObContainer_New(NULL);
     ctxVmm->pObCPROC = ObContainer_New(pt);
     Ob_DECREF(pt);
     return TRUE;
@@ -1348,9 +1927,14 @@ typedef struct tdVMMWORK_THREAD_CONTEXT {
     HANDLE hThread;
 } VMMWORK_THREAD_CONTEXT, *PVMMWORK_THREAD_CONTEXT;
 
+// set on threads of the 'Work' thread pool - used to avoid nested blocking
+// waits on the pool from within work items (which may deadlock the pool).
+__declspec(thread) BOOL g_fVmmWorkThread = FALSE;
+
 DWORD VmmWork_MainWorkerLoop_ThreadProc(PVMMWORK_THREAD_CONTEXT ctx)
 {
     PVMMWORK_UNIT pu;
+    g_fVmmWorkThread = TRUE;
     while(ctxVmm->Work.fEnabled) {
         if((pu = (PVMMWORK_UNIT)ObSet_Pop(ctxVmm->Work.psUnit))) {
             pu->pfn(pu->ctx);
@@ -1424,6 +2008,50 @@ VOID VmmWork(_In_ LPTHREAD_START_ROUTINE pfn, _In_opt_ PVOID ctx, _In_opt_ HANDL
     }
 }
 
+BOOL VmmWorkIsWorkerThread()
+{
+    return g_fVmmWorkThread;
+}
+
+typedef struct tdVMMWORK_PARALLEL_FOREACH {
+    HANDLE hEventFinish;
+    PVOID ctx;
+    VOID(*pfn)(_In_opt_ PVOID ctx, _In_ DWORD i);
+    DWORD cRemainingWork;       // set to item count on entry and decremented as-goes - when zero FinishEvent is set.
+    DWORD iWork;                // set to item count on entry and decremented as-goes
+} VMMWORK_PARALLEL_FOREACH, *PVMMWORK_PARALLEL_FOREACH;
+
+DWORD VmmWorkParallelForeach_ThreadProc(_In_ PVMMWORK_PARALLEL_FOREACH p)
+{
+    p->pfn(p->ctx, InterlockedDecrement(&p->iWork));
+    if(0 == InterlockedDecrement(&p->cRemainingWork)) {
+        SetEvent(p->hEventFinish);
+    }
+    return 1;
+}
+
+VOID VmmWorkParallelForeach(_In_ DWORD c, _In_opt_ PVOID ctx, _In_ VOID(*pfn)(_In_opt_ PVOID ctx, _In_ DWORD i))
+{
+    DWORD i;
+    VMMWORK_PARALLEL_FOREACH p = { 0 };
+    if(!c) { return; }
+    if(!ctxVmm->Work.fEnabled || VmmWorkIsWorkerThread() || (c == 1) || !(p.hEventFinish = CreateEvent(NULL, TRUE, FALSE, NULL))) {
+        for(i = 0; i < c; i++) {
+            pfn(ctx, i);
+        }
+        return;
+    }
+    p.ctx = ctx;
+    p.pfn = pfn;
+    p.cRemainingWork = c;
+    p.iWork = c;
+    for(i = 0; i < c; i++) {
+        VmmWork((LPTHREAD_START_ROUTINE)VmmWorkParallelForeach_ThreadProc, &p, NULL);
+    }
+    WaitForSingleObject(p.hEventFinish, INFINITE);
+    CloseHandle(p.hEventFinish);
+}
+
 VOID VmmWorkWaitMultiple(_In_opt_ PVOID ctx, _In_ DWORD cWork, ...)
 {
     DWORD i;
@@ -1449,25 +2077,18 @@ VOID VmmWorkWaitMultiple(_In_opt_ PVOID ctx, _In_ DWORD cWork, ...)
 // ----------------------------------------------------------------------------
 
 typedef struct tdVMM_PROCESS_ACTION_FOREACH {
-    HANDLE hEventFinish;
     VOID(*pfnAction)(_In_ PVMM_PROCESS pProcess, _In_ PVOID ctx);
     PVOID ctxAction;
-    DWORD cRemainingWork;       // set to dwPIDs count on entry and decremented as-goes - when zero FinishEvent is set.
-    DWORD iPID;                 // set to dwPIDs count on entry and decremented as-goes
     DWORD dwPIDs[];
 } VMM_PROCESS_ACTION_FOREACH, *PVMM_PROCESS_ACTION_FOREACH;
 
-DWORD VmmProcessActionForeachParallel_ThreadProc(PVMM_PROCESS_ACTION_FOREACH ctx)
+VOID VmmProcessActionForeachParallel_DoWork(_In_ PVMM_PROCESS_ACTION_FOREACH ctx, _In_ DWORD i)
 {
-    PVMM_PROCESS pObProcess = VmmProcessGet(ctx->dwPIDs[InterlockedDecrement(&ctx->iPID)]);
+    PVMM_PROCESS pObProcess = VmmProcessGet(ctx->dwPIDs[i]);
     if(pObProcess) {
         ctx->pfnAction(pObProcess, ctx->ctxAction);
         Ob_DECREF(pObProcess);
     }
-    if(0 == InterlockedDecrement(&ctx->cRemainingWork)) {
-        SetEvent(ctx->hEventFinish);
-    }
-    return 1;
 }
 
 BOOL VmmProcessActionForeachParallel_CriteriaActiveOnly(_In_ PVMM_PROCESS pProcess, _In_opt_ PVOID ctx)
@@ -1491,28 +2112,16 @@ VOID VmmProcessActionForeachParallel(_In_opt_ PVOID ctxAction, _In_opt_ BOOL(*pf
     if(!(cProcess = ObSet_Size(pObProcessSelectedSet))) { goto fail; }
     // 2: set up context for worker function
     if(!(ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(VMM_PROCESS_ACTION_FOREACH) + cProcess * sizeof(DWORD)))) { goto fail; }
-    if(!(ctx->hEventFinish = CreateEvent(NULL, TRUE, FALSE, NULL))) { goto fail; }
     ctx->pfnAction = pfnAction;
     ctx->ctxAction = ctxAction;
-    ctx->cRemainingWork = cProcess;
-    ctx->iPID = cProcess;
     for(i = 0; i < cProcess; i++) {
         ctx->dwPIDs[i] = (DWORD)ObSet_Pop(pObProcessSelectedSet);
     }
     // 3: parallelize onto worker threads and wait for completion
-    for(i = 0; i < cProcess; i++) {
-        VmmWork(VmmProcessActionForeachParallel_ThreadProc, ctx, NULL);
-    }
-    WaitForSingleObject(ctx->hEventFinish, INFINITE);
-    BOOL DEBUG = ctxVmm->f32;
+    VmmWorkParallelForeach(cProcess, ctx, (VOID(*)(PVOID, DWORD))VmmProcessActionForeachParallel_DoWork);
 fail:
     Ob_DECREF(pObProcessSelectedSet);
-    if(ctx) {
-        if(ctx->hEventFinish) {
-            CloseHandle(ctx->hEventFinish);
-        }
-        LocalFree(ctx);
-    }
+    LocalFree(ctx);
 }
 
 // ----------------------------------------------------------------------------
@@ -1560,6 +2169,212 @@ VOID VmmWriteScatterVirtual(_In_ PVMM_PROCESS pProcess, _Inout_ PPMEM_SCATTER pp
     }
 }
 
+// ----------------------------------------------------------------------------
+// DEVICE I/O SCHEDULER FUNCTIONALITY:
+// Physical device reads are submitted through VmmIoScheduler_ReadScatter. If
+// the device is idle small requests are read directly by the caller. Bulk
+// requests and requests arriving while the device is busy are queued and
+// merged by the dispatcher thread into one device call of at most
+// VMM_IOSCHED_BATCH_MAX MEMs as soon as the device is idle again - i.e. the
+// merge window is the duration of the device call in progress. Latency
+// sensitive (small) requests are dispatched before bulk requests, but bulk
+// requests are always guaranteed one chunk per device call to avoid
+// starvation. If no small requests are queued bulk requests fill the whole
+// device call - i.e. a lone bulk request of up to VMM_IOSCHED_BATCH_MAX MEMs
+// is dispatched whole in one device call.
+// ----------------------------------------------------------------------------
+
+/*
+* Read from the memory acquisition device - the LeechCore device or, if opened
+* instead of a LeechCore device, the compressed memory image.
+*/
+VOID VmmIoScheduler_DeviceReadScatter(_In_ DWORD cMEMs, _Inout_ PPMEM_SCATTER ppMEMs)
+{
+    if(ctxMain->hPmemz) {
+        VmmPmemz_ReadScatter(ctxMain->hPmemz, cMEMs, ppMEMs);
+    } else {
+        LcReadScatter(ctxMain->hLC, cMEMs, ppMEMs);
+    }
+}
+
+_Success_(return)
+BOOL VmmReadDevice(_In_ QWORD pa, _In_ DWORD cb, _Out_writes_(cb) PBYTE pb)
+{
+    if(ctxMain->hPmemz) {
+        return VmmPmemz_Read(ctxMain->hPmemz, pa, cb, pb);
+    }
+    return LcRead(ctxMain->hLC, pa, cb, pb);
+}
+
+/*
+* Append a request to the tail of a scheduler queue. CALLER MUST HOLD LockSRW.
+*/
+VOID VmmIoScheduler_QueuePush(_In_ DWORD iQ, _In_ PVMM_IOSCHED_REQUEST pr)
+{
+    pr->FLink = NULL;
+    if(ctxVmm->IoSched.pTail[iQ]) {
+        ctxVmm->IoSched.pTail[iQ]->FLink = pr;
+    } else {
+        ctxVmm->IoSched.pHead[iQ] = pr;
+    }
+    ctxVmm->IoSched.pTail[iQ] = pr;
+}
+
+/*
+* Remove the request at the head of a scheduler queue. CALLER MUST HOLD LockSRW.
+*/
+PVMM_IOSCHED_REQUEST VmmIoScheduler_QueuePop(_In_ DWORD iQ)
+{
+    PVMM_IOSCHED_REQUEST pr = ctxVmm->IoSched.pHead[iQ];
+    if(pr) {
+        ctxVmm->IoSched.pHead[iQ] = pr->FLink;
+        if(!pr->FLink) { ctxVmm->IoSched.pTail[iQ] = NULL; }
+    }
+    return pr;
+}
+
+/*
+* Add MEMs of a request to the dispatcher batch. CALLER MUST HOLD LockSRW.
+*/
+VOID VmmIoScheduler_RoundAdd(_In_ PVMM_IOSCHED_REQUEST pr, _In_ DWORD cMEMs, _Inout_ PDWORD pc, _Inout_ PVMM_IOSCHED_REQUEST *ppRound)
+{
+    memcpy(ctxVmm->IoSched.ppMEMs + *pc, pr->ppMEMs + pr->iMEM, cMEMs * sizeof(PMEM_SCATTER));
+    *pc += cMEMs;
+    pr->iMEM += cMEMs;
+    pr->cMEMsRound += cMEMs;
+    if(!pr->fRound) {
+        pr->fRound = TRUE;
+        pr->FLinkRound = *ppRound;
+        *ppRound = pr;
+    }
+}
+
+/*
+* Dispatcher thread of the device i/o scheduler.
+*/
+DWORD VmmIoScheduler_ThreadProc(_In_ LPVOID lpv)
+{
+    DWORD c, cChunk, cPriorityMax;
+    PVMM_IOSCHED_REQUEST pr, pRound;
+    AcquireSRWLockExclusive(&ctxVmm->IoSched.LockSRW);
+    while(TRUE) {
+        while((!ctxVmm->IoSched.pHead[0] && !ctxVmm->IoSched.pHead[1] && ctxVmm->IoSched.fEnabled) || ((ctxVmm->IoSched.pHead[0] || ctxVmm->IoSched.pHead[1]) && ctxVmm->IoSched.fDeviceBusy)) {
+            SleepConditionVariableSRW(&ctxVmm->IoSched.cvSubmit, &ctxVmm->IoSched.LockSRW, INFINITE, 0);
+        }
+        if(!ctxVmm->IoSched.pHead[0] && !ctxVmm->IoSched.pHead[1]) { break; }
+        // 1: build batch - latency sensitive requests first (whole requests)
+        //    while reserving one chunk for bulk requests (if any).
+        c = 0;
+        pRound = NULL;
+        cPriorityMax = VMM_IOSCHED_BATCH_MAX - (ctxVmm->IoSched.pHead[1] ? VMM_IOSCHED_CHUNK : 0);
+        while((pr = ctxVmm->IoSched.pHead[0]) && (c + pr->cMEMs <= cPriorityMax)) {
+            VmmIoScheduler_QueuePop(0);
+            VmmIoScheduler_RoundAdd(pr, pr->cMEMs, &c, &pRound);
+        }
+        // 2: fill batch with bulk requests round-robin - one chunk at a time.
+        while((c < VMM_IOSCHED_BATCH_MAX) && (pr = VmmIoScheduler_QueuePop(1))) {
+            cChunk = min(min(VMM_IOSCHED_CHUNK, VMM_IOSCHED_BATCH_MAX - c), pr->cMEMs - pr->iMEM);
+            VmmIoScheduler_RoundAdd(pr, cChunk, &c, &pRound);
+            if(pr->iMEM < pr->cMEMs) {
+                VmmIoScheduler_QueuePush(1, pr);
+            }
+        }
+        // 3: dispatch to device
+        ctxVmm->IoSched.fDeviceBusy = TRUE;
+        ReleaseSRWLockExclusive(&ctxVmm->IoSched.LockSRW);
+        VmmIoScheduler_DeviceReadScatter(c, ctxVmm->IoSched.ppMEMs);
+        InterlockedIncrement64(&ctxVmm->stat.iosched.cDeviceCall);
+        InterlockedAdd64(&ctxVmm->stat.iosched.cDeviceCallMEMs, c);
+        AcquireSRWLockExclusive(&ctxVmm->IoSched.LockSRW);
+        ctxVmm->IoSched.fDeviceBusy = FALSE;
+        // 4: complete requests
+        while((pr = pRound)) {
+            pRound = pr->FLinkRound;
+            pr->fRound = FALSE;
+            pr->cMEMsDone += pr->cMEMsRound;
+            pr->cMEMsRound = 0;
+            pr->fComplete = (pr->cMEMsDone == pr->cMEMs);
+        }
+        WakeAllConditionVariable(&ctxVmm->IoSched.cvComplete);
+    }
+    ReleaseSRWLockExclusive(&ctxVmm->IoSched.LockSRW);
+    return 1;
+}
+
+VOID VmmIoScheduler_ReadScatter(_In_ DWORD cMEMs, _Inout_updates_(cMEMs) PPMEM_SCATTER ppMEMs)
+{
+    DWORD i;
+    QWORD tmStart, tmEnd, qwLatencyUs;
+    VMM_IOSCHED_REQUEST req = { 0 };
+    if(!cMEMs) { return; }
+    if(!ctxVmm->IoSched.fEnabled || (GetCurrentThreadId() == ctxVmm->IoSched.dwThreadId)) {
+        VmmIoScheduler_DeviceReadScatter(cMEMs, ppMEMs);
+        return;
+    }
+    QueryPerformanceCounter((PLARGE_INTEGER)&tmStart);
+    AcquireSRWLockExclusive(&ctxVmm->IoSched.LockSRW);
+    if(!ctxVmm->IoSched.fEnabled || ((cMEMs <= VMM_IOSCHED_PRIORITY_MAX) && !ctxVmm->IoSched.fDeviceBusy && !ctxVmm->IoSched.pHead[0] && !ctxVmm->IoSched.pHead[1])) {
+        // small request on uncontended device -> read directly. bulk requests
+        // are always queued so that they are dispatched in chunks and small
+        // requests arriving meanwhile don't have to wait for the whole read.
+        ctxVmm->IoSched.fDeviceBusy = TRUE;
+        ReleaseSRWLockExclusive(&ctxVmm->IoSched.LockSRW);
+        VmmIoScheduler_DeviceReadScatter(cMEMs, ppMEMs);
+        InterlockedIncrement64(&ctxVmm->stat.iosched.cDeviceCall);
+        InterlockedAdd64(&ctxVmm->stat.iosched.cDeviceCallMEMs, cMEMs);
+        AcquireSRWLockExclusive(&ctxVmm->IoSched.LockSRW);
+        ctxVmm->IoSched.fDeviceBusy = FALSE;
+        WakeConditionVariable(&ctxVmm->IoSched.cvSubmit);
+    } else {
+        // busy device or bulk request -> queue request for the dispatcher
+        req.ppMEMs = ppMEMs;
+        req.cMEMs = cMEMs;
+        VmmIoScheduler_QueuePush((cMEMs <= VMM_IOSCHED_PRIORITY_MAX) ? 0 : 1, &req);
+        WakeConditionVariable(&ctxVmm->IoSched.cvSubmit);
+        while(!req.fComplete) {
+            SleepConditionVariableSRW(&ctxVmm->IoSched.cvComplete, &ctxVmm->IoSched.LockSRW, INFINITE, 0);
+        }
+        InterlockedIncrement64(&ctxVmm->stat.iosched.cRequestQueued);
+    }
+    ReleaseSRWLockExclusive(&ctxVmm->IoSched.LockSRW);
+    // statistics: request latency histogram
+    QueryPerformanceCounter((PLARGE_INTEGER)&tmEnd);
+    qwLatencyUs = ctxVmm->IoSched.qwFrequency ? ((tmEnd - tmStart) * 1000000 / ctxVmm->IoSched.qwFrequency) : 0;
+    for(i = 0; (i < VMM_IOSCHED_LATENCY_BUCKETS - 1) && (qwLatencyUs >> i); i++);
+    InterlockedIncrement64(&ctxVmm->stat.iosched.cLatencyLog2[i]);
+    InterlockedIncrement64(&ctxVmm->stat.iosched.cRequest);
+}
+
+VOID VmmIoScheduler_Initialize()
+{
+    InitializeSRWLock(&ctxVmm->IoSched.LockSRW);
+    InitializeConditionVariable(&ctxVmm->IoSched.cvSubmit);
+    InitializeConditionVariable(&ctxVmm->IoSched.cvComplete);
+    QueryPerformanceFrequency((PLARGE_INTEGER)&ctxVmm->IoSched.qwFrequency);
+    if(!(ctxVmm->IoSched.ppMEMs = LocalAlloc(0, VMM_IOSCHED_BATCH_MAX * sizeof(PMEM_SCATTER)))) { return; }
+    ctxVmm->IoSched.fEnabled = TRUE;
+    ctxVmm->IoSched.hThread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)VmmIoScheduler_ThreadProc, NULL, 0, &ctxVmm->IoSched.dwThreadId);
+    if(!ctxVmm->IoSched.hThread) {
+        ctxVmm->IoSched.fEnabled = FALSE;
+    }
+}
+
+VOID VmmIoScheduler_Close()
+{
+    if(ctxVmm->IoSched.hThread) {
+        AcquireSRWLockExclusive(&ctxVmm->IoSched.LockSRW);
+        ctxVmm->IoSched.fEnabled = FALSE;
+        WakeAllConditionVariable(&ctxVmm->IoSched.cvSubmit);
+        ReleaseSRWLockExclusive(&ctxVmm->IoSched.LockSRW);
+        WaitForSingleObject(ctxVmm->IoSched.hThread, INFINITE);
+        CloseHandle(ctxVmm->IoSched.hThread);
+        ctxVmm->IoSched.hThread = NULL;
+    }
+    ctxVmm->IoSched.fEnabled = FALSE;
+    LocalFree(ctxVmm->IoSched.ppMEMs);
+    ctxVmm->IoSched.ppMEMs = NULL;
+}
+
 VOID VmmReadScatterPhysical(_Inout_ PPMEM_SCATTER ppMEMsPhys, _In_ DWORD cpMEMsPhys, _In_ QWORD flags)
 {
     QWORD tp;   // 0 = normal, 1 = already read, 2 = cache hit, 3 = speculative read
@@ -1628,7 +2443,7 @@ VOID VmmReadScatterPhysical(_Inout_ PPMEM_SCATTER ppMEMsPhys, _In_ DWORD cpMEMsP
         cpMEMsPhys = cSpeculative;
     }
     // 3: read!
-    LcReadScatter(ctxMain->hLC, cpMEMsPhys, ppMEMsPhys);
+    VmmIoScheduler_ReadScatter(cpMEMsPhys, ppMEMsPhys);
     // 4: cache put
     if(fCache) {
         for(i = 0; i < cpMEMsPhys; i++) {
@@ -1674,24 +2489,37 @@ VOID VmmReadScatterVirtual(_In_ PVMM_PROCESS pProcess, _Inout_updates_(cpMEMsVir
     BOOL fVirt2Phys;
     DWORD i = 0, iVA, iPA;
     QWORD qwPA, qwPagedPA = 0;
-    BYTE pbBufferSmall[0x20 * (sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER))];
-    PBYTE pbBufferMEMs, pbBufferLarge = NULL;
+    BYTE pbBufferSmall[0x20 * (sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER) + sizeof(QWORD) + sizeof(BOOL))];
+    PBYTE pbBuffer, pbBufferMEMs, pbBufferLarge = NULL;
     PMEM_SCATTER pIoPA, pIoVA;
     PPMEM_SCATTER ppMEMsPhys = NULL;
+    PQWORD pqwBatchA = NULL;
+    PBOOL pfBatch = NULL;
     BOOL fPaging = !(VMM_FLAG_NOPAGING & (flags | ctxVmm->flags));
     BOOL fAltAddrPte = VMM_FLAG_ALTADDR_VA_PTE & flags;
     BOOL fZeropadOnFail = VMM_FLAG_ZEROPAD_ON_FAIL & (flags | ctxVmm->flags);
+    BOOL fBatch = !fAltAddrPte && (cpMEMsVirt > 1) && ctxVmm->fnMemoryModel.pfnVirt2PhysBatch;
     // 1: allocate / set up buffers (if needed)
     if(cpMEMsVirt < 0x20) {
         ZeroMemory(pbBufferSmall, sizeof(pbBufferSmall));
-        ppMEMsPhys = (PPMEM_SCATTER)pbBufferSmall;
-        pbBufferMEMs = pbBufferSmall + cpMEMsVirt * sizeof(PMEM_SCATTER);
+        pbBuffer = pbBufferSmall;
     } else {
-        if(!(pbBufferLarge = LocalAlloc(LMEM_ZEROINIT, cpMEMsVirt * (sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER))))) { return; }
-        ppMEMsPhys = (PPMEM_SCATTER)pbBufferLarge;
-        pbBufferMEMs = pbBufferLarge + cpMEMsVirt * sizeof(PMEM_SCATTER);
+        if(!(pbBufferLarge = LocalAlloc(LMEM_ZEROINIT, cpMEMsVirt * (sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER) + (fBatch ? (sizeof(QWORD) + sizeof(BOOL)) : 0))))) { return; }
+        pbBuffer = pbBufferLarge;
+    }
+    ppMEMsPhys = (PPMEM_SCATTER)pbBuffer;
+    pbBufferMEMs = pbBuffer + cpMEMsVirt * sizeof(PMEM_SCATTER);
+    // 2: translate virt2phys - batched translation (if supported by memory model)
+    if(fBatch) {
+        pqwBatchA = (PQWORD)pbBufferMEMs;
+        pbBufferMEMs += cpMEMsVirt * sizeof(QWORD);
+        pfBatch = (PBOOL)(pbBufferMEMs + cpMEMsVirt * sizeof(MEM_SCATTER));
+        for(iVA = 0; iVA < cpMEMsVirt; iVA++) {
+            pIoVA = ppMEMsVirt[iVA];
+            pqwBatchA[iVA] = (pIoVA->f || (pIoVA->qwA == -1)) ? 0 : pIoVA->qwA;
+        }
+        VmmVirt2PhysBatch(pProcess, cpMEMsVirt, pqwBatchA, pfBatch);
     }
-    // 2: translate virt2phys
     for(iVA = 0, iPA = 0; iVA < cpMEMsVirt; iVA++) {
         pIoVA = ppMEMsVirt[iVA];
         // MEMORY READ ALREADY COMPLETED
@@ -1702,8 +2530,13 @@ VOID VmmReadScatterVirtual(_In_ PVMM_PROCESS pProcess, _Inout_updates_(cpMEMsVir
             continue;
         }
         // PHYSICAL MEMORY
-        qwPA = 0;
-        fVirt2Phys = !fAltAddrPte && VmmVirt2Phys(pProcess, pIoVA->qwA, &qwPA);
+        if(fBatch) {
+            qwPA = pqwBatchA[iVA];
+            fVirt2Phys = pfBatch[iVA];
+        } else {
+            qwPA = 0;
+            fVirt2Phys = !fAltAddrPte && VmmVirt2Phys(pProcess, pIoVA->qwA, &qwPA);
+        }
         // PAGED MEMORY
         if(!fVirt2Phys && fPaging && (pIoVA->cb == 0x1000) && ctxVmm->fnMemoryModel.pfnPagedRead) {
             if(ctxVmm->fnMemoryModel.pfnPagedRead(pProcess, (fAltAddrPte ? 0 : pIoVA->qwA), (fAltAddrPte ? pIoVA->qwA : qwPA), pIoVA->pb, &qwPagedPA, NULL, flags)) {
@@ -1801,12 +2634,14 @@ VOID VmmClose()
     if(!ctxVmm) { return; }
     if(ctxVmm->PluginManager.FLinkAll) { PluginManager_Close(); }
     VmmWork_Close();
+    VmmIoScheduler_Close();
     VmmWinObj_Close();
     VmmWinReg_Close();
     VmmNet_Close();
     PDB_Close();
     Ob_DECREF_NULL(&ctxVmm->pObVfsDumpContext);
     Ob_DECREF_NULL(&ctxVmm->pObPfnContext);
+    Ob_DECREF_NULL(&ctxVmm->Cache.pmProcessClone);
     Ob_DECREF_NULL(&ctxVmm->pObCPROC);
     if(ctxVmm->fnMemoryModel.pfnClose) {
         ctxVmm->fnMemoryModel.pfnClose();
@@ -1817,10 +2652,16 @@ VOID VmmClose()
     VmmCacheClose(VMM_CACHE_TAG_PAGING);
     Ob_DECREF_NULL(&ctxVmm->Cache.PAGING_FAILED);
     Ob_DECREF_NULL(&ctxVmm->Cache.pmPrototypePte);
+    Ob_DECREF_NULL(&ctxVmm->Cache.pmMapText);
+    Ob_DECREF_NULL(&ctxVmm->OffsetCache.pm);
+    Ob_DECREF_NULL(&ctxVmm->UserCache.pmToken);
+    Ob_DECREF_NULL(&ctxVmm->UserCache.pmHive);
+    Ob_DECREF_NULL(&ctxVmm->UserCache.pmName);
     Ob_DECREF_NULL(&ctxVmm->pObCMapPhysMem);
     Ob_DECREF_NULL(&ctxVmm->pObCMapUser);
     Ob_DECREF_NULL(&ctxVmm->pObCMapNet);
     Ob_DECREF_NULL(&ctxVmm->pObCMapService);
+    Ob_DECREF_NULL(&ctxVmm->pObCMapPool);
     Ob_DECREF_NULL(&ctxVmm->pObCCachePrefetchEPROCESS);
     Ob_DECREF_NULL(&ctxVmm->pObCCachePrefetchRegistry);
     DeleteCriticalSection(&ctxVmm->LockMaster);
@@ -1878,6 +2719,106 @@ BOOL VmmWrite(_In_opt_ PVMM_PROCESS pProcess, _In_ QWORD qwA, _In_reads_(cb) PBY
     return (cbWrite == cb);
 }
 
+#define VMM_READEX_STREAM_THRESHOLD         0x01000000      // 16MB
+#define VMM_READEX_STREAM_CBWINDOW          0x00400000      // 4MB
+#define VMM_READEX_STREAM_INFLIGHT          2
+
+typedef struct tdVMM_READEX_STREAM_WINDOW {
+    HANDLE hEventFinish;
+    PVMM_PROCESS pProcess;
+    QWORD qwA;
+    PBYTE pb;
+    DWORD cb;
+    DWORD cbRead;
+    QWORD flags;
+} VMM_READEX_STREAM_WINDOW, *PVMM_READEX_STREAM_WINDOW;
+
+/*
+* Worker thread entry point: read a single window of a streaming read.
+* -- pw
+*/
+DWORD VmmReadEx_Stream_ThreadProc(_In_ PVMM_READEX_STREAM_WINDOW pw)
+{
+    VmmReadEx(pw->pProcess, pw->qwA, pw->pb, pw->cb, &pw->cbRead, pw->flags);
+    return 1;
+}
+
+/*
+* Read a large memory range as a sequence of bounded windows. A limited number
+* of windows are kept in flight on the worker thread pool at any given time so
+* that translation and device reads of the next window overlaps the current.
+* Each window reads directly into the caller buffer and per-page metadata is
+* bounded by the window size rather than by the total read size.
+* If called from a worker thread the windows are read sequentially on the
+* calling thread to avoid nested blocking waits on the worker thread pool.
+* -- pProcess
+* -- qwA
+* -- pb
+* -- cb
+* -- pcbReadOpt
+* -- flags
+* -- return = TRUE if the streaming read was performed, FALSE on setup fail.
+*/
+_Success_(return)
+BOOL VmmReadEx_Stream(_In_opt_ PVMM_PROCESS pProcess, _In_ QWORD qwA, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb, _Out_opt_ PDWORD pcbReadOpt, _In_ QWORD flags)
+{
+    BOOL fResult = FALSE;
+    DWORD i, iw = 0, cbRead = 0, cbWindow;
+    QWORD o = 0, tcStart = GetTickCount64(), tcTotal;
+    HANDLE hEvents[VMM_READEX_STREAM_INFLIGHT] = { 0 };
+    VMM_READEX_STREAM_WINDOW w[VMM_READEX_STREAM_INFLIGHT] = { 0 };
+    PVMM_READEX_STREAM_WINDOW pw;
+    if(VmmWorkIsWorkerThread()) {
+        while(o < cb) {
+            cbWindow = VMM_READEX_STREAM_CBWINDOW - (DWORD)((qwA + o) & (VMM_READEX_STREAM_CBWINDOW - 1));
+            cbWindow = (DWORD)min(cbWindow, cb - o);
+            VmmReadEx(pProcess, qwA + o, pb + o, cbWindow, &w[0].cbRead, flags);
+            cbRead += w[0].cbRead;
+            o += cbWindow;
+        }
+        if(pcbReadOpt) { *pcbReadOpt = cbRead; }
+        return TRUE;
+    }
+    for(i = 0; i < VMM_READEX_STREAM_INFLIGHT; i++) {
+        if(!(hEvents[i] = w[i].hEventFinish = CreateEvent(NULL, TRUE, TRUE, NULL))) { goto fail; }
+    }
+    while(o < cb) {
+        pw = &w[iw];
+        iw = (iw + 1) % VMM_READEX_STREAM_INFLIGHT;
+        WaitForSingleObject(pw->hEventFinish, INFINITE);
+        cbRead += pw->cbRead;
+        // window ends on a window-aligned address (except for the last window)
+        cbWindow = VMM_READEX_STREAM_CBWINDOW - (DWORD)((qwA + o) & (VMM_READEX_STREAM_CBWINDOW - 1));
+        cbWindow = (DWORD)min(cbWindow, cb - o);
+        pw->pProcess = pProcess;
+        pw->qwA = qwA + o;
+        pw->pb = pb + o;
+        pw->cb = cbWindow;
+        pw->cbRead = 0;
+        pw->flags = flags;
+        ResetEvent(pw->hEventFinish);
+        VmmWork((LPTHREAD_START_ROUTINE)VmmReadEx_Stream_ThreadProc, pw, pw->hEventFinish);
+        o += cbWindow;
+    }
+    WaitForMultipleObjects(VMM_READEX_STREAM_INFLIGHT, hEvents, TRUE, INFINITE);
+    for(i = 0; i < VMM_READEX_STREAM_INFLIGHT; i++) {
+        cbRead += w[i].cbRead;
+        w[i].cbRead = 0;
+    }
+    if(pcbReadOpt) { *pcbReadOpt = cbRead; }
+    tcTotal = max(1, GetTickCount64() - tcStart);
+    vmmprintfvv_fn("pid=%i va=%016llx cb=%08x cbRead=%08x time=%llims speed=%lliMB/s metadata=%i\n",
+        (pProcess ? pProcess->dwPID : 0), qwA, cb, cbRead, tcTotal,
+        (((QWORD)cb * 1000) / tcTotal) >> 20,
+        VMM_READEX_STREAM_INFLIGHT * (0x2000 + ((VMM_READEX_STREAM_CBWINDOW >> 12) + 1) * (DWORD)(sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER))));
+    fResult = TRUE;
+fail:
+    for(i = 0; i < VMM_READEX_STREAM_INFLIGHT; i++) {
+        if(hEvents[i]) { CloseHandle(hEvents[i]); }
+    }
+    return fResult;
+}
+
 VOID VmmReadEx(_In_opt_ PVMM_PROCESS pProcess, _In_ QWORD qwA, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb, _Out_opt_ PDWORD pcbReadOpt, _In_ QWORD flags)
 {
     DWORD cbP, cMEMs, cbRead = 0;
@@ -1886,6 +2827,9 @@ VOID VmmReadEx(_In_opt_ PVMM_PROCESS pProcess, _In_ QWORD qwA, _Out_writes_(cb)
     QWORD i, oA;
     if(pcbReadOpt) { *pcbReadOpt = 0; }
     if(!cb) { return; }
+    if((cb > VMM_READEX_STREAM_THRESHOLD) && ctxVmm->Work.fEnabled && VmmReadEx_Stream(pProcess, qwA, pb, cb, pcbReadOpt, flags)) {
+        return;
+    }
     cMEMs = (DWORD)(((qwA & 0xfff) + cb + 0xfff) >> 12);
     pbBuffer = (PBYTE)LocalAlloc(LMEM_ZEROINIT, 0x2000 + cMEMs * (sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER)));
     if(!pbBuffer) {
@@ -2077,6 +3021,8 @@ VOID VmmInitializeFunctions()
     HMODULE hNtDll = NULL;
     if((hNtDll = LoadLibraryA("ntdll.dll"))) {
         ctxVmm->fn.RtlDecompressBuffer = (VMMFN_RtlDecompressBuffer*)GetProcAddress(hNtDll, "RtlDecompressBuffer");
+        ctxVmm->fn.RtlCompressBuffer = (VMMFN_RtlCompressBuffer*)GetProcAddress(hNtDll, "RtlCompressBuffer");
+        ctxVmm->fn.RtlGetCompressionWorkSpaceSize = (VMMFN_RtlGetCompressionWorkSpaceSize*)GetProcAddress(hNtDll, "RtlGetCompressionWorkSpaceSize");
         FreeLibrary(hNtDll);
     }
 }
@@ -2102,13 +3048,24 @@ BOOL VmmInitialize()
     if(!(ctxVmm->Cache.PAGING_FAILED = ObSet_New())) { goto fail; }
     // 6: CACHE INIT: Prototype PTE Cache Map
     if(!(ctxVmm->Cache.pmPrototypePte = ObMap_New(OB_MAP_FLAGS_OBJECT_OB))) { goto fail; }
-    // 7: WORKER THREADS INIT:
+    // 7: CACHE INIT: Rendered Map Text Cache Map
+    if(!(ctxVmm->Cache.pmMapText = ObMap_New(OB_MAP_FLAGS_OBJECT_OB))) { goto fail; }
+    if(!(ctxVmm->Cache.pmProcessClone = ObMap_New(OB_MAP_FLAGS_OBJECT_OB))) { goto fail; }
+    // 8: CACHE INIT: Learned Offsets Cache Map
+    if(!(ctxVmm->OffsetCache.pm = ObMap_New(OB_MAP_FLAGS_OBJECT_LOCALFREE))) { goto fail; }
+    // 9: CACHE INIT: Token and User Cache Maps
+    if(!(ctxVmm->UserCache.pmToken = ObMap_New(OB_MAP_FLAGS_OBJECT_LOCALFREE))) { goto fail; }
+    if(!(ctxVmm->UserCache.pmHive = ObMap_New(OB_MAP_FLAGS_OBJECT_LOCALFREE))) { goto fail; }
+    if(!(ctxVmm->UserCache.pmName = ObMap_New(OB_MAP_FLAGS_OBJECT_LOCALFREE))) { goto fail; }
+    // 10: WORKER THREADS INIT:
     VmmWork_Initialize();
-    // 8: OTHER INIT:
+    VmmIoScheduler_Initialize();
+    // 11: OTHER INIT:
     ctxVmm->pObCMapPhysMem = ObContainer_New(NULL);
     ctxVmm->pObCMapUser = ObContainer_New(NULL);
     ctxVmm->pObCMapNet = ObContainer_New(NULL);
     ctxVmm->pObCMapService = ObContainer_New(NULL);
+    ctxVmm->pObCMapPool = ObContainer_New(NULL);
     ctxVmm->pObCCachePrefetchEPROCESS = ObContainer_New(NULL);
     ctxVmm->pObCCachePrefetchRegistry = ObContainer_New(NULL);
     InitializeCriticalSection(&ctxVmm->LockMaster);
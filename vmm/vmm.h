@@ -29,7 +29,9 @@ typedef unsigned __int64                QWORD, *PQWORD;
 #define VMM_STATUS_FILE_INVALID                 STATUS_FILE_INVALID
 #define VMM_STATUS_FILE_SYSTEM_LIMITATION       STATUS_FILE_SYSTEM_LIMITATION
 
-#define VMM_PROCESSTABLE_ENTRIES_MAX            0x4000
+#define VMM_PROCESSTABLE_SLOTS_INITIAL          0x400  // initial # of process table slots (power of two), table grows on demand
+#define VMM_PROCESSTABLE_PROBE_MAX              0x10   // max linear probe length in process table before growing it
+#define VMM_PROCESSTABLE_TERMINATED_MAX         0x1000 // max # of terminated processes retained (most recently listed kept)
 #define VMM_PROCESS_OS_ALLOC_PTR_MAX            0x4    // max number of operating system specific pointers that must be free'd
 #define VMM_MEMMAP_ENTRIES_MAX                  0x4000
 
@@ -48,6 +50,11 @@ typedef unsigned __int64                QWORD, *PQWORD;
 
 #define VMM_WORK_THREADPOOL_NUM_THREADS         0x20
 
+#define VMM_IOSCHED_BATCH_MAX                   0x1000      // max MEMs per scheduled device call (>= bulk read size)
+#define VMM_IOSCHED_CHUNK                       0x100       // max MEMs of a bulk request per round-robin turn
+#define VMM_IOSCHED_PRIORITY_MAX                0x10        // requests of at most this size are latency sensitive
+#define VMM_IOSCHED_LATENCY_BUCKETS             24
+
 #define VMM_FLAG_NOCACHE                        0x00000001  // do not use the data cache (force reading from memory acquisition device).
 #define VMM_FLAG_ZEROPAD_ON_FAIL                0x00000002  // zero pad failed physical memory reads and report success if read within range of physical memory.
 #define VMM_FLAG_PROCESS_SHOW_TERMINATED        0x00000004  // show terminated processes in the process list (if they can be found).
@@ -353,6 +360,13 @@ typedef struct tdVMM_MAP_PHYSMEMENTRY {
     QWORD cb;
 } VMM_MAP_PHYSMEMENTRY, *PVMM_MAP_PHYSMEMENTRY;
 
+typedef struct tdVMM_MAP_POOLENTRY {
+    QWORD va;
+    QWORD cb;
+    DWORD dwPoolTag;                // pool tag as stored in memory (compare with VMM_POOLTAG).
+    DWORD _Reserved;
+} VMM_MAP_POOLENTRY, *PVMM_MAP_POOLENTRY;
+
 typedef struct tdVMM_MAP_USERENTRY {
     PSID pSID;
     DWORD cbSID;
@@ -481,6 +495,32 @@ typedef struct tdVMMOB_MAP_SERVICE {
     VMM_MAP_SERVICEENTRY pMap[];    // map entries.
 } VMMOB_MAP_SERVICE, *PVMMOB_MAP_SERVICE;
 
+typedef struct tdVMMOB_MAP_POOL {
+    OB ObHdr;
+    PDWORD piTag;                   // pMap indexes sorted by pool tag (and address).
+    DWORD cMap;                     // # map entries.
+    VMM_MAP_POOLENTRY pMap[];       // map entries sorted by address.
+} VMMOB_MAP_POOL, *PVMMOB_MAP_POOL;
+
+typedef struct tdVMMOB_MAP_TEXT {
+    OB ObHdr;
+    POB pObMap;                     // referenced source map (cache key).
+    DWORD dwRenderId;
+    DWORD cszLineLength;
+    QWORD cb;                       // # bytes of rendered text (excl. terminating null).
+    BYTE pb[];                      // rendered text.
+} VMMOB_MAP_TEXT, *PVMMOB_MAP_TEXT;
+
+/*
+* Callback function rendering a single fixed-width line of a map text file.
+* The line must be exactly cszLineLength chars incl. newline, followed by null.
+* -- ctx = optional context as given to VmmMapText_Read.
+* -- iLine = index of line (map entry) to render.
+* -- szLine = buffer of size cszLineLength + 1.
+* -- cszLineLength
+*/
+typedef VOID(*VMM_MAPTEXT_PFN_RENDERLINE)(_In_opt_ PVOID ctx, _In_ DWORD iLine, _Out_writes_(cszLineLength + 1) LPSTR szLine, _In_ DWORD cszLineLength);
+
 typedef struct tdVMMWIN_USER_PROCESS_PARAMETERS {
     BOOL fProcessed;
     DWORD cwszImagePathName;
@@ -594,9 +634,10 @@ typedef struct tdVMMOB_PROCESS_TABLE {
     OB ObHdr;
     SIZE_T c;                       // Total # of processes in table
     SIZE_T cActive;                 // # of active processes (state = 0) in table
-    WORD _iFLink;
-    WORD _iFLinkM[VMM_PROCESSTABLE_ENTRIES_MAX];
-    PVMM_PROCESS _M[VMM_PROCESSTABLE_ENTRIES_MAX];
+    DWORD cSlot;                    // # of slots in _M and _iFLinkM (power of two)
+    DWORD _iFLink;                  // slot+1 of most recently inserted process (0 = empty)
+    PDWORD _iFLinkM;                // slot+1 of next process in list (0 = end of list)
+    PVMM_PROCESS *_M;
     POB_CONTAINER pObCNewPROC;      // contains VMM_PROCESS_TABLE
 } VMMOB_PROCESS_TABLE, *PVMMOB_PROCESS_TABLE;
 
@@ -655,6 +696,7 @@ typedef struct tdVMM_VIRT2PHYS_INFORMATION {
 typedef struct tdVMM_MEMORYMODEL_FUNCTIONS {
     VOID(*pfnClose)();
     BOOL(*pfnVirt2Phys)(_In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ BYTE iPML, _In_ QWORD va, _Out_ PQWORD ppa);
+    VOID(*pfnVirt2PhysBatch)(_In_ QWORD paDTB, _In_ BOOL fUserOnly, _In_ DWORD cva, _Inout_updates_(cva) PQWORD pqwA, _Out_writes_(cva) PBOOL pfResult);
     VOID(*pfnVirt2PhysVadEx)(_In_ QWORD paPT, _Inout_ PVMMOB_MAP_VADEX pVadEx, _In_ BYTE iPML, _Inout_ PDWORD piVadEx);
     VOID(*pfnVirt2PhysGetInformation)(_Inout_ PVMM_PROCESS pProcess, _Inout_ PVMM_VIRT2PHYS_INFORMATION pVirt2PhysInfo);
     VOID(*pfnPhys2VirtGetInformation)(_In_ PVMM_PROCESS pProcess, _Inout_ PVMMOB_PHYS2VIRT_INFORMATION pP2V);
@@ -686,6 +728,7 @@ typedef struct tdVmmConfig {
     CHAR szPageFile[10][MAX_PATH];
     CHAR szMemMap[MAX_PATH];
     CHAR szMemMapStr[2048];
+    CHAR szOffsetCache[MAX_PATH];
 } VMMCONFIG, *PVMMCONFIG;
 
 typedef struct tdVMM_STATISTICS {
@@ -715,8 +758,34 @@ typedef struct tdVMM_STATISTICS {
     QWORD cTlbRefreshCache;
     QWORD cProcessRefreshPartial;
     QWORD cProcessRefreshFull;
+    QWORD cProcessCloneCacheHit;
+    QWORD cProcessCloneCacheMiss;
+    QWORD cTokenResolve;
+    QWORD cTokenResolveRoundTrip;
+    QWORD cPoolIndexRefresh;
+    QWORD cPoolIndexLookup;
+    QWORD cPoolIndexReadSaved;
+    struct {
+        QWORD cRequest;
+        QWORD cRequestQueued;
+        QWORD cDeviceCall;
+        QWORD cDeviceCallMEMs;
+        QWORD cLatencyLog2[VMM_IOSCHED_LATENCY_BUCKETS];   // request latency: [i] = less than 2^i us
+    } iosched;
 } VMM_STATISTICS, *PVMM_STATISTICS;
 
+typedef struct tdVMM_IOSCHED_REQUEST {
+    struct tdVMM_IOSCHED_REQUEST *FLink;
+    struct tdVMM_IOSCHED_REQUEST *FLinkRound;   // dispatcher current round
+    PPMEM_SCATTER ppMEMs;
+    DWORD cMEMs;
+    DWORD iMEM;                                 // next MEM to dispatch
+    DWORD cMEMsRound;                           // MEMs in dispatcher current round
+    DWORD cMEMsDone;
+    BOOL fRound;
+    BOOL fComplete;
+} VMM_IOSCHED_REQUEST, *PVMM_IOSCHED_REQUEST;
+
 typedef struct tdVMM_OFFSET_EPROCESS {
     BOOL fValid;
     BOOL f64VistaOr7;
@@ -742,6 +811,7 @@ typedef struct tdVMM_OFFSET_EPROCESS {
         WORD TOKEN_TokenId;
         WORD TOKEN_SessionId;
         WORD TOKEN_UserAndGroups;
+        WORD TOKEN_ModifiedId;
         WORD KernelTime;
         WORD UserTime;
     } opt;
@@ -875,10 +945,29 @@ typedef NTSTATUS VMMFN_RtlDecompressBuffer(
     PULONG FinalUncompressedSize
 );
 
+typedef NTSTATUS VMMFN_RtlCompressBuffer(
+    USHORT CompressionFormatAndEngine,
+    PUCHAR UncompressedBuffer,
+    ULONG  UncompressedBufferSize,
+    PUCHAR CompressedBuffer,
+    ULONG  CompressedBufferSize,
+    ULONG  UncompressedChunkSize,
+    PULONG FinalCompressedSize,
+    PVOID  WorkSpace
+);
+
+typedef NTSTATUS VMMFN_RtlGetCompressionWorkSpaceSize(
+    USHORT CompressionFormatAndEngine,
+    PULONG CompressBufferWorkSpaceSize,
+    PULONG CompressFragmentWorkSpaceSize
+);
+
 typedef struct tdVMM_DYNAMIC_LOAD_FUNCTIONS {
     // functions below may be loaded on startup
     // NB! null checks are required before use!
     VMMFN_RtlDecompressBuffer *RtlDecompressBuffer;     // ntdll.dll!RtlDecompressBuffer
+    VMMFN_RtlCompressBuffer *RtlCompressBuffer;         // ntdll.dll!RtlCompressBuffer
+    VMMFN_RtlGetCompressionWorkSpaceSize *RtlGetCompressionWorkSpaceSize;   // ntdll.dll!RtlGetCompressionWorkSpaceSize
 } VMM_DYNAMIC_LOAD_FUNCTIONS;
 
 // OBJECT TYPE table exists on Win7+ It's initialized on first use and it will
@@ -912,6 +1001,7 @@ typedef struct tdVMM_CONTEXT {
     BOOL fThreadMapEnabled;         // Thread Map subsystem is enabled / available
     VMM_SYSTEM_TP tpSystem;
     DWORD flags;                    // VMM_FLAG_*
+    BOOL fTokenResolveAsync;        // tokens are in use - resolve tokens of refreshed process tables in background
     struct {
         BOOL fEnabled;
         DWORD cMs_TickPeriod;
@@ -950,6 +1040,7 @@ typedef struct tdVMM_CONTEXT {
     POB_CONTAINER pObCMapUser;
     POB_CONTAINER pObCMapNet;
     POB_CONTAINER pObCMapService;
+    POB_CONTAINER pObCMapPool;
     POB_CONTAINER pObCCachePrefetchEPROCESS;
     POB_CONTAINER pObCCachePrefetchRegistry;
     // page caches
@@ -959,7 +1050,24 @@ typedef struct tdVMM_CONTEXT {
         VMM_CACHE_TABLE PAGING;
         POB_SET PAGING_FAILED;
         POB_MAP pmPrototypePte;     // map with mm_vad.c managed data
+        POB_MAP pmMapText;          // map with rendered map text (VMMOB_MAP_TEXT)
+        QWORD cbMapText;            // # bytes in pmMapText
+        POB_MAP pmProcessClone;     // kernel-memory process clones keyed by PID (VMM_PROCESS)
     } Cache;
+    // learned structure offsets (session wide, optionally file backed)
+    struct {
+        BOOL fLoaded;
+        POB_MAP pm;                 // map with VMM_OFFSETCACHE_ENTRY (LocalFree)
+        QWORD cHit;
+        QWORD cMiss;
+        QWORD cTickSaved;
+    } OffsetCache;
+    // resolved token and user info kept across refreshes
+    struct {
+        POB_MAP pmToken;            // token summaries keyed by token va (LocalFree)
+        POB_MAP pmHive;             // user hive info keyed by hive va (LocalFree)
+        POB_MAP pmName;             // names of non-hive SIDs keyed by SID hash (LocalFree)
+    } UserCache;
     // worker threads
     struct {
         BOOL fEnabled;
@@ -967,6 +1075,20 @@ typedef struct tdVMM_CONTEXT {
         POB_SET psThreadAvail;
         POB_SET psUnit;
     } Work;
+    // device i/o scheduler (protected by LockSRW)
+    struct {
+        BOOL fEnabled;
+        BOOL fDeviceBusy;
+        HANDLE hThread;
+        DWORD dwThreadId;
+        QWORD qwFrequency;
+        SRWLOCK LockSRW;
+        CONDITION_VARIABLE cvSubmit;
+        CONDITION_VARIABLE cvComplete;
+        struct tdVMM_IOSCHED_REQUEST *pHead[2];  // [0] = latency sensitive, [1] = bulk
+        struct tdVMM_IOSCHED_REQUEST *pTail[2];
+        PPMEM_SCATTER ppMEMs;                   // dispatcher batch buffer [VMM_IOSCHED_BATCH_MAX]
+    } IoSched;
     WCHAR _EmptyWCHAR;
     VMMWIN_OBJECT_TYPE_TABLE ObjectTypeTable;
 } VMM_CONTEXT, *PVMM_CONTEXT;
@@ -984,6 +1106,7 @@ typedef struct tdVMM_MAIN_CONTEXT {
         CHAR szSymbolPath[MAX_PATH];
     } pdb;
     PVOID pvStatistics;
+    PVOID hPmemz;                   // compressed memory image source (replaces LeechCore device if set)
 } VMM_MAIN_CONTEXT, *PVMM_MAIN_CONTEXT;
 
 // ----------------------------------------------------------------------------
@@ -1172,6 +1295,30 @@ BOOL VmmReadPage(_In_opt_ PVMM_PROCESS pProcess, _In_ QWORD qwA, _Out_writes_(40
 */
 VOID VmmReadScatterVirtual(_In_ PVMM_PROCESS pProcess, _Inout_updates_(cpMEMsVirt) PPMEM_SCATTER ppMEMsVirt, _In_ DWORD cpMEMsVirt, _In_ QWORD flags);
 
+/*
+* Read physical memory from the device through the device i/o scheduler.
+* Small uncontended requests read the device directly. Bulk requests and
+* requests arriving while the device is busy are queued and merged into larger
+* device calls by the dispatcher thread. Small requests are latency sensitive
+* and are dispatched before bulk requests, which are dispatched round-robin in
+* chunks filling up the remainder of the device call.
+* -- cMEMs
+* -- ppMEMs
+*/
+VOID VmmIoScheduler_ReadScatter(_In_ DWORD cMEMs, _Inout_updates_(cMEMs) PPMEM_SCATTER ppMEMs);
+
+/*
+* Read a contiguous range of physical memory directly from the memory
+* acquisition device (LeechCore device or compressed memory image) bypassing
+* the cache and the device i/o scheduler.
+* -- pa
+* -- cb
+* -- pb
+* -- return = TRUE if the whole range was read.
+*/
+_Success_(return)
+BOOL VmmReadDevice(_In_ QWORD pa, _In_ DWORD cb, _Out_writes_(cb) PBYTE pb);
+
 /*
 * Scatter read physical memory. Non contiguous 4096-byte pages.
 * -- ppMEMsPhys
@@ -1245,6 +1392,32 @@ inline BOOL VmmVirt2Phys(_In_ PVMM_PROCESS pProcess, _In_ QWORD va, _Out_ PQWORD
     return ctxVmm->fnMemoryModel.pfnVirt2Phys(pProcess->paDTB, pProcess->fUserOnly, -1, va, ppa);
 }
 
+/*
+* Translate multiple virtual addresses to physical addresses. Memory models
+* supporting batched translation prefetch or re-use the page tables required
+* by the batch. Other memory models translate the addresses one-by-one.
+* Upon fail the PTE will be returned in pqwA (if possible) just as for
+* VmmVirt2Phys. Zero (0) virtual addresses are skipped and fail.
+* -- pProcess
+* -- cva
+* -- pqwA = virtual addresses on entry, physical addresses on exit.
+* -- pfResult = translation result per address.
+*/
+inline VOID VmmVirt2PhysBatch(_In_ PVMM_PROCESS pProcess, _In_ DWORD cva, _Inout_updates_(cva) PQWORD pqwA, _Out_writes_(cva) PBOOL pfResult)
+{
+    DWORD i;
+    QWORD va;
+    if(ctxVmm->fnMemoryModel.pfnVirt2PhysBatch) {
+        ctxVmm->fnMemoryModel.pfnVirt2PhysBatch(pProcess->paDTB, pProcess->fUserOnly, cva, pqwA, pfResult);
+        return;
+    }
+    for(i = 0; i < cva; i++) {
+        va = pqwA[i];
+        pqwA[i] = 0;
+        pfResult[i] = va && (ctxVmm->tpMemoryModel != VMM_MEMORYMODEL_NA) && ctxVmm->fnMemoryModel.pfnVirt2Phys(pProcess->paDTB, pProcess->fUserOnly, -1, va, pqwA + i);
+    }
+}
+
 /*
 * Spider the TLB (page table cache) to load all page table pages into the cache.
 * This is done to speed up various subsequent virtual memory accesses.
@@ -1448,6 +1621,122 @@ BOOL VmmMap_GetUser(_Out_ PVMMOB_MAP_USER *ppObUserMap);
 _Success_(return)
 BOOL VmmMap_GetService(_Out_ PVMMOB_MAP_SERVICE *ppObServiceMap);
 
+/*
+* Retrieve the kernel BIG POOL map. The map is an index of the kernel big pool
+* tracker table (allocations of page size and larger) and is valid until the
+* next total refresh.
+* CALLER DECREF: ppObPoolMap
+* -- ppObPoolMap
+* -- return
+*/
+_Success_(return)
+BOOL VmmMap_GetPool(_Out_ PVMMOB_MAP_POOL *ppObPoolMap);
+
+/*
+* Retrieve the big pool allocation containing the address va.
+* -- pPoolMap
+* -- va
+* -- return = the pool entry or NULL if va is not within a tracked allocation.
+*/
+PVMM_MAP_POOLENTRY VmmMap_GetPoolEntry(_In_ PVMMOB_MAP_POOL pPoolMap, _In_ QWORD va);
+
+/*
+* Retrieve the big pool allocations starting within the address range
+* [vaStart, vaEnd). Matching entries are pPoolMap->pMap[*piMap + 0..return-1].
+* -- pPoolMap
+* -- vaStart
+* -- vaEnd
+* -- piMap
+* -- return = the number of matching entries.
+*/
+DWORD VmmMap_GetPoolRange(_In_ PVMMOB_MAP_POOL pPoolMap, _In_ QWORD vaStart, _In_ QWORD vaEnd, _Out_ PDWORD piMap);
+
+/*
+* Retrieve the big pool allocations with a given pool tag. Matching entries are
+* pPoolMap->pMap[pPoolMap->piTag[*piTag + 0..return-1]] in address order.
+* -- pPoolMap
+* -- dwPoolTag = pool tag as multi-character constant, i.e. 'Obtb'.
+* -- piTag
+* -- return = the number of matching entries.
+*/
+DWORD VmmMap_GetPoolTag(_In_ PVMMOB_MAP_POOL pPoolMap, _In_ DWORD dwPoolTag, _Out_ PDWORD piTag);
+
+/*
+* Retrieve the pool tag of the big pool allocation starting at va from the big
+* pool index. This replaces reading the pool header of page-aligned kernel
+* allocations (which have no prepended pool header). Small pool allocations are
+* not tracked by the index - their prepended pool header is read together with
+* the object itself and is verified in-place by VMM_POOLTAG_PREPENDED.
+* -- va
+* -- fBuild = build the index if not already built. Callers that may execute
+*             within a memory read (i.e. prototype pte resolution) must not
+*             build the index and should set this to FALSE.
+* -- pdwPoolTag = pool tag as stored in memory (compare with VMM_POOLTAG).
+* -- return = TRUE if va is the start of a tracked big pool allocation.
+*/
+_Success_(return)
+BOOL VmmMap_GetPoolTagByAddress(_In_ QWORD va, _In_ BOOL fBuild, _Out_ PDWORD pdwPoolTag);
+
+/*
+* Read from a fixed-width text file rendered from a map object. The rendered
+* text is cached per map object (and render id) until the next process list
+* refresh to avoid re-formatting the same lines on every read. Texts too large
+* for the cache are rendered line-by-line for the requested range only.
+* -- pObMap = map object the text is rendered from.
+* -- dwRenderId = distinguish multiple text views of the same map (0-15).
+* -- cLine = number of lines (map entries).
+* -- cszLineLength = line length incl. newline.
+* -- ctx = optional context passed to pfnRenderLine.
+* -- pfnRenderLine
+* -- pb
+* -- cb
+* -- pcbRead
+* -- cbOffset
+* -- return
+*/
+_Success_(return == 0)
+NTSTATUS VmmMapText_Read(
+    _In_ POB pObMap,
+    _In_ DWORD dwRenderId,
+    _In_ DWORD cLine,
+    _In_ DWORD cszLineLength,
+    _In_opt_ PVOID ctx,
+    _In_ VMM_MAPTEXT_PFN_RENDERLINE pfnRenderLine,
+    _Out_writes_to_(cb, *pcbRead) PBYTE pb,
+    _In_ DWORD cb,
+    _Out_ PDWORD pcbRead,
+    _In_ QWORD cbOffset
+);
+
+/*
+* Clear the rendered map text cache.
+*/
+VOID VmmMapText_Clear();
+
+/*
+* Retrieve previously learned structure offsets from the offset cache. Offsets
+* are keyed by a caller defined tag and a module build identity and are kept
+* for the session. If the -offsetcache option is given the cache is also read
+* from (and appended to) the specified file, allowing re-use across dumps.
+* -- dwTag = offset set identifier, such as 'TcpE'.
+* -- qwBuildId = module build identity, such as TimeDateStamp and image size.
+* -- pb = buffer to receive the offsets.
+* -- cb = size of offsets (max 0x80 bytes).
+* -- return
+*/
+_Success_(return)
+BOOL VmmOffsetCache_Get(_In_ DWORD dwTag, _In_ QWORD qwBuildId, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb);
+
+/*
+* Store learned structure offsets in the offset cache (and file if configured).
+* -- dwTag
+* -- qwBuildId
+* -- cTickCost = time (ms) spent locating the offsets - reported as saved on hit.
+* -- pb
+* -- cb = size of offsets (max 0x80 bytes).
+*/
+VOID VmmOffsetCache_Put(_In_ DWORD dwTag, _In_ QWORD qwBuildId, _In_ QWORD cTickCost, _In_reads_(cb) PBYTE pb, _In_ DWORD cb);
+
 /*
 * Retrieve a process for a given PID and optional PVMMOB_PROCESS_TABLE.
 * CALLER DECREF: return
@@ -1512,6 +1801,15 @@ inline PVMM_PROCESS VmmProcessGetNext(_In_opt_ PVMM_PROCESS pProcess, _In_ QWORD
 */
 PVMM_PROCESS VmmProcessClone(_In_ PVMM_PROCESS pProcess);
 
+/*
+* Retrieve a cached kernel-memory clone (fUserOnly = FALSE) of a process. The
+* clone is re-used for as long as the process object remains active.
+* CALLER DECREF: return
+* -- pProcess
+* -- return
+*/
+PVMM_PROCESS VmmProcessCloneKernel(_In_ PVMM_PROCESS pProcess);
+
 /*
 * Create a new process object. New process object are created in a separate
 * data structure and won't become visible to the "Process" functions until
@@ -1587,6 +1885,27 @@ VOID VmmWork(_In_ LPTHREAD_START_ROUTINE pfn, _In_opt_ PVOID ctx, _In_opt_ HANDL
 */
 VOID VmmWorkWaitMultiple(_In_opt_ PVOID ctx, _In_ DWORD cWork, ...);
 
+/*
+* Check whether the current thread is a thread of the 'Work' thread pool.
+* Functions which fan out onto the pool and wait for completion should run
+* inline when called from a work item - nested blocking waits may otherwise
+* leave all pool threads blocked on queued work and deadlock the pool.
+* -- return
+*/
+BOOL VmmWorkIsWorkerThread();
+
+/*
+* Call pfn(ctx, i) for each i in [0, c) in parallel on the worker thread pool
+* and wait for all calls to complete. Calls are made sequentially on the
+* calling thread if the worker thread pool is unavailable or if the calling
+* thread is itself a worker thread.
+* NB! Manipulation of ctx in pfn callback function must be thread-safe!
+* -- c
+* -- ctx
+* -- pfn
+*/
+VOID VmmWorkParallelForeach(_In_ DWORD c, _In_opt_ PVOID ctx, _In_ VOID(*pfn)(_In_opt_ PVOID ctx, _In_ DWORD i));
+
 /*
 * Perform multi-threaded parallel processing of processes in the process table.
 * This is useful when slow I/O should take place on multiple or all processes
@@ -17,6 +17,7 @@
 #include "vmmproc.h"
 #include "vmmwin.h"
 #include "vmmnet.h"
+#include "vmmpmemz.h"
 #include "vmmwinobj.h"
 #include "vmmwinreg.h"
 #include "mm_pfn.h"
@@ -131,6 +132,10 @@ BOOL VmmDll_ConfigIntialize(_In_ DWORD argc, _In_ char* argv[])
             strcpy_s(ctxMain->cfg.szMemMapStr, _countof(ctxMain->cfg.szMemMapStr), argv[i + 1]);
             i += 2;
             continue;
+        } else if(0 == _stricmp(argv[i], "-offsetcache")) {
+            strcpy_s(ctxMain->cfg.szOffsetCache, MAX_PATH, argv[i + 1]);
+            i += 2;
+            continue;
         } else if(0 == _stricmp(argv[i], "-pythonpath")) {
             strcpy_s(ctxMain->cfg.szPythonPath, MAX_PATH, argv[i + 1]);
             i += 2;
@@ -201,6 +206,8 @@ VOID VmmDll_PrintHelp()
         "          such as, but not limited to: <memory_dump_file>, PMEM, FPGA          \n" \
         "          ---                                                                  \n" \
         "          <memory_dump_file> = memory dump file name optionally including path.\n" \
+        "          Compressed memory images (.pmemz) exported by MemProcFS are also     \n" \
+        "          supported as memory dump files.                                      \n" \
         "          PMEM = use winpmem 'winpmem_64.sys' to acquire live memory.          \n" \
         "          PMEM://c:\\path\\to\\winpmem_64.sys = path to winpmem driver.        \n" \
         "          ---                                                                  \n" \
@@ -223,6 +230,9 @@ VOID VmmDll_PrintHelp()
         "   -pagefile0..9 : specify specify page file / swap file. By default pagefile  \n" \
         "          have index 0 - example: -pagefile0 pagefile.sys while swapfile have  \n" \
         "          have index 1 - example: -pagefile1 swapfile.sys                      \n" \
+        "   -offsetcache : specify a file in which structure offsets located by         \n" \
+        "          heuristics are cached between runs against the same OS build.        \n" \
+        "          example: -offsetcache c:\\temp\\vmm_offsets.bin                 \n" \
         "   -pythonpath : specify the path to a python 3 installation for Windows.      \n" \
         "          The path given should be to the directory that contain: python.dll   \n" \
         "          Example: -pythonpath \"C:\\Program Files\\Python37\"                 \n" \
@@ -264,6 +274,7 @@ VOID VmmDll_FreeContext()
     if(ctxMain) {
         Statistics_CallSetEnabled(FALSE);
         LcClose(ctxMain->hLC);
+        VmmPmemz_Close(ctxMain->hPmemz);
         LocalFree(ctxMain);
         ctxMain = NULL;
     }
@@ -280,7 +291,15 @@ BOOL VMMDLL_Initialize_MemMapAuto()
     DWORD i, cbMemMap = 0;
     LPSTR szMemMap = NULL;
     PVMMOB_MAP_PHYSMEM pObMap = NULL;
+    if(ctxMain->hPmemz && VmmPmemz_MemMapExists(ctxMain->hPmemz)) {
+        // memory map stored in compressed memory image is already in effect.
+        return TRUE;
+    }
     if(!VmmMap_GetPhysMem(&pObMap)) { goto fail; }
+    if(ctxMain->hPmemz) {
+        fResult = VmmPmemz_MemMapSet(ctxMain->hPmemz, pObMap->cMap, pObMap->pMap, &ctxMain->dev.paMax);
+        goto fail;
+    }
     if(!(szMemMap = LocalAlloc(LMEM_ZEROINIT, 0x01000000))) { goto fail; }
     for(i = 0; i < pObMap->cMap; i++) {
         cbMemMap += snprintf(szMemMap + cbMemMap, 0x01000000 - cbMemMap - 1, "%016llx %016llx\n", pObMap->pMap[i].pa, pObMap->pMap[i].pa + pObMap->pMap[i].cb - 1);
@@ -349,7 +368,12 @@ BOOL VMMDLL_InitializeEx(_In_ DWORD argc, _In_ LPSTR argv[], _Out_opt_ PPLC_CONF
         goto fail;
     }
     // ctxMain.cfg context is inintialized from here onwards - vmmprintf is working!
-    if(!(ctxMain->hLC = LcCreateEx(&ctxMain->dev, &pLcErrorInfo))) {
+    // Compressed memory images (.pmemz) are served natively - other devices by LeechCore.
+    if((ctxMain->hPmemz = VmmPmemz_Open(ctxMain->dev.szDevice, &ctxMain->dev.paMax))) {
+        ctxMain->dev.fVolatile = FALSE;
+        ctxMain->dev.fWritable = FALSE;
+        strcpy_s(ctxMain->dev.szDeviceName, MAX_PATH, "pmemz");
+    } else if(!(ctxMain->hLC = LcCreateEx(&ctxMain->dev, &pLcErrorInfo))) {
         if(pLcErrorInfo && (pLcErrorInfo->dwVersion == LC_CONFIG_ERRORINFO_VERSION)) {
             if(pLcErrorInfo->cwszUserText) {
                 vmmwprintf(L"MESSAGE FROM MEMORY ACQUISITION DEVICE:\n=======================================\n%s\n", pLcErrorInfo->wszUserText);
@@ -362,6 +386,13 @@ BOOL VMMDLL_InitializeEx(_In_ DWORD argc, _In_ LPSTR argv[], _Out_opt_ PPLC_CONF
         vmmprintf("MemProcFS: Failed to connect to memory acquisition device.\n");
         goto fail;
     }
+    // Compressed memory images contain their own memory map - LeechCore memory
+    // maps from file or command line cannot be applied to them.
+    if(ctxMain->hPmemz && ((ctxMain->cfg.szMemMap[0] && _stricmp(ctxMain->cfg.szMemMap, "auto")) || ctxMain->cfg.szMemMapStr[0])) {
+        vmmprintf("MemProcFS: Option -memmap is not supported for compressed memory images (.pmemz) - ignoring (use -memmap auto).\n");
+        ctxMain->cfg.szMemMap[0] = 0;
+        ctxMain->cfg.szMemMapStr[0] = 0;
+    }
     // Set LeechCore MemMap (if exists and not auto - i.e. from file)
     if(ctxMain->cfg.szMemMap[0] && _stricmp(ctxMain->cfg.szMemMap, "auto")) {
         f = (pbMemMap = LocalAlloc(LMEM_ZEROINIT, 0x01000000)) &&
@@ -537,6 +568,10 @@ BOOL VMMDLL_ConfigGet(_In_ ULONG64 fOption, _Out_ PULONG64 pqwValue)
             return TRUE;
         default:
             // non-recognized option - possibly a device option to pass along to leechcore.dll
+            // or to the compressed memory image (if opened instead of a leechcore device).
+            if(ctxMain->hPmemz) {
+                return VmmPmemz_GetOption(ctxMain->hPmemz, fOption, pqwValue);
+            }
             return LcGetOption(ctxMain->hLC, fOption, pqwValue);
     }
 }
@@ -630,6 +665,11 @@ BOOL VMMDLL_ConfigSet(_In_ ULONG64 fOption, _In_ ULONG64 qwValue)
             return FcInitialize((DWORD)qwValue, FALSE);
         default:
             // non-recognized option - possibly a device option to pass along to leechcore.dll
+            // compressed memory images (if opened instead of a leechcore device) are read-only.
+            if(ctxMain->hPmemz) {
+                vmmprintfv("MemProcFS: Device option %016llx is not supported for compressed memory images.\n", fOption);
+                return FALSE;
+            }
             return LcSetOption(ctxMain->hLC, fOption, qwValue);
     }
 }
@@ -944,6 +984,14 @@ BOOL VMMDLL_MemVirt2Phys(_In_ DWORD dwPID, _In_ ULONG64 qwVA, _Out_ PULONG64 pqw
         VMMDLL_MemVirt2Phys_Impl(dwPID, qwVA, pqwPA))
 }
 
+_Success_(return)
+BOOL VMMDLL_MemExportCompressedImage(_In_ LPSTR szFileName)
+{
+    CALL_IMPLEMENTATION_VMM(
+        STATISTICS_ID_VMMDLL_MemExportCompressedImage,
+        VmmPmemz_Export(szFileName))
+}
+
 //-----------------------------------------------------------------------------
 // VMM PROCESS FUNCTIONALITY BELOW:
 //-----------------------------------------------------------------------------
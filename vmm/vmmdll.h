@@ -520,6 +520,18 @@ BOOL VMMDLL_MemWrite(_In_ DWORD dwPID, _In_ ULONG64 qwA, _In_reads_(cb) PBYTE pb
 _Success_(return)
 BOOL VMMDLL_MemVirt2Phys(_In_ DWORD dwPID, _In_ ULONG64 qwVA, _Out_ PULONG64 pqwPA);
 
+/*
+* Export the physical memory of the analyzed system to a seekable compressed
+* memory image file (.pmemz). The image consists of independently compressed
+* fixed-size blocks and a trailing block index; all-zero blocks and blocks in
+* physical memory holes are not stored. The resulting file may be opened as a
+* memory source by specifying it as the -device argument.
+* -- szFileName = file to create - any existing file will be overwritten.
+* -- return = success/fail.
+*/
+_Success_(return)
+BOOL VMMDLL_MemExportCompressedImage(_In_ LPSTR szFileName);
+
 
 
 //-----------------------------------------------------------------------------
@@ -54,6 +54,7 @@ typedef struct tdVMMNET_OFFSET_TcpL_UdpA {
 
 typedef struct tdVMMNET_CONTEXT {
     QWORD vaModuleTcpip;
+    QWORD qwBuildIdTcpip;       // TimeDateStamp | SizeOfImage - offset cache key
     PDB_HANDLE hPDB;
     DWORD cPartition;
     QWORD vaPartitionTable;
@@ -103,7 +104,8 @@ int VmmNet_TcpE_CmpSort(PVMM_MAP_NETENTRY a, PVMM_MAP_NETENTRY b)
 
 /*
 * Fuzz offsets in TcpE if required. Upon a successful fuzz values will be stored
-* in the ctxVmm global context.
+* in the ctxVmm global context. Previously fuzzed offsets for the same build of
+* tcpip.sys are retrieved from the offset cache and the fuzz is skipped.
 * -- ctx
 * -- pSystemProcess
 * -- vaTcpE_UdpA - virtual address of a TCP ENDPOINT entry (TcpE).
@@ -116,8 +118,10 @@ VOID VmmNet_TcpE_Fuzz(_In_ PVMMNET_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess
     BYTE pb[0x300];
     PVMM_PROCESS pObProcess = NULL;
     PVMMNET_OFFSET_TcpE po = &ctx->oTcpE;
+    QWORD tcStart = GetTickCount64();
     if(po->_fValid || po->_fProcessedTry) { goto fail; }
     po->_fProcessedTry = TRUE;
+    if(ctx->qwBuildIdTcpip && VmmOffsetCache_Get('TcpE', ctx->qwBuildIdTcpip, (PBYTE)po, sizeof(VMMNET_OFFSET_TcpE))) { goto fail; }
     if(!VmmRead(pSystemProcess, vaTcpE, pb, 0x300)) { goto fail; }
     // Search for EPROCESS value in TcpE struct
     while((pObProcess = VmmProcessGetNext(pObProcess, VMM_FLAG_PROCESS_SHOW_TERMINATED))) {
@@ -143,6 +147,9 @@ VOID VmmNet_TcpE_Fuzz(_In_ PVMMNET_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess
                 po->Time = po->EProcess + 0x10;
                 po->_Size = po->Time + 8;
                 po->_fValid = TRUE;
+                if(ctx->qwBuildIdTcpip) {
+                    VmmOffsetCache_Put('TcpE', ctx->qwBuildIdTcpip, GetTickCount64() - tcStart, (PBYTE)po, sizeof(VMMNET_OFFSET_TcpE));
+                }
                 // print result
                 if(ctxMain->cfg.fVerboseExtra) {
                     vmmprintfvv_fn("0x%016llx:\n", vaTcpE);
@@ -810,6 +817,7 @@ VOID VmmNet_Initialize_Context(_In_ PVMM_PROCESS pSystemProcess)
 {
     BOOL fResult = FALSE;
     QWORD va;
+    DWORD dwTimeDateStamp;
     PVMMNET_CONTEXT ctx = NULL;
     PVMMOB_MAP_MODULE pObModuleMap = NULL;
     PVMM_MAP_MODULEENTRY peModuleTcpip;
@@ -818,6 +826,9 @@ VOID VmmNet_Initialize_Context(_In_ PVMM_PROCESS pSystemProcess)
     if(!VmmMap_GetModule(pSystemProcess, &pObModuleMap)) { goto fail; }
     if(!(peModuleTcpip = VmmMap_GetModuleEntry(pObModuleMap, L"tcpip.sys"))) { goto fail; }
     ctx->vaModuleTcpip = peModuleTcpip->vaBase;
+    if(PE_GetTimeDateStampCheckSum(pSystemProcess, ctx->vaModuleTcpip, &dwTimeDateStamp, NULL) && dwTimeDateStamp) {
+        ctx->qwBuildIdTcpip = ((QWORD)dwTimeDateStamp << 32) | peModuleTcpip->cbImageSize;
+    }
     if(!(ctx->hPDB = PDB_GetHandleFromModuleAddress(pSystemProcess, ctx->vaModuleTcpip))) { goto fail; }
     if(!PDB_LoadEnsure(ctx->hPDB)) { goto fail; }
     // 2: retrieve pdb information
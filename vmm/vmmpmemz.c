@@ -0,0 +1,446 @@
+// vmmpmemz.c : implementation of functionality related to seekable compressed
+//              physical memory images (.pmemz).
+//
+// (c) Ulf Frisk, 2020
+// Author: Ulf Frisk, pcileech@frizk.net
+//
+
+#include "vmmpmemz.h"
+#include "statistics.h"
+
+#define VMMPMEMZ_COMPRESSION_FORMAT     0x0003      // COMPRESSION_FORMAT_XPRESS
+#define VMMPMEMZ_EXPORT_CHUNK           0x01000000  // 16MB read per export iteration
+#define VMMPMEMZ_CACHE_ENTRIES          0x40        // 4MB decompressed block cache
+
+typedef struct tdVMMPMEMZ_CACHE_ENTRY {
+    QWORD iBlock;
+    BOOL fValid;
+    PBYTE pb;
+} VMMPMEMZ_CACHE_ENTRY, *PVMMPMEMZ_CACHE_ENTRY;
+
+typedef struct tdVMMPMEMZ_CONTEXT {
+    SRWLOCK LockSRW;
+    FILE *hFile;
+    QWORD cbFile;
+    VMMPMEMZ_HEADER Hdr;
+    PVMMPMEMZ_INDEX_ENTRY pIndex;
+    DWORD cMemMap;
+    PVMM_MAP_PHYSMEMENTRY pMemMap;  // sorted memory map, NULL = no map (blocks only)
+    VMMFN_RtlDecompressBuffer *pfnRtlDecompressBuffer;
+    PBYTE pbCompressed;             // [cbBlock] scratch buffer for file reads
+    PBYTE pbZero;                   // [cbBlock] all zero block
+    PBYTE pbCache;                  // [VMMPMEMZ_CACHE_ENTRIES * cbBlock]
+    VMMPMEMZ_CACHE_ENTRY Cache[VMMPMEMZ_CACHE_ENTRIES];
+} VMMPMEMZ_CONTEXT, *PVMMPMEMZ_CONTEXT;
+
+// ----------------------------------------------------------------------------
+// READ FUNCTIONALITY:
+// ----------------------------------------------------------------------------
+
+/*
+* Check whether a physical address range lies inside the memory map of the
+* image. Ranges within a page never straddle memory map entries.
+* CALLER MUST HOLD LockSRW.
+* -- ctx
+* -- pa
+* -- return
+*/
+BOOL VmmPmemz_MemMapContains(_In_ PVMMPMEMZ_CONTEXT ctx, _In_ QWORD pa)
+{
+    DWORD iLo = 0, iHi, i;
+    if(!ctx->pMemMap) { return TRUE; }
+    iHi = ctx->cMemMap;
+    while(iLo < iHi) {
+        i = (iLo + iHi) / 2;
+        if(pa < ctx->pMemMap[i].pa) {
+            iHi = i;
+        } else if(pa >= ctx->pMemMap[i].pa + ctx->pMemMap[i].cb) {
+            iLo = i + 1;
+        } else {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/*
+* Retrieve the decompressed contents of a block. Decompressed blocks are kept
+* in a small direct-mapped cache since consecutive page reads usually hit the
+* same block. CALLER MUST HOLD LockSRW EXCLUSIVE.
+* -- ctx
+* -- iBlock
+* -- return = block data (valid until LockSRW is released), NULL on fail/hole.
+*/
+PBYTE VmmPmemz_BlockGet(_In_ PVMMPMEMZ_CONTEXT ctx, _In_ QWORD iBlock)
+{
+    ULONG cbDecompressed = 0;
+    PVMMPMEMZ_INDEX_ENTRY pe;
+    PVMMPMEMZ_CACHE_ENTRY pc;
+    if(iBlock >= ctx->Hdr.cBlocks) { return NULL; }
+    pe = ctx->pIndex + iBlock;
+    if((pe->tp == VMMPMEMZ_BLOCK_TP_HOLE) || (pe->tp == VMMPMEMZ_BLOCK_TP_FAIL)) { return NULL; }
+    if(pe->tp == VMMPMEMZ_BLOCK_TP_ZERO) { return ctx->pbZero; }
+    pc = ctx->Cache + (iBlock % VMMPMEMZ_CACHE_ENTRIES);
+    if(pc->fValid && (pc->iBlock == iBlock)) { return pc->pb; }
+    pc->fValid = FALSE;
+    if((pe->cb > ctx->Hdr.cbBlock) || (pe->o + pe->cb > ctx->cbFile)) { return NULL; }
+    if(_fseeki64(ctx->hFile, pe->o, SEEK_SET)) { return NULL; }
+    if(pe->tp == VMMPMEMZ_BLOCK_TP_RAW) {
+        if((pe->cb != ctx->Hdr.cbBlock) || (1 != fread(pc->pb, pe->cb, 1, ctx->hFile))) { return NULL; }
+    } else if(pe->tp == VMMPMEMZ_BLOCK_TP_XPRESS) {
+        if(1 != fread(ctx->pbCompressed, pe->cb, 1, ctx->hFile)) { return NULL; }
+        if((VMM_STATUS_SUCCESS != ctx->pfnRtlDecompressBuffer(VMMPMEMZ_COMPRESSION_FORMAT, pc->pb, ctx->Hdr.cbBlock, ctx->pbCompressed, pe->cb, &cbDecompressed)) || (cbDecompressed != ctx->Hdr.cbBlock)) {
+            return NULL;
+        }
+    } else {
+        return NULL;
+    }
+    pc->iBlock = iBlock;
+    pc->fValid = TRUE;
+    return pc->pb;
+}
+
+VOID VmmPmemz_ReadScatter(_In_ PVOID hPmemz, _In_ DWORD cMEMs, _Inout_ PPMEM_SCATTER ppMEMs)
+{
+    PVMMPMEMZ_CONTEXT ctx = (PVMMPMEMZ_CONTEXT)hPmemz;
+    PMEM_SCATTER pMEM;
+    PBYTE pbBlock;
+    DWORD i, oBlock;
+    QWORD tmStart = Statistics_CallStart();
+    AcquireSRWLockExclusive(&ctx->LockSRW);
+    for(i = 0; i < cMEMs; i++) {
+        pMEM = ppMEMs[i];
+        if(pMEM->f || MEM_SCATTER_ADDR_ISINVALID(pMEM) || (pMEM->qwA + pMEM->cb > ctx->Hdr.paMax) || !VmmPmemz_MemMapContains(ctx, pMEM->qwA)) { continue; }
+        oBlock = (DWORD)(pMEM->qwA % ctx->Hdr.cbBlock);
+        if((oBlock + pMEM->cb > ctx->Hdr.cbBlock) || !(pbBlock = VmmPmemz_BlockGet(ctx, pMEM->qwA / ctx->Hdr.cbBlock))) { continue; }
+        memcpy(pMEM->pb, pbBlock + oBlock, pMEM->cb);
+        pMEM->f = TRUE;
+    }
+    ReleaseSRWLockExclusive(&ctx->LockSRW);
+    Statistics_CallEnd(STATISTICS_ID_VMM_PmemzReadScatter, tmStart);
+}
+
+_Success_(return)
+BOOL VmmPmemz_Read(_In_ PVOID hPmemz, _In_ QWORD pa, _In_ DWORD cb, _Out_writes_(cb) PBYTE pb)
+{
+    PVMMPMEMZ_CONTEXT ctx = (PVMMPMEMZ_CONTEXT)hPmemz;
+    BOOL fResult = TRUE;
+    PBYTE pbBlock;
+    DWORD oBlock, cbBlockRead, cbPage, cbPageRead;
+    if(pa + cb > ctx->Hdr.paMax) { return FALSE; }
+    AcquireSRWLockExclusive(&ctx->LockSRW);
+    while(cb) {
+        oBlock = (DWORD)(pa % ctx->Hdr.cbBlock);
+        cbBlockRead = min(cb, ctx->Hdr.cbBlock - oBlock);
+        if((pbBlock = VmmPmemz_BlockGet(ctx, pa / ctx->Hdr.cbBlock))) {
+            memcpy(pb, pbBlock + oBlock, cbBlockRead);
+            // fail and zero pages outside of the memory map
+            for(cbPage = 0; ctx->pMemMap && (cbPage < cbBlockRead); cbPage += cbPageRead) {
+                cbPageRead = min(cbBlockRead - cbPage, 0x1000 - (DWORD)((pa + cbPage) & 0xfff));
+                if(!VmmPmemz_MemMapContains(ctx, pa + cbPage)) {
+                    ZeroMemory(pb + cbPage, cbPageRead);
+                    fResult = FALSE;
+                }
+            }
+        } else {
+            ZeroMemory(pb, cbBlockRead);
+            fResult = FALSE;
+        }
+        pa += cbBlockRead;
+        pb += cbBlockRead;
+        cb -= cbBlockRead;
+    }
+    ReleaseSRWLockExclusive(&ctx->LockSRW);
+    return fResult;
+}
+
+BOOL VmmPmemz_MemMapExists(_In_ PVOID hPmemz)
+{
+    return ((PVMMPMEMZ_CONTEXT)hPmemz)->pMemMap ? TRUE : FALSE;
+}
+
+_Success_(return)
+BOOL VmmPmemz_MemMapSet(_In_ PVOID hPmemz, _In_ DWORD cMap, _In_reads_(cMap) PVMM_MAP_PHYSMEMENTRY pMap, _Out_ PQWORD ppaMax)
+{
+    PVMMPMEMZ_CONTEXT ctx = (PVMMPMEMZ_CONTEXT)hPmemz;
+    PVMM_MAP_PHYSMEMENTRY pMemMap, pMemMapOld;
+    *ppaMax = ctx->Hdr.paMax;
+    if(!cMap || !(pMemMap = LocalAlloc(0, cMap * sizeof(VMM_MAP_PHYSMEMENTRY)))) { return FALSE; }
+    memcpy(pMemMap, pMap, cMap * sizeof(VMM_MAP_PHYSMEMENTRY));
+    AcquireSRWLockExclusive(&ctx->LockSRW);
+    pMemMapOld = ctx->pMemMap;
+    ctx->pMemMap = pMemMap;
+    ctx->cMemMap = cMap;
+    *ppaMax = min(ctx->Hdr.paMax, pMemMap[cMap - 1].pa + pMemMap[cMap - 1].cb);
+    ReleaseSRWLockExclusive(&ctx->LockSRW);
+    LocalFree(pMemMapOld);
+    return TRUE;
+}
+
+_Success_(return)
+BOOL VmmPmemz_GetOption(_In_ PVOID hPmemz, _In_ QWORD fOption, _Out_ PQWORD pqwValue)
+{
+    PVMMPMEMZ_CONTEXT ctx = (PVMMPMEMZ_CONTEXT)hPmemz;
+    *pqwValue = 0;
+    switch(fOption & 0xffffffff'00000000) {
+        case LC_OPT_CORE_ADDR_MAX:
+            *pqwValue = (ctx->pMemMap && ctx->cMemMap) ? min(ctx->Hdr.paMax, ctx->pMemMap[ctx->cMemMap - 1].pa + ctx->pMemMap[ctx->cMemMap - 1].cb) : ctx->Hdr.paMax;
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
+
+VOID VmmPmemz_Close(_In_opt_ _Post_ptr_invalid_ PVOID hPmemz)
+{
+    PVMMPMEMZ_CONTEXT ctx = (PVMMPMEMZ_CONTEXT)hPmemz;
+    if(!ctx) { return; }
+    if(ctx->hFile) { fclose(ctx->hFile); }
+    LocalFree(ctx->pIndex);
+    LocalFree(ctx->pMemMap);
+    LocalFree(ctx->pbCompressed);
+    LocalFree(ctx->pbZero);
+    LocalFree(ctx->pbCache);
+    LocalFree(ctx);
+}
+
+_Success_(return != NULL)
+PVOID VmmPmemz_Open(_In_ LPSTR szFileName, _Out_ PQWORD ppaMax)
+{
+    DWORD i;
+    HMODULE hNtDll = NULL;
+    VMMPMEMZ_FOOTER Footer = { 0 };
+    PVMMPMEMZ_CONTEXT ctx = NULL;
+    *ppaMax = 0;
+    if(!_strnicmp(szFileName, "file://", 7)) { szFileName += 7; }
+    if(!(ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMPMEMZ_CONTEXT)))) { goto fail; }
+    InitializeSRWLock(&ctx->LockSRW);
+    // 1: verify header and footer
+    if(fopen_s(&ctx->hFile, szFileName, "rb") || !ctx->hFile) { goto fail; }
+    if(1 != fread(&ctx->Hdr, sizeof(VMMPMEMZ_HEADER), 1, ctx->hFile)) { goto fail; }
+    if((ctx->Hdr.dwMagic != VMMPMEMZ_MAGIC) || (ctx->Hdr.dwVersion != VMMPMEMZ_VERSION)) { goto fail; }
+    if(_fseeki64(ctx->hFile, 0, SEEK_END) || ((ctx->cbFile = _ftelli64(ctx->hFile)) < sizeof(VMMPMEMZ_HEADER) + sizeof(VMMPMEMZ_FOOTER))) { goto fail; }
+    if(_fseeki64(ctx->hFile, ctx->cbFile - sizeof(VMMPMEMZ_FOOTER), SEEK_SET) || (1 != fread(&Footer, sizeof(VMMPMEMZ_FOOTER), 1, ctx->hFile))) { goto fail; }
+    if((Footer.dwMagic != VMMPMEMZ_MAGIC) || (Footer.cBlocks != ctx->Hdr.cBlocks) || !ctx->Hdr.cbBlock || (ctx->Hdr.cbBlock % 0x1000) || (ctx->Hdr.cbBlock > 0x01000000)) {
+        vmmprintf("VmmPmemz: Corrupt compressed memory image: '%s'.\n", szFileName);
+        goto fail;
+    }
+    if((ctx->Hdr.cBlocks != (ctx->Hdr.paMax + ctx->Hdr.cbBlock - 1) / ctx->Hdr.cbBlock) || (ctx->Hdr.cBlocks > 0x10000000) || (Footer.oIndex + ctx->Hdr.cBlocks * sizeof(VMMPMEMZ_INDEX_ENTRY) > ctx->cbFile)) {
+        vmmprintf("VmmPmemz: Corrupt compressed memory image index: '%s'.\n", szFileName);
+        goto fail;
+    }
+    // 2: load block index
+    if(!(ctx->pIndex = LocalAlloc(0, (SIZE_T)(ctx->Hdr.cBlocks * sizeof(VMMPMEMZ_INDEX_ENTRY))))) { goto fail; }
+    if(_fseeki64(ctx->hFile, Footer.oIndex, SEEK_SET) || (ctx->Hdr.cBlocks && (1 != fread(ctx->pIndex, (SIZE_T)(ctx->Hdr.cBlocks * sizeof(VMMPMEMZ_INDEX_ENTRY)), 1, ctx->hFile)))) { goto fail; }
+    // 3: load physical memory map (if stored)
+    if(Footer.cMemMap) {
+        if((Footer.cMemMap > 0x00100000) || (Footer.oMemMap + Footer.cMemMap * sizeof(VMM_MAP_PHYSMEMENTRY) > ctx->cbFile)) {
+            vmmprintf("VmmPmemz: Corrupt compressed memory image memory map: '%s'.\n", szFileName);
+            goto fail;
+        }
+        ctx->cMemMap = (DWORD)Footer.cMemMap;
+        if(!(ctx->pMemMap = LocalAlloc(0, ctx->cMemMap * sizeof(VMM_MAP_PHYSMEMENTRY)))) { goto fail; }
+        if(_fseeki64(ctx->hFile, Footer.oMemMap, SEEK_SET) || (1 != fread(ctx->pMemMap, ctx->cMemMap * sizeof(VMM_MAP_PHYSMEMENTRY), 1, ctx->hFile))) { goto fail; }
+    }
+    // 4: decompression and buffers
+    if((hNtDll = LoadLibraryA("ntdll.dll"))) {
+        ctx->pfnRtlDecompressBuffer = (VMMFN_RtlDecompressBuffer*)GetProcAddress(hNtDll, "RtlDecompressBuffer");
+        FreeLibrary(hNtDll);
+    }
+    if(!ctx->pfnRtlDecompressBuffer) { goto fail; }
+    if(!(ctx->pbCompressed = LocalAlloc(0, ctx->Hdr.cbBlock))) { goto fail; }
+    if(!(ctx->pbZero = LocalAlloc(LMEM_ZEROINIT, ctx->Hdr.cbBlock))) { goto fail; }
+    if(!(ctx->pbCache = LocalAlloc(0, (SIZE_T)VMMPMEMZ_CACHE_ENTRIES * ctx->Hdr.cbBlock))) { goto fail; }
+    for(i = 0; i < VMMPMEMZ_CACHE_ENTRIES; i++) {
+        ctx->Cache[i].pb = ctx->pbCache + (SIZE_T)i * ctx->Hdr.cbBlock;
+    }
+    VmmPmemz_GetOption(ctx, LC_OPT_CORE_ADDR_MAX, ppaMax);
+    return ctx;
+fail:
+    VmmPmemz_Close(ctx);
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+// EXPORT FUNCTIONALITY:
+// ----------------------------------------------------------------------------
+
+/*
+* Check whether a physical address range lies entirely outside of the physical
+* memory map. Ranges must be queried in ascending order.
+* -- pObPhysMem = physical memory map, NULL = no holes.
+* -- piMap = ptr to map iterator - initialized to zero by caller.
+* -- pa
+* -- cb
+* -- return
+*/
+BOOL VmmPmemz_Export_IsHole(_In_opt_ PVMMOB_MAP_PHYSMEM pObPhysMem, _Inout_ PDWORD piMap, _In_ QWORD pa, _In_ QWORD cb)
+{
+    PVMM_MAP_PHYSMEMENTRY pe;
+    if(!pObPhysMem) { return FALSE; }
+    while(*piMap < pObPhysMem->cMap) {
+        pe = pObPhysMem->pMap + *piMap;
+        if(pe->pa + pe->cb <= pa) {
+            (*piMap)++;
+            continue;
+        }
+        return pe->pa >= pa + cb;
+    }
+    return TRUE;
+}
+
+/*
+* Check whether a buffer is all zero.
+* -- pb
+* -- cb = must be a multiple of 8.
+* -- return
+*/
+BOOL VmmPmemz_Export_IsZero(_In_reads_(cb) PBYTE pb, _In_ DWORD cb)
+{
+    DWORD i;
+    for(i = 0; i < cb; i += 8) {
+        if(*(PQWORD)(pb + i)) { return FALSE; }
+    }
+    return TRUE;
+}
+
+_Success_(return)
+BOOL VmmPmemz_Export(_In_ LPSTR szFileName)
+{
+    BOOL fResult = FALSE;
+    FILE *hFile = NULL;
+    DWORD iMap = 0, iChunkBlock, cChunkBlocks, iPage, cPage, cPageRead, cPageOK;
+    ULONG cbCompressed, cbWorkSpace = 0, cbFragmentWorkSpace = 0;
+    QWORD i, iBlock, pa, paMax, cbOut, tmStart, tmEnd, qwFreq;
+    QWORD cBlockTp[5] = { 0 };
+    PBYTE pbChunk = NULL, pbCompressed = NULL, pbWorkSpace = NULL, pbBlock;
+    PVMMOB_MAP_PHYSMEM pObPhysMem = NULL;
+    PPMEM_SCATTER ppMEMsChunk = NULL, ppMEMsRead = NULL;
+    PVMMPMEMZ_INDEX_ENTRY pIndex = NULL, pe;
+    VMMPMEMZ_HEADER Hdr = { 0 };
+    VMMPMEMZ_FOOTER Footer = { 0 };
+    BOOL fHole[VMMPMEMZ_EXPORT_CHUNK / VMMPMEMZ_BLOCK_SIZE];
+    BOOL fFail[VMMPMEMZ_EXPORT_CHUNK / VMMPMEMZ_BLOCK_SIZE];
+    BOOL fChunkHole;
+    QueryPerformanceFrequency((PLARGE_INTEGER)&qwFreq);
+    QueryPerformanceCounter((PLARGE_INTEGER)&tmStart);
+    if(!ctxVmm->fn.RtlCompressBuffer || !ctxVmm->fn.RtlGetCompressionWorkSpaceSize) { goto fail; }
+    if(VMM_STATUS_SUCCESS != ctxVmm->fn.RtlGetCompressionWorkSpaceSize(VMMPMEMZ_COMPRESSION_FORMAT, &cbWorkSpace, &cbFragmentWorkSpace)) { goto fail; }
+    // 1: initialize - physical memory map is optional (no holes if missing)
+    paMax = ctxMain->dev.paMax;
+    Hdr.dwMagic = VMMPMEMZ_MAGIC;
+    Hdr.dwVersion = VMMPMEMZ_VERSION;
+    Hdr.cbBlock = VMMPMEMZ_BLOCK_SIZE;
+    Hdr.paMax = paMax;
+    Hdr.cBlocks = (paMax + VMMPMEMZ_BLOCK_SIZE - 1) / VMMPMEMZ_BLOCK_SIZE;
+    VmmMap_GetPhysMem(&pObPhysMem);
+    if(!(pIndex = LocalAlloc(LMEM_ZEROINIT, (SIZE_T)(Hdr.cBlocks * sizeof(VMMPMEMZ_INDEX_ENTRY))))) { goto fail; }
+    if(!(pbChunk = LocalAlloc(0, VMMPMEMZ_EXPORT_CHUNK))) { goto fail; }
+    if(!LcAllocScatter2(VMMPMEMZ_EXPORT_CHUNK, pbChunk, VMMPMEMZ_EXPORT_CHUNK / 0x1000, &ppMEMsChunk)) { goto fail; }
+    if(!(ppMEMsRead = LocalAlloc(0, (VMMPMEMZ_EXPORT_CHUNK / 0x1000) * sizeof(PMEM_SCATTER)))) { goto fail; }
+    if(!(pbCompressed = LocalAlloc(0, VMMPMEMZ_BLOCK_SIZE))) { goto fail; }
+    if(!(pbWorkSpace = LocalAlloc(0, cbWorkSpace))) { goto fail; }
+    if(fopen_s(&hFile, szFileName, "wb") || !hFile) {
+        vmmprintf("VmmPmemz: Unable to create file: '%s'.\n", szFileName);
+        goto fail;
+    }
+    if(1 != fwrite(&Hdr, sizeof(VMMPMEMZ_HEADER), 1, hFile)) { goto fail; }
+    cbOut = sizeof(VMMPMEMZ_HEADER);
+    // 2: read, compress and write block data one chunk at a time - chunks
+    //    entirely inside physical memory holes are never read.
+    for(iBlock = 0; iBlock < Hdr.cBlocks; iBlock += cChunkBlocks) {
+        if(!ctxVmm->Work.fEnabled) { goto fail; }
+        pa = iBlock * VMMPMEMZ_BLOCK_SIZE;
+        cChunkBlocks = (DWORD)min(VMMPMEMZ_EXPORT_CHUNK / VMMPMEMZ_BLOCK_SIZE, Hdr.cBlocks - iBlock);
+        fChunkHole = TRUE;
+        for(iChunkBlock = 0; iChunkBlock < cChunkBlocks; iChunkBlock++) {
+            fHole[iChunkBlock] = VmmPmemz_Export_IsHole(pObPhysMem, &iMap, pa + (QWORD)iChunkBlock * VMMPMEMZ_BLOCK_SIZE, VMMPMEMZ_BLOCK_SIZE);
+            fChunkHole = fChunkHole && fHole[iChunkBlock];
+        }
+        if(!fChunkHole) {
+            // read pages of non-hole blocks page-by-page so that unreadable
+            // blocks are recorded as such instead of as all-zero blocks.
+            ZeroMemory(pbChunk, (SIZE_T)cChunkBlocks * VMMPMEMZ_BLOCK_SIZE);
+            cPage = (DWORD)(((QWORD)cChunkBlocks * VMMPMEMZ_BLOCK_SIZE) >> 12);
+            for(iPage = 0, cPageRead = 0; iPage < cPage; iPage++) {
+                ppMEMsChunk[iPage]->f = FALSE;
+                ppMEMsChunk[iPage]->qwA = pa + ((QWORD)iPage << 12);
+                if(fHole[iPage / (VMMPMEMZ_BLOCK_SIZE >> 12)] || (ppMEMsChunk[iPage]->qwA >= paMax)) { continue; }
+                ppMEMsRead[cPageRead++] = ppMEMsChunk[iPage];
+            }
+            VmmReadScatterPhysical(ppMEMsRead, cPageRead, VMM_FLAG_NOCACHE);
+        }
+        for(iChunkBlock = 0; iChunkBlock < cChunkBlocks; iChunkBlock++) {
+            fFail[iChunkBlock] = FALSE;
+            if(fHole[iChunkBlock]) { continue; }
+            for(iPage = iChunkBlock * (VMMPMEMZ_BLOCK_SIZE >> 12), cPageOK = 0; iPage < (iChunkBlock + 1) * (VMMPMEMZ_BLOCK_SIZE >> 12); iPage++) {
+                if(ppMEMsChunk[iPage]->f) {
+                    cPageOK++;
+                } else {
+                    ZeroMemory(ppMEMsChunk[iPage]->pb, 0x1000);
+                }
+            }
+            fFail[iChunkBlock] = !cPageOK;
+        }
+        for(iChunkBlock = 0; iChunkBlock < cChunkBlocks; iChunkBlock++) {
+            pe = pIndex + iBlock + iChunkBlock;
+            pbBlock = pbChunk + (SIZE_T)iChunkBlock * VMMPMEMZ_BLOCK_SIZE;
+            if(fHole[iChunkBlock]) {
+                pe->tp = VMMPMEMZ_BLOCK_TP_HOLE;
+            } else if(fFail[iChunkBlock]) {
+                pe->tp = VMMPMEMZ_BLOCK_TP_FAIL;
+            } else if(VmmPmemz_Export_IsZero(pbBlock, VMMPMEMZ_BLOCK_SIZE)) {
+                pe->tp = VMMPMEMZ_BLOCK_TP_ZERO;
+            } else {
+                cbCompressed = 0;
+                if((VMM_STATUS_SUCCESS == ctxVmm->fn.RtlCompressBuffer(VMMPMEMZ_COMPRESSION_FORMAT, pbBlock, VMMPMEMZ_BLOCK_SIZE, pbCompressed, VMMPMEMZ_BLOCK_SIZE, 0x1000, &cbCompressed, pbWorkSpace)) && cbCompressed && (cbCompressed < VMMPMEMZ_BLOCK_SIZE)) {
+                    pe->tp = VMMPMEMZ_BLOCK_TP_XPRESS;
+                    pe->cb = cbCompressed;
+                    if(1 != fwrite(pbCompressed, cbCompressed, 1, hFile)) { goto fail; }
+                } else {
+                    pe->tp = VMMPMEMZ_BLOCK_TP_RAW;
+                    pe->cb = VMMPMEMZ_BLOCK_SIZE;
+                    if(1 != fwrite(pbBlock, VMMPMEMZ_BLOCK_SIZE, 1, hFile)) { goto fail; }
+                }
+                pe->o = cbOut;
+                cbOut += pe->cb;
+            }
+            cBlockTp[pe->tp]++;
+        }
+    }
+    // 3: write physical memory map, trailing index and footer
+    Footer.dwMagic = VMMPMEMZ_MAGIC;
+    Footer.dwVersion = VMMPMEMZ_VERSION;
+    if(pObPhysMem && pObPhysMem->cMap) {
+        if(1 != fwrite(pObPhysMem->pMap, pObPhysMem->cMap * sizeof(VMM_MAP_PHYSMEMENTRY), 1, hFile)) { goto fail; }
+        Footer.oMemMap = cbOut;
+        Footer.cMemMap = pObPhysMem->cMap;
+        cbOut += pObPhysMem->cMap * sizeof(VMM_MAP_PHYSMEMENTRY);
+    }
+    Footer.oIndex = cbOut;
+    Footer.cBlocks = Hdr.cBlocks;
+    if(Hdr.cBlocks && (1 != fwrite(pIndex, (SIZE_T)(Hdr.cBlocks * sizeof(VMMPMEMZ_INDEX_ENTRY)), 1, hFile))) { goto fail; }
+    if(1 != fwrite(&Footer, sizeof(VMMPMEMZ_FOOTER), 1, hFile)) { goto fail; }
+    cbOut += Hdr.cBlocks * sizeof(VMMPMEMZ_INDEX_ENTRY) + sizeof(VMMPMEMZ_FOOTER);
+    QueryPerformanceCounter((PLARGE_INTEGER)&tmEnd);
+    i = max(1, (tmEnd - tmStart) * 1000 / qwFreq);
+    vmmprintfv(
+        "VmmPmemz: Exported '%s': %llu MB -> %llu MB (%llu%%) in %llu ms (%llu MB/s).\n" \
+        "          Blocks: xpress=%llu raw=%llu zero=%llu hole=%llu fail=%llu\n",
+        szFileName, paMax >> 20, cbOut >> 20, paMax ? (cbOut * 100 / paMax) : 0, i, (paMax >> 20) * 1000 / i,
+        cBlockTp[VMMPMEMZ_BLOCK_TP_XPRESS], cBlockTp[VMMPMEMZ_BLOCK_TP_RAW], cBlockTp[VMMPMEMZ_BLOCK_TP_ZERO], cBlockTp[VMMPMEMZ_BLOCK_TP_HOLE], cBlockTp[VMMPMEMZ_BLOCK_TP_FAIL]);
+    fResult = TRUE;
+fail:
+    if(!fResult && hFile) {
+        vmmprintf("VmmPmemz: Failed to export compressed memory image: '%s'.\n", szFileName);
+    }
+    if(hFile) { fclose(hFile); }
+    Ob_DECREF(pObPhysMem);
+    LocalFree(pIndex);
+    LocalFree(ppMEMsRead);
+    LcMemFree(ppMEMsChunk);
+    LocalFree(pbChunk);
+    LocalFree(pbCompressed);
+    LocalFree(pbWorkSpace);
+    return fResult;
+}
@@ -0,0 +1,135 @@
+// vmmpmemz.h : declarations of functionality related to seekable compressed
+//              physical memory images (.pmemz).
+//
+// The .pmemz file format consists of a header followed by independently
+// compressed fixed-size blocks of physical memory, the physical memory map, a
+// trailing block index and a footer which points to the index and the map.
+// All-zero blocks, unreadable blocks and blocks which lie in physical memory
+// holes are not stored - they are recorded in the index only. Unreadable pages
+// of partially readable blocks are stored as zero.
+// Blocks are compressed by the LZ77-class XPRESS codec built into ntdll.dll.
+//
+// (c) Ulf Frisk, 2020
+// Author: Ulf Frisk, pcileech@frizk.net
+//
+
+#ifndef __VMMPMEMZ_H__
+#define __VMMPMEMZ_H__
+#include "vmm.h"
+
+#define VMMPMEMZ_MAGIC                  0x7a6d6d70      // 'pmmz'
+#define VMMPMEMZ_VERSION                1
+#define VMMPMEMZ_BLOCK_SIZE             0x10000
+
+#define VMMPMEMZ_BLOCK_TP_HOLE          0               // not physical memory - read fail
+#define VMMPMEMZ_BLOCK_TP_ZERO          1               // physical memory - all zero
+#define VMMPMEMZ_BLOCK_TP_RAW           2               // stored uncompressed
+#define VMMPMEMZ_BLOCK_TP_XPRESS        3               // stored XPRESS compressed
+#define VMMPMEMZ_BLOCK_TP_FAIL          4               // physical memory - unreadable at export - read fail
+
+typedef struct tdVMMPMEMZ_HEADER {
+    DWORD dwMagic;                  // VMMPMEMZ_MAGIC
+    DWORD dwVersion;                // VMMPMEMZ_VERSION
+    DWORD cbBlock;                  // VMMPMEMZ_BLOCK_SIZE
+    DWORD _Reserved1;
+    QWORD paMax;                    // max physical address (exclusive)
+    QWORD cBlocks;
+    QWORD _Reserved2[4];
+} VMMPMEMZ_HEADER, *PVMMPMEMZ_HEADER;
+
+typedef struct tdVMMPMEMZ_INDEX_ENTRY {
+    QWORD o;                        // file offset of block data
+    DWORD cb;                       // size of block data
+    DWORD tp;                       // VMMPMEMZ_BLOCK_TP_*
+} VMMPMEMZ_INDEX_ENTRY, *PVMMPMEMZ_INDEX_ENTRY;
+
+typedef struct tdVMMPMEMZ_FOOTER {
+    DWORD dwMagic;                  // VMMPMEMZ_MAGIC
+    DWORD dwVersion;                // VMMPMEMZ_VERSION
+    QWORD oIndex;                   // file offset of VMMPMEMZ_INDEX_ENTRY[cBlocks]
+    QWORD cBlocks;
+    QWORD oMemMap;                  // file offset of VMM_MAP_PHYSMEMENTRY[cMemMap] (sorted)
+    QWORD cMemMap;                  // 0 = no physical memory map stored
+} VMMPMEMZ_FOOTER, *PVMMPMEMZ_FOOTER;
+
+/*
+* Export the physical memory of the currently analyzed system to a seekable
+* compressed memory image file (.pmemz).
+* NB! requires an initialized vmm context.
+* -- szFileName = file to create - any existing file will be overwritten.
+* -- return
+*/
+_Success_(return)
+BOOL VmmPmemz_Export(_In_ LPSTR szFileName);
+
+/*
+* Open a seekable compressed memory image file (.pmemz) as a memory source.
+* Files which are not .pmemz files are rejected without error messages - this
+* allows the caller to probe device strings.
+* NB! may be called before the vmm context is initialized.
+* CALLER VmmPmemz_Close: return
+* -- szFileName = file name, optionally prefixed by 'file://'.
+* -- ppaMax = receives the max physical address of the image.
+* -- return = handle to be closed with VmmPmemz_Close, NULL on fail.
+*/
+_Success_(return != NULL)
+PVOID VmmPmemz_Open(_In_ LPSTR szFileName, _Out_ PQWORD ppaMax);
+
+/*
+* Read scatter physical memory from an opened .pmemz image. Only MEMs which
+* are not already successfully read will be read. The function is thread-safe.
+* -- hPmemz
+* -- cMEMs
+* -- ppMEMs
+*/
+VOID VmmPmemz_ReadScatter(_In_ PVOID hPmemz, _In_ DWORD cMEMs, _Inout_ PPMEM_SCATTER ppMEMs);
+
+/*
+* Read a contiguous range of physical memory from an opened .pmemz image.
+* -- hPmemz
+* -- pa
+* -- cb
+* -- pb
+* -- return = TRUE if the whole range was read, FALSE otherwise.
+*/
+_Success_(return)
+BOOL VmmPmemz_Read(_In_ PVOID hPmemz, _In_ QWORD pa, _In_ DWORD cb, _Out_writes_(cb) PBYTE pb);
+
+/*
+* Check whether a physical memory map is in effect for an opened .pmemz image -
+* i.e. if it was stored in the image or has been set by VmmPmemz_MemMapSet.
+* -- hPmemz
+* -- return
+*/
+BOOL VmmPmemz_MemMapExists(_In_ PVOID hPmemz);
+
+/*
+* Set the physical memory map of an opened .pmemz image. Reads outside of the
+* memory map will fail.
+* -- hPmemz
+* -- cMap
+* -- pMap = sorted non-overlapping ranges.
+* -- ppaMax = receives the new max physical address.
+* -- return
+*/
+_Success_(return)
+BOOL VmmPmemz_MemMapSet(_In_ PVOID hPmemz, _In_ DWORD cMap, _In_reads_(cMap) PVMM_MAP_PHYSMEMENTRY pMap, _Out_ PQWORD ppaMax);
+
+/*
+* Retrieve a device option (LC_OPT_*) of an opened .pmemz image. Only options
+* meaningful for a memory image are supported (LC_OPT_CORE_ADDR_MAX).
+* -- hPmemz
+* -- fOption
+* -- pqwValue
+* -- return
+*/
+_Success_(return)
+BOOL VmmPmemz_GetOption(_In_ PVOID hPmemz, _In_ QWORD fOption, _Out_ PQWORD pqwValue);
+
+/*
+* Close an opened .pmemz image.
+* -- hPmemz
+*/
+VOID VmmPmemz_Close(_In_opt_ _Post_ptr_invalid_ PVOID hPmemz);
+
+#endif /* __VMMPMEMZ_H__ */
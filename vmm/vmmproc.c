@@ -51,6 +51,8 @@ BOOL VmmProc_RefreshProcesses(_In_ BOOL fRefreshTotal)
     // statistic count
     if(!fRefreshTotal) { InterlockedIncrement64(&ctxVmm->stat.cProcessRefreshPartial); }
     if(fRefreshTotal) { InterlockedIncrement64(&ctxVmm->stat.cProcessRefreshFull); }
+    // rendered map texts are only valid until next refresh
+    VmmMapText_Clear();
     // Single user-defined X64 process
     if(fRefreshTotal) {
         if(ctxVmm->tpSystem == VMM_SYSTEM_UNKNOWN_X64) {
@@ -142,6 +144,7 @@ DWORD VmmProcCacheUpdaterThread()
             }
             if(fProcTotal) {
                 VmmNet_Refresh();
+                VmmWinPool_Refresh();
                 VmmWinObj_Refresh();
                 PluginManager_Notify(VMMDLL_PLUGIN_NOTIFY_REFRESH_MEDIUM, NULL, 0);
             }
@@ -2012,15 +2012,23 @@ VOID VmmWinHandle_InitializeCore_DoWork(_In_ PVMM_PROCESS pSystemProcess, _In_ P
     BOOL f32 = ctxVmm->f32;
     BYTE pb[0x20], iLevel;
     WORD oTableCode;
-    DWORD i, cHandles, iHandleMap = 0;
+    DWORD i, cHandles, iHandleMap = 0, dwPoolTag;
     QWORD vaHandleTable = 0, vaTableCode = 0;
     VMMWIN_INITIALIZE_HANDLE_CONTEXT ctx = { 0 };
     PVMMOB_MAP_HANDLE pObHandleMap = NULL;
     ctx.pSystemProcess = pSystemProcess;
     ctx.pProcess = pProcess;
     vaHandleTable = VMM_PTR_OFFSET(f32, pProcess->win.EPROCESS.pb, ctxVmm->offset.EPROCESS.ObjectTable);
-    if(!VMM_KADDR(vaHandleTable) || !VmmRead(pSystemProcess, vaHandleTable - 0x10, pb, 0x20)) { return; }
-    if(!VMM_POOLTAG_PREPENDED(pb, 0x10, 'Obtb') && !VMM_KADDR_PAGE(vaHandleTable)) { return; }
+    if(!VMM_KADDR(vaHandleTable)) { return; }
+    if(VMM_KADDR_PAGE(vaHandleTable) && VmmMap_GetPoolTagByAddress(vaHandleTable, FALSE, &dwPoolTag)) {
+        // page-aligned table tracked by the big pool index - verify tag by index
+        // and skip reading the (non-existing) pool header on the preceding page.
+        if(!VMM_POOLTAG(dwPoolTag, 'Obtb') || !VmmRead(pSystemProcess, vaHandleTable, pb + 0x10, 0x10)) { return; }
+        InterlockedIncrement64(&ctxVmm->stat.cPoolIndexReadSaved);
+    } else {
+        if(!VmmRead(pSystemProcess, vaHandleTable - 0x10, pb, 0x20)) { return; }
+        if(!VMM_POOLTAG_PREPENDED(pb, 0x10, 'Obtb') && !VMM_KADDR_PAGE(vaHandleTable)) { return; }
+    }
     oTableCode = (ctxVmm->kernel.dwVersionBuild < 9200) ? 0 : 8;    // WinXP::Win7 -> 0, otherwise 8.
     vaTableCode = VMM_PTR_OFFSET(f32, pb + 0x10, oTableCode) & ~7;
     iLevel = VMM_PTR_OFFSET(f32, pb + 0x10, oTableCode) & 7;
@@ -2202,6 +2210,121 @@ VOID VmmWinPhysMemMap_Refresh()
     ObContainer_SetOb(ctxVmm->pObCMapPhysMem, NULL);
 }
 
+// ----------------------------------------------------------------------------
+// BIG POOL FUNCTIONALITY BELOW:
+//
+// The big pool functionality is responsible for indexing the kernel big pool
+// tracker table (nt!PoolBigPageTable) into a map of allocation address, size
+// and pool tag. The table is read in one go once per total refresh; lookups in
+// the map replace pool header reads of page-aligned allocations - which do not
+// have a prepended pool header.
+// ----------------------------------------------------------------------------
+
+#define VMMWIN_POOL_BIGPAGES_MAX            0x00200000
+
+int VmmWinPool_Initialize_CmpPoolEntry(PVMM_MAP_POOLENTRY v1, PVMM_MAP_POOLENTRY v2)
+{
+    return
+        (v1->va < v2->va) ? -1 :
+        (v1->va > v2->va) ? 1 : 0;
+}
+
+PVMMOB_MAP_POOL VmmWinPool_Initialize_DoWork(_In_ PVMM_PROCESS pSystemProcess)
+{
+    BOOL f32 = ctxVmm->f32;
+    PBYTE pbTable = NULL, pbEntry;
+    PQWORD pqwTag = NULL;
+    DWORD i, cMap = 0, cbEntry, oKey, oNumberOfBytes;
+    QWORD va, vaTable = 0, cTable = 0, tcStart = GetTickCount64();
+    PVMMOB_MAP_POOL pObPoolMap = NULL;
+    PVMM_MAP_POOLENTRY pe;
+    // 1: resolve table location and entry layout from kernel debug symbols.
+    if(!PDB_GetSymbolPTR(PDB_HANDLE_KERNEL, "PoolBigPageTable", pSystemProcess, &vaTable) || !VMM_KADDR_PAGE(vaTable)) { goto fail; }
+    if(!PDB_GetSymbolPTR(PDB_HANDLE_KERNEL, "PoolBigPageTableSize", pSystemProcess, &cTable) || !cTable || (cTable > VMMWIN_POOL_BIGPAGES_MAX)) { goto fail; }
+    if(!PDB_GetTypeSize(PDB_HANDLE_KERNEL, "_POOL_TRACKER_BIG_PAGES", &cbEntry)) { cbEntry = f32 ? 0x10 : 0x18; }
+    if(!PDB_GetTypeChildOffset(PDB_HANDLE_KERNEL, "_POOL_TRACKER_BIG_PAGES", L"Key", &oKey)) { oKey = f32 ? 0x04 : 0x08; }
+    if(!PDB_GetTypeChildOffset(PDB_HANDLE_KERNEL, "_POOL_TRACKER_BIG_PAGES", L"NumberOfBytes", &oNumberOfBytes)) { oNumberOfBytes = f32 ? 0x0c : 0x10; }
+    if((cbEntry > 0x40) || (oKey + 4 > cbEntry) || (oNumberOfBytes + (f32 ? 4 : 8) > cbEntry)) { goto fail; }
+    // 2: read the whole table in one read - the read is split into bounded
+    //    windows by VmmReadEx if large. Free entries have the low bit of the
+    //    address set.
+    if(!VmmReadAlloc(pSystemProcess, vaTable, &pbTable, (DWORD)cTable * cbEntry, VMM_FLAG_ZEROPAD_ON_FAIL)) { goto fail; }
+    for(i = 0; i < cTable; i++) {
+        va = VMM_PTR_OFFSET(f32, pbTable + (QWORD)i * cbEntry, 0);
+        if(VMM_KADDR_PAGE(va)) { cMap++; }
+    }
+    // 3: allocate and populate map sorted by address.
+    if(!(pObPoolMap = Ob_Alloc(OB_TAG_MAP_POOL, LMEM_ZEROINIT, sizeof(VMMOB_MAP_POOL) + cMap * (sizeof(VMM_MAP_POOLENTRY) + sizeof(DWORD)), NULL, NULL))) { goto fail; }
+    pObPoolMap->piTag = (PDWORD)(pObPoolMap->pMap + cMap);
+    for(i = 0; (i < cTable) && (pObPoolMap->cMap < cMap); i++) {
+        pbEntry = pbTable + (QWORD)i * cbEntry;
+        va = VMM_PTR_OFFSET(f32, pbEntry, 0);
+        if(!VMM_KADDR_PAGE(va)) { continue; }
+        pe = pObPoolMap->pMap + pObPoolMap->cMap++;
+        pe->va = va;
+        pe->cb = VMM_PTR_OFFSET(f32, pbEntry, oNumberOfBytes);
+        pe->dwPoolTag = *(PDWORD)(pbEntry + oKey);
+    }
+    cMap = pObPoolMap->cMap;
+    qsort(pObPoolMap->pMap, cMap, sizeof(VMM_MAP_POOLENTRY), (int(*)(const void*, const void*))VmmWinPool_Initialize_CmpPoolEntry);
+    // 4: create tag index - sort (tag, index) pairs and keep the index.
+    if(cMap) {
+        if(!(pqwTag = LocalAlloc(0, cMap * sizeof(QWORD)))) { goto fail; }
+        for(i = 0; i < cMap; i++) {
+            pqwTag[i] = ((QWORD)pObPoolMap->pMap[i].dwPoolTag << 32) | i;
+        }
+        qsort(pqwTag, cMap, sizeof(QWORD), Util_qsort_QWORD);
+        for(i = 0; i < cMap; i++) {
+            pObPoolMap->piTag[i] = (DWORD)pqwTag[i];
+        }
+    }
+    InterlockedIncrement64(&ctxVmm->stat.cPoolIndexRefresh);
+    vmmprintfvv_fn("big pool index: %i allocations (%i table entries) in %llims\n", cMap, (DWORD)cTable, GetTickCount64() - tcStart);
+    LocalFree(pqwTag);
+    LocalFree(pbTable);
+    return pObPoolMap;
+fail:
+    Ob_DECREF(pObPoolMap);
+    LocalFree(pqwTag);
+    LocalFree(pbTable);
+    return NULL;
+}
+
+/*
+* Create a big pool map and assign to the global context upon success.
+* CALLER DECREF: return
+* -- return
+*/
+PVMMOB_MAP_POOL VmmWinPool_Initialize()
+{
+    PVMM_PROCESS pObSystemProcess = NULL;
+    PVMMOB_MAP_POOL pObPool;
+    if((pObPool = ObContainer_GetOb(ctxVmm->pObCMapPool))) { return pObPool; }
+    EnterCriticalSection(&ctxVmm->LockUpdateMap);
+    if((pObPool = ObContainer_GetOb(ctxVmm->pObCMapPool))) {
+        LeaveCriticalSection(&ctxVmm->LockUpdateMap);
+        return pObPool;
+    }
+    if((pObSystemProcess = VmmProcessGet(4))) {
+        pObPool = VmmWinPool_Initialize_DoWork(pObSystemProcess);
+        Ob_DECREF_NULL(&pObSystemProcess);
+    }
+    if(!pObPool) {
+        pObPool = Ob_Alloc(OB_TAG_MAP_POOL, LMEM_ZEROINIT, sizeof(VMMOB_MAP_POOL), NULL, NULL);
+    }
+    ObContainer_SetOb(ctxVmm->pObCMapPool, pObPool);
+    LeaveCriticalSection(&ctxVmm->LockUpdateMap);
+    return pObPool;
+}
+
+/*
+* Refresh the big pool map.
+*/
+VOID VmmWinPool_Refresh()
+{
+    ObContainer_SetOb(ctxVmm->pObCMapPool, NULL);
+}
+
 // ----------------------------------------------------------------------------
 // USER FUNCTIONALITY BELOW:
 //
@@ -2210,6 +2333,44 @@ VOID VmmWinPhysMemMap_Refresh()
 // well known and system-specific.
 // ----------------------------------------------------------------------------
 
+#define VMMWINUSER_NAMECACHE_MAX        0x1000
+#define VMMWINUSER_HIVECACHE_MAX        0x0400
+
+typedef struct tdVMMWINUSER_NAME_ENTRY {
+    BOOL fLookup;
+    BOOL fWellKnown;
+    DWORD cwszName;
+    WCHAR wszName[MAX_PATH + 1];
+} VMMWINUSER_NAME_ENTRY, *PVMMWINUSER_NAME_ENTRY;
+
+typedef struct tdVMMWINUSER_HIVE_ENTRY {
+    QWORD vaHBASE_BLOCK;
+    DWORD dwHashName;
+    DWORD cbSID;
+    BYTE pbSID[SECURITY_MAX_SID_SIZE];
+    WCHAR wszUser[MAX_PATH];
+} VMMWINUSER_HIVE_ENTRY, *PVMMWINUSER_HIVE_ENTRY;
+
+/*
+* Helper function for VmmWinUser_GetNameW to return a name from a cached
+* LookupAccountSidW result.
+*/
+_Success_(return)
+BOOL VmmWinUser_GetNameW_FromEntry(_In_ PVMMWINUSER_NAME_ENTRY pe, _Out_writes_opt_(cwszName) LPWSTR wszName, _In_ DWORD cwszName, _Out_opt_ PDWORD pcwszName, _Out_opt_ PBOOL pfAccountWellKnown)
+{
+    if(!pe->fWellKnown) { return FALSE; }
+    if(pfAccountWellKnown) { *pfAccountWellKnown = TRUE; }
+    if(pcwszName) {
+        *pcwszName = (pe->cwszName == MAX_PATH) ? 0 : pe->cwszName;
+        if(!wszName) { return TRUE; }
+    }
+    if(pe->fLookup && wszName && (cwszName >= pe->cwszName)) {
+        wcscpy_s(wszName, cwszName, pe->wszName);
+        return TRUE;
+    }
+    return FALSE;
+}
+
 /*
 * Retrieve the account name and length of the user account given a SID.
 * NB! Names for well known SIDs will be given in the language of the system
@@ -2224,12 +2385,13 @@ VOID VmmWinPhysMemMap_Refresh()
 _Success_(return)
 BOOL VmmWinUser_GetNameW(_In_opt_ PSID pSID, _Out_writes_opt_(cwszName) LPWSTR wszName, _In_ DWORD cwszName, _Out_opt_ PDWORD pcwszName, _Out_opt_ PBOOL pfAccountWellKnown)
 {
-    BOOL f;
+    BOOL f, fResult;
     SID_NAME_USE eUse;
     DWORD i, cwszNameBuffer = MAX_PATH, cwszDomainBuffer = MAX_PATH, dwHashSID;
     WCHAR wszNameBuffer[MAX_PATH+1], wszDomainBuffer[MAX_PATH+1];
     LPSTR szSID = NULL;
     PVMMOB_MAP_USER pObUser = NULL;
+    PVMMWINUSER_NAME_ENTRY peName;
     if(!pSID) { return FALSE; }
     if(pfAccountWellKnown) { *pfAccountWellKnown = FALSE; }
     // 1: Try lookup name from User Map
@@ -2257,21 +2419,23 @@ BOOL VmmWinUser_GetNameW(_In_opt_ PSID pSID, _Out_writes_opt_(cwszName) LPWSTR w
         }
         Ob_DECREF_NULL(&pObUser);
     }
-    // 2: Try lookup name from Well Known SID
-    f = LookupAccountSidW(NULL, pSID, wszNameBuffer, &cwszNameBuffer, wszDomainBuffer, &cwszDomainBuffer, &eUse);
-    if(cwszDomainBuffer != MAX_PATH) {
-        if(pfAccountWellKnown) { *pfAccountWellKnown = TRUE; }
-        if(pcwszName) {
-            *pcwszName = (cwszNameBuffer == MAX_PATH) ? 0 : cwszNameBuffer;
-            if(!wszName) { return TRUE; }
+    // 2: Try lookup name from Well Known SID (cached by SID hash)
+    if(!(peName = ObMap_GetByKey(ctxVmm->UserCache.pmName, dwHashSID))) {
+        f = LookupAccountSidW(NULL, pSID, wszNameBuffer, &cwszNameBuffer, wszDomainBuffer, &cwszDomainBuffer, &eUse);
+        if(!(peName = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMWINUSER_NAME_ENTRY)))) { return FALSE; }
+        peName->fLookup = f;
+        peName->fWellKnown = (cwszDomainBuffer != MAX_PATH);
+        peName->cwszName = cwszNameBuffer;
+        if(f) {
+            wcsncpy_s(peName->wszName, _countof(peName->wszName), wszNameBuffer, _TRUNCATE);
         }
-        if(f && wszName && (cwszName >= cwszNameBuffer)) {
-            wcscpy_s(wszName, cwszName, wszNameBuffer);
-            return TRUE;
+        if((ObMap_Size(ctxVmm->UserCache.pmName) >= VMMWINUSER_NAMECACHE_MAX) || !ObMap_Push(ctxVmm->UserCache.pmName, dwHashSID, peName)) {
+            fResult = VmmWinUser_GetNameW_FromEntry(peName, wszName, cwszName, pcwszName, pfAccountWellKnown);
+            LocalFree(peName);
+            return fResult;
         }
-        return FALSE;
     }
-    return FALSE;
+    return VmmWinUser_GetNameW_FromEntry(peName, wszName, cwszName, pcwszName, pfAccountWellKnown);
 }
 
 /*
@@ -2306,8 +2470,10 @@ PVMMOB_MAP_USER VmmWinUser_Initialize_DoWork()
         DWORD cchUser;
         WCHAR wszUser[MAX_PATH];
     } VMMWINUSER_CONTEXT_ENTRY, *PVMMWINUSER_CONTEXT_ENTRY;
-    DWORD i, dwType, cchUserTotal = 1, oMultiText = 1;
+    BOOL fCacheHit;
+    DWORD i, dwType, dwHashName, cchUserTotal = 1, oMultiText = 1, cCacheHit = 0;
     LPSTR szNtdat, szUser;
+    PVMMWINUSER_HIVE_ENTRY peHive;
     LPWSTR wszSymlinkSid, wszSymlinkUser;
     WCHAR wszSymlinkValue[MAX_PATH];
     POB_REGISTRY_HIVE pObHive = NULL;
@@ -2325,32 +2491,43 @@ PVMMOB_MAP_USER VmmWinUser_Initialize_DoWork()
         if(!szNtdat && !szUser) { continue; }
         if(!szUser && !StrStrIA(szNtdat, "-unknown")) { continue; }
         if(szUser && ((strlen(szUser) < 20) || StrStrIA(szUser, "Classes"))) { continue; }
-        // get username
-        if(!VmmWinReg_ValueQuery1(pObHive, L"ROOT\\Volatile Environment\\USERNAME", &dwType, (PBYTE)e->wszUser, sizeof(e->wszUser) - 2, NULL, 0) || (dwType != REG_SZ)) {
-            if(ctxVmm->kernel.dwVersionBuild > 2600) { continue; }      // allow missing USERNAME if WinXP
-        }
-        // get sid
-        if(szUser) {
-            ConvertStringSidToSidA(szUser + 6, &e->pSID);
-        }
-        if(!e->pSID) {
-            i = 0;
-            ZeroMemory(wszSymlinkValue, sizeof(wszSymlinkValue));
-            if(!VmmWinReg_ValueQuery1(pObHive, L"ROOT\\Software\\Classes\\SymbolicLinkValue", &dwType, (PBYTE)wszSymlinkValue, sizeof(wszSymlinkValue) - 2, NULL, 0) || (dwType != REG_LINK)) { continue; }
-            if(!(wszSymlinkSid = wcsstr(wszSymlinkValue, L"\\S-"))) { continue; }
-            if(wcslen(wszSymlinkSid) < 20) { continue; }
-            while(wszSymlinkSid[i] && (wszSymlinkSid[i] != L'_') && ++i);
-            wszSymlinkSid[i] = 0;
-            if(!ConvertStringSidToSidW(wszSymlinkSid + 1, &e->pSID) || !e->pSID) { continue; }
-        }
-        // get username - WinXP only
-        if(!e->wszUser[0]) {
-            i = 0;
-            wszSymlinkUser = wszSymlinkValue + 10;
-            while(wszSymlinkUser[i] && (wszSymlinkUser[i] != L'\\') && ++i);
-            if(i == 0) { continue; }
-            wszSymlinkUser[i] = 0;
-            wcsncpy_s(e->wszUser, MAX_PATH, wszSymlinkUser, _TRUNCATE);
+        // get sid and username from cache (valid across refreshes) or from hive
+        dwHashName = Util_HashStringA(pObHive->szName);
+        peHive = ObMap_GetByKey(ctxVmm->UserCache.pmHive, pObHive->vaCMHIVE);
+        fCacheHit = peHive && (peHive->vaHBASE_BLOCK == pObHive->vaHBASE_BLOCK) && (peHive->dwHashName == dwHashName);
+        if(fCacheHit) {
+            if(!(e->pSID = LocalAlloc(0, peHive->cbSID))) { continue; }
+            memcpy(e->pSID, peHive->pbSID, peHive->cbSID);
+            wcsncpy_s(e->wszUser, MAX_PATH, peHive->wszUser, _TRUNCATE);
+            cCacheHit++;
+        } else {
+            // get username
+            if(!VmmWinReg_ValueQuery1(pObHive, L"ROOT\\Volatile Environment\\USERNAME", &dwType, (PBYTE)e->wszUser, sizeof(e->wszUser) - 2, NULL, 0) || (dwType != REG_SZ)) {
+                if(ctxVmm->kernel.dwVersionBuild > 2600) { continue; }      // allow missing USERNAME if WinXP
+            }
+            // get sid
+            if(szUser) {
+                ConvertStringSidToSidA(szUser + 6, &e->pSID);
+            }
+            if(!e->pSID) {
+                i = 0;
+                ZeroMemory(wszSymlinkValue, sizeof(wszSymlinkValue));
+                if(!VmmWinReg_ValueQuery1(pObHive, L"ROOT\\Software\\Classes\\SymbolicLinkValue", &dwType, (PBYTE)wszSymlinkValue, sizeof(wszSymlinkValue) - 2, NULL, 0) || (dwType != REG_LINK)) { continue; }
+                if(!(wszSymlinkSid = wcsstr(wszSymlinkValue, L"\\S-"))) { continue; }
+                if(wcslen(wszSymlinkSid) < 20) { continue; }
+                while(wszSymlinkSid[i] && (wszSymlinkSid[i] != L'_') && ++i);
+                wszSymlinkSid[i] = 0;
+                if(!ConvertStringSidToSidW(wszSymlinkSid + 1, &e->pSID) || !e->pSID) { continue; }
+            }
+            // get username - WinXP only
+            if(!e->wszUser[0]) {
+                i = 0;
+                wszSymlinkUser = wszSymlinkValue + 10;
+                while(wszSymlinkUser[i] && (wszSymlinkUser[i] != L'\\') && ++i);
+                if(i == 0) { continue; }
+                wszSymlinkUser[i] = 0;
+                wcsncpy_s(e->wszUser, MAX_PATH, wszSymlinkUser, _TRUNCATE);
+            }
         }
         // get length and hash of sid string
         e->vaHive = pObHive->vaCMHIVE;
@@ -2360,6 +2537,21 @@ PVMMOB_MAP_USER VmmWinUser_Initialize_DoWork()
             continue;
         }
         e->dwHashSID = Util_HashStringA(e->szSID);
+        if(!fCacheHit && (e->cbSID <= SECURITY_MAX_SID_SIZE)) {
+            if(!peHive && (ObMap_Size(ctxVmm->UserCache.pmHive) < VMMWINUSER_HIVECACHE_MAX) && (peHive = LocalAlloc(0, sizeof(VMMWINUSER_HIVE_ENTRY)))) {
+                if(!ObMap_Push(ctxVmm->UserCache.pmHive, pObHive->vaCMHIVE, peHive)) {
+                    LocalFree(peHive);
+                    peHive = NULL;
+                }
+            }
+            if(peHive) {
+                peHive->vaHBASE_BLOCK = pObHive->vaHBASE_BLOCK;
+                peHive->dwHashName = dwHashName;
+                peHive->cbSID = e->cbSID;
+                memcpy(peHive->pbSID, e->pSID, e->cbSID);
+                wcsncpy_s(peHive->wszUser, MAX_PATH, e->wszUser, _TRUNCATE);
+            }
+        }
         // store context in map
         e->cchUser = (DWORD)wcslen(e->wszUser);
         cchUserTotal += e->cchUser + 1;
@@ -2367,6 +2559,7 @@ PVMMOB_MAP_USER VmmWinUser_Initialize_DoWork()
         e = NULL;
     }
     LocalFree(e);
+    vmmprintfvv_fn("users: %i hive cache hits: %i\n", ObSet_Size(pObSet), cCacheHit);
     // 2: create user map and assign data
     if(!(pObMapUser = Ob_Alloc(OB_TAG_MAP_USER, LMEM_ZEROINIT, sizeof(VMMOB_MAP_USER) + ObSet_Size(pObSet) * sizeof(VMM_MAP_USERENTRY), VmmWinUser_CloseObCallback, NULL))) { goto fail; }
     pObMapUser->cMap = ObSet_Size(pObSet);
@@ -2669,61 +2862,85 @@ fail:
     Ob_DECREF(psObOff);
 }
 
+typedef struct tdVMMWIN_PROCESS_POSTPROCESSING_CONTEXT {
+    PVMM_PROCESS pSystemProcess;
+    DWORD cProcess;
+    PVMM_PROCESS ppProcess[];
+} VMMWIN_PROCESS_POSTPROCESSING_CONTEXT, *PVMMWIN_PROCESS_POSTPROCESSING_CONTEXT;
+
+/*
+* Worker callback: fetch "kernel path" and set "long name" for a new process.
+* -- ctx
+* -- i
+*/
+VOID VmmWinProcess_Enumerate_PostProcessing_DoWork(_In_ PVMMWIN_PROCESS_POSTPROCESSING_CONTEXT ctx, _In_ DWORD i)
+{
+    DWORD j;
+    LPWSTR wszPathKernel = NULL;
+    PVMM_PROCESS pProcess = ctx->ppProcess[i];
+    PVMMOB_PROCESS_PERSISTENT pProcPers = pProcess->pObPersistent;
+    pProcPers->fIsPostProcessingComplete = TRUE;
+    if(VmmReadAllocUnicodeString(ctx->pSystemProcess, ctxVmm->f32, VMM_FLAG_FORCECACHE_READ, VMM_EPROCESS_PTR(pProcess, ctxVmm->offset.EPROCESS.SeAuditProcessCreationInfo), 0x400, &wszPathKernel, NULL)) {
+        if(memcmp(wszPathKernel, L"\\Device\\", 16)) {
+            LocalFree(wszPathKernel);
+            wszPathKernel = NULL;
+        }
+    }
+    if(!wszPathKernel) {
+        // Fail - use EPROCESS name
+        if(!(wszPathKernel = LocalAlloc(LMEM_ZEROINIT, 32))) { return; }
+        for(j = 0; j < 15; j++) {
+            wszPathKernel[j] = pProcess->szName[j];
+        }
+    }
+    pProcPers->uszPathKernel = Util_StrDupW2U8(wszPathKernel);
+    pProcPers->cuszPathKernel = (WORD)strlen(pProcPers->uszPathKernel);
+    pProcPers->wszPathKernel = wszPathKernel;
+    pProcPers->cwszPathKernel = (WORD)wcslen(pProcPers->wszPathKernel);
+    // locate FullName by skipping to last \ character.
+    pProcPers->uszNameLong = Util_PathSplitLastA(pProcPers->uszPathKernel);
+    pProcPers->cuszNameLong = (WORD)strlen(pProcPers->uszNameLong);
+    pProcPers->wszNameLong = Util_PathSplitLastW(pProcPers->wszPathKernel);
+    pProcPers->cwszNameLong = (WORD)wcslen(pProcPers->wszNameLong);
+}
+
 /*
 * Post-process new process in the "new" process table before they are comitted VmmProcessCreateFinish()
 * At this moment "only" the full path and name is retrieved by using 'SeAuditProcessCreationInfo'.
+* The memory is prefetched in one batch and the per-process work is then spread
+* out onto the worker thread pool.
 * -- pSystemProcess
 */
 VOID VmmWinProcess_Enumerate_PostProcessing(_In_ PVMM_PROCESS pSystemProcess)
 {
     DWORD i;
-    LPWSTR wszPathKernel;
     POB_SET pObPrefetchAddr = NULL;
     PVMM_PROCESS pObProcess = NULL;
     PVMMOB_PROCESS_TABLE ptObCurrent = NULL, ptObNew = NULL;
-    PVMMOB_PROCESS_PERSISTENT pProcPers;
+    PVMMWIN_PROCESS_POSTPROCESSING_CONTEXT ctx = NULL;
     if(!(pObPrefetchAddr = ObSet_New())) { goto fail; }
     if(!(ptObCurrent = (PVMMOB_PROCESS_TABLE)ObContainer_GetOb(ctxVmm->pObCPROC))) { goto fail; }
     if(!(ptObNew = (PVMMOB_PROCESS_TABLE)ObContainer_GetOb(ptObCurrent->pObCNewPROC))) { goto fail; }
+    if(!(ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMWIN_PROCESS_POSTPROCESSING_CONTEXT) + ptObNew->c * sizeof(PVMM_PROCESS)))) { goto fail; }
+    ctx->pSystemProcess = pSystemProcess;
     // 1: Iterate to gather memory locations of "SeAuditProcessCreationInfo" / "kernel path" for new processes
     while((pObProcess = VmmProcessGetNextEx(ptObNew, pObProcess, VMM_FLAG_PROCESS_SHOW_TERMINATED))) {
-        if(!pObProcess->pObPersistent->fIsPostProcessingComplete) {
+        if(!pObProcess->pObPersistent->fIsPostProcessingComplete && (ctx->cProcess < ptObNew->c)) {
             ObSet_Push_PageAlign(pObPrefetchAddr, VMM_EPROCESS_PTR(pObProcess, ctxVmm->offset.EPROCESS.SeAuditProcessCreationInfo), 540);
+            ctx->ppProcess[ctx->cProcess++] = (PVMM_PROCESS)Ob_INCREF(pObProcess);
         }
     }
     if(0 == ObSet_Size(pObPrefetchAddr)) { goto fail; }
     VmmCachePrefetchPages(pSystemProcess, pObPrefetchAddr, 0);
-    // 2: Fetch "kernel path" and set "long name" for new processes.
-    while((pObProcess = VmmProcessGetNextEx(ptObNew, pObProcess, VMM_FLAG_PROCESS_SHOW_TERMINATED))) {
-        pProcPers = pObProcess->pObPersistent;
-        if(!pProcPers->fIsPostProcessingComplete) {
-            pProcPers->fIsPostProcessingComplete = TRUE;
-            wszPathKernel = NULL;
-            if(VmmReadAllocUnicodeString(pSystemProcess, ctxVmm->f32, VMM_FLAG_FORCECACHE_READ, VMM_EPROCESS_PTR(pObProcess, ctxVmm->offset.EPROCESS.SeAuditProcessCreationInfo), 0x400, &wszPathKernel, NULL)) {
-                if(memcmp(wszPathKernel, L"\\Device\\", 16)) {
-                    LocalFree(wszPathKernel);
-                    wszPathKernel = NULL;
-                }
-            }
-            if(!wszPathKernel) {
-                // Fail - use EPROCESS name
-                if(!(wszPathKernel = LocalAlloc(LMEM_ZEROINIT, 32))) { continue; }
-                for(i = 0; i < 15; i++) {
-                    wszPathKernel[i] = pObProcess->szName[i];
-                }
-            }
-            pProcPers->uszPathKernel = Util_StrDupW2U8(wszPathKernel);
-            pProcPers->cuszPathKernel = (WORD)strlen(pProcPers->uszPathKernel);
-            pProcPers->wszPathKernel = wszPathKernel;
-            pProcPers->cwszPathKernel = (WORD)wcslen(pProcPers->wszPathKernel);
-            // locate FullName by skipping to last \ character.
-            pProcPers->uszNameLong = Util_PathSplitLastA(pProcPers->uszPathKernel);
-            pProcPers->cuszNameLong = (WORD)strlen(pProcPers->uszNameLong);
-            pProcPers->wszNameLong = Util_PathSplitLastW(pProcPers->wszPathKernel);
-            pProcPers->cwszNameLong = (WORD)wcslen(pProcPers->wszNameLong);
+    // 2: Fetch "kernel path" and set "long name" for new processes in parallel.
+    VmmWorkParallelForeach(ctx->cProcess, ctx, (VOID(*)(PVOID, DWORD))VmmWinProcess_Enumerate_PostProcessing_DoWork);
+fail:
+    if(ctx) {
+        for(i = 0; i < ctx->cProcess; i++) {
+            Ob_DECREF(ctx->ppProcess[i]);
         }
+        LocalFree(ctx);
     }
-fail:
     Ob_DECREF(pObProcess);
     Ob_DECREF(pObPrefetchAddr);
     Ob_DECREF(ptObCurrent);
@@ -2735,8 +2952,89 @@ typedef struct tdVMMWIN_ENUMERATE_EPROCESS_CONTEXT {
     BOOL fTotalRefresh;
     DWORD cNewProcessCollision;
     POB_SET pObSetPrefetchDTB;
+    POB_MAP pmEPROCESS;             // captured EPROCESS (VMMWIN_ENUMERATE_EPROCESS_ENTRY) keyed by va
 } VMMWIN_ENUMERATE_EPROCESS_CONTEXT, *PVMMWIN_ENUMERATE_EPROCESS_CONTEXT;
 
+typedef struct tdVMMWIN_ENUMERATE_EPROCESS_ENTRY {
+    QWORD va;
+    DWORD cb;
+    BYTE pb[];
+} VMMWIN_ENUMERATE_EPROCESS_ENTRY, *PVMMWIN_ENUMERATE_EPROCESS_ENTRY;
+
+/*
+* List traversal callback: capture the EPROCESS for later processing.
+*/
+VOID VmmWinProcess_Enumerate_Capture_Post(_In_ PVMM_PROCESS pSystemProcess, _In_opt_ PVMMWIN_ENUMERATE_EPROCESS_CONTEXT ctx, _In_ QWORD va, _In_ PBYTE pb, _In_ DWORD cb)
+{
+    PVMMWIN_ENUMERATE_EPROCESS_ENTRY pe;
+    if(!ctx || !(pe = LocalAlloc(0, sizeof(VMMWIN_ENUMERATE_EPROCESS_ENTRY) + cb))) { return; }
+    pe->va = va;
+    pe->cb = cb;
+    memcpy(pe->pb, pb, cb);
+    if(!ObMap_Push(ctx->pmEPROCESS, va, pe)) {
+        LocalFree(pe);
+    }
+}
+
+/*
+* Worker callback: load and verify the page directory base of an active
+* captured EPROCESS into the TLB cache ahead of process entry creation.
+*/
+VOID VmmWinProcess_Enumerate_TlbWarm_DoWork(_In_ PVMMWIN_ENUMERATE_EPROCESS_CONTEXT ctx, _In_ DWORD i)
+{
+    QWORD paDTB;
+    PVMM_OFFSET_EPROCESS po = &ctxVmm->offset.EPROCESS;
+    PVMMWIN_ENUMERATE_EPROCESS_ENTRY pe = ObMap_GetByIndex(ctx->pmEPROCESS, i);
+    if(!pe || *(PDWORD)(pe->pb + po->State)) { return; }
+    paDTB = ctxVmm->f32 ? *(PDWORD)(pe->pb + po->DTB) : *(PQWORD)(pe->pb + po->DTB);
+    Ob_DECREF(VmmTlbGetPageTable(paDTB & ~0xfff, FALSE));
+}
+
+/*
+* Enumerate processes by walking the EPROCESS list. The EPROCESS bodies are
+* captured in batches by the list traversal, page directory bases are fetched
+* and verified in parallel on the worker thread pool and process entries are
+* then created in list order by calling pfnCallback_Post on each EPROCESS.
+* -- pSystemProcess
+* -- ctx
+* -- pfnCallback_Pre
+* -- pfnCallback_Post
+*/
+VOID VmmWinProcess_Enumerate_CaptureAndCreate(
+    _In_ PVMM_PROCESS pSystemProcess,
+    _In_ PVMMWIN_ENUMERATE_EPROCESS_CONTEXT ctx,
+    _In_ VOID(*pfnCallback_Pre)(_In_ PVMM_PROCESS pProcess, _In_opt_ PVMMWIN_ENUMERATE_EPROCESS_CONTEXT ctx, _In_ QWORD va, _In_ PBYTE pb, _In_ DWORD cb, _In_ QWORD vaFLink, _In_ QWORD vaBLink, _In_ POB_SET pVSetAddress, _Inout_ PBOOL pfValidEntry, _Inout_ PBOOL pfValidFLink, _Inout_ PBOOL pfValidBLink),
+    _In_ VOID(*pfnCallback_Post)(_In_ PVMM_PROCESS pSystemProcess, _In_opt_ PVMMWIN_ENUMERATE_EPROCESS_CONTEXT ctx, _In_ QWORD va, _In_ PBYTE pb, _In_ DWORD cb)
+) {
+    DWORD i, c;
+    PVMMWIN_ENUMERATE_EPROCESS_ENTRY pe;
+    if(!(ctx->pmEPROCESS = ObMap_New(OB_MAP_FLAGS_OBJECT_LOCALFREE))) { return; }
+    // 1: capture EPROCESS bodies (batch prefetched by list traversal)
+    VmmWin_ListTraversePrefetch(
+        pSystemProcess,
+        ctxVmm->f32,
+        ctx,
+        1,
+        &pSystemProcess->win.EPROCESS.va,
+        ctxVmm->offset.EPROCESS.FLink,
+        ctxVmm->offset.EPROCESS.cbMaxOffset,
+        (VOID(*)(PVMM_PROCESS, PVOID, QWORD, PBYTE, DWORD, QWORD, QWORD, POB_SET, PBOOL, PBOOL, PBOOL))pfnCallback_Pre,
+        (VOID(*)(PVMM_PROCESS, PVOID, QWORD, PBYTE, DWORD))VmmWinProcess_Enumerate_Capture_Post,
+        ctxVmm->pObCCachePrefetchEPROCESS);
+    // 2: prefetch page directory bases and verify them in parallel
+    c = ObMap_Size(ctx->pmEPROCESS);
+    VmmCachePrefetchPages(NULL, ctx->pObSetPrefetchDTB, 0);
+    Ob_DECREF_NULL(&ctx->pObSetPrefetchDTB);
+    VmmWorkParallelForeach(c, ctx, (VOID(*)(PVOID, DWORD))VmmWinProcess_Enumerate_TlbWarm_DoWork);
+    // 3: create process entries in list order (single-threaded)
+    for(i = 0; i < c; i++) {
+        if((pe = ObMap_GetByIndex(ctx->pmEPROCESS, i))) {
+            pfnCallback_Post(pSystemProcess, ctx, pe->va, pe->pb, pe->cb);
+        }
+    }
+    Ob_DECREF_NULL(&ctx->pmEPROCESS);
+}
+
 VOID VmmWinProcess_Enum64_Pre(_In_ PVMM_PROCESS pProcess, _In_opt_ PVMMWIN_ENUMERATE_EPROCESS_CONTEXT ctx, _In_ QWORD va, _In_ PBYTE pb, _In_ DWORD cb, _In_ QWORD vaFLink, _In_ QWORD vaBLink, _In_ POB_SET pVSetAddress, _Inout_ PBOOL pfValidEntry, _Inout_ PBOOL pfValidFLink, _Inout_ PBOOL pfValidBLink)
 {
     if(!ctx || !VMM_KADDR64_16(va)) { return; }
@@ -2850,18 +3148,7 @@ BOOL VmmWinProcess_Enum64(_In_ PVMM_PROCESS pSystemProcess, _In_ BOOL fTotalRefr
     if(!(ctx.pObSetPrefetchDTB = ObSet_New())) { return FALSE; }
     // traverse EPROCESS linked list
     vmmprintfvv_fn("        # STATE  PID      DTB          EPROCESS         PEB          NAME  \n");
-    VmmWin_ListTraversePrefetch(
-        pSystemProcess,
-        FALSE,
-        &ctx,
-        1,
-        &pSystemProcess->win.EPROCESS.va,
-        ctxVmm->offset.EPROCESS.FLink,
-        ctxVmm->offset.EPROCESS.cbMaxOffset,
-        VmmWinProcess_Enum64_Pre,
-        VmmWinProcess_Enum64_Post,
-        ctxVmm->pObCCachePrefetchEPROCESS);
-    // set resulting prefetch cache
+    VmmWinProcess_Enumerate_CaptureAndCreate(pSystemProcess, &ctx, VmmWinProcess_Enum64_Pre, VmmWinProcess_Enum64_Post);
     Ob_DECREF_NULL(&ctx.pObSetPrefetchDTB);
     VmmWinProcess_Enumerate_PostProcessing(pSystemProcess);
     VmmProcessCreateFinish();
@@ -3140,18 +3427,7 @@ BOOL VmmWinProcess_Enum32(_In_ PVMM_PROCESS pSystemProcess, _In_ BOOL fTotalRefr
     if(!(ctx.pObSetPrefetchDTB = ObSet_New())) { return FALSE; }
     // traverse EPROCESS linked list
     vmmprintfvv_fn("        # STATE  PID      DTB      EPROCESS PEB      NAME\n");
-    VmmWin_ListTraversePrefetch(
-        pSystemProcess,
-        TRUE,
-        &ctx,
-        1,
-        &pSystemProcess->win.EPROCESS.va,
-        ctxVmm->offset.EPROCESS.FLink,
-        ctxVmm->offset.EPROCESS.cbMaxOffset,
-        VmmWinProcess_Enum32_Pre,
-        VmmWinProcess_Enum32_Post,
-        ctxVmm->pObCCachePrefetchEPROCESS);
-    // set resulting prefetch cache
+    VmmWinProcess_Enumerate_CaptureAndCreate(pSystemProcess, &ctx, VmmWinProcess_Enum32_Pre, VmmWinProcess_Enum32_Post);
     Ob_DECREF_NULL(&ctx.pObSetPrefetchDTB);
     VmmWinProcess_Enumerate_PostProcessing(pSystemProcess);
     VmmProcessCreateFinish();
@@ -3160,16 +3436,23 @@ BOOL VmmWinProcess_Enum32(_In_ PVMM_PROCESS pSystemProcess, _In_ BOOL fTotalRefr
 
 BOOL VmmWinProcess_Enumerate(_In_ PVMM_PROCESS pSystemProcess, _In_ BOOL fRefreshTotal)
 {
+    BOOL fResult = FALSE;
+    SIZE_T cProcess = 0;
+    QWORD tcStart = GetTickCount64();
     // spider TLB and set up initial system process and enumerate EPROCESS
     VmmTlbSpider(pSystemProcess);
     switch(ctxVmm->tpMemoryModel) {
         case VMM_MEMORYMODEL_X64:
-            return VmmWinProcess_Enum64(pSystemProcess, fRefreshTotal);
+            fResult = VmmWinProcess_Enum64(pSystemProcess, fRefreshTotal);
+            break;
         case VMM_MEMORYMODEL_X86:
         case VMM_MEMORYMODEL_X86PAE:
-            return VmmWinProcess_Enum32(pSystemProcess, fRefreshTotal);
+            fResult = VmmWinProcess_Enum32(pSystemProcess, fRefreshTotal);
+            break;
     }
-    return FALSE;
+    VmmProcessListPIDs(NULL, &cProcess, VMM_FLAG_PROCESS_SHOW_TERMINATED);
+    vmmprintfvv_fn("%s refresh: %i processes in %llims\n", (fRefreshTotal ? "total" : "partial"), (DWORD)cProcess, GetTickCount64() - tcStart);
+    return fResult;
 }
 
 // ----------------------------------------------------------------------------
@@ -176,6 +176,18 @@ PVMMOB_MAP_PHYSMEM VmmWinPhysMemMap_Initialize();
 */
 VOID VmmWinPhysMemMap_Refresh();
 
+/*
+* Create a big pool map and assign to the global context upon success.
+* CALLER DECREF: return
+* -- return
+*/
+PVMMOB_MAP_POOL VmmWinPool_Initialize();
+
+/*
+* Refresh the big pool map.
+*/
+VOID VmmWinPool_Refresh();
+
 /*
 * Retrieve the account name and length of the user account given a SID.
 * NB! Names for well known SIDs will be given in the language of the system
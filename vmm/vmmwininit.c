@@ -93,6 +93,7 @@ VOID VmmWinInit_TryInitializeKernelOptionalValues()
         PDB_GetTypeChildOffsetShort(PDB_HANDLE_KERNEL, "_TOKEN", L"UserAndGroups", &ctxVmm->offset.EPROCESS.opt.TOKEN_UserAndGroups);
         PDB_GetTypeChildOffsetShort(PDB_HANDLE_KERNEL, "_TOKEN", L"SessionId", &ctxVmm->offset.EPROCESS.opt.TOKEN_SessionId);
         PDB_GetTypeChildOffsetShort(PDB_HANDLE_KERNEL, "_TOKEN", L"TokenId", &ctxVmm->offset.EPROCESS.opt.TOKEN_TokenId);
+        PDB_GetTypeChildOffsetShort(PDB_HANDLE_KERNEL, "_TOKEN", L"ModifiedId", &ctxVmm->offset.EPROCESS.opt.TOKEN_ModifiedId);
     }
     // Optional _FILE_OBJECT related offsets
     if(!ctxVmm->offset.FILE.fValid) {
@@ -600,7 +601,7 @@ BOOL VmmWinInit_DTB_FindValidate()
     if(!(pb16M = LocalAlloc(LMEM_ZEROINIT, 0x01000000))) { return FALSE; }
     // 1: try locate DTB via X64 low stub in lower 1MB -
     //    avoiding normally reserved memory at a0000-fffff.
-    LcRead(ctxMain->hLC, 0x1000, 0x9f000, pb16M + 0x1000);
+    VmmReadDevice(0x1000, 0x9f000, pb16M + 0x1000);
     if(VmmWinInit_DTB_FindValidate_X64_LowStub(pb16M)) {
         VmmInitializeMemoryModel(VMM_MEMORYMODEL_X64);
         paDTB = ctxVmm->kernel.paDTB;
@@ -610,7 +611,7 @@ BOOL VmmWinInit_DTB_FindValidate()
     if(!paDTB) {
         for(pa = 0; pa < 0x01000000; pa += 0x1000) {
             if(pa == 0x00100000) {
-                LcRead(ctxMain->hLC, 0x00100000, 0x00f00000, pb16M + 0x00100000);
+                VmmReadDevice(0x00100000, 0x00f00000, pb16M + 0x00100000);
             }
             if(VmmWinInit_DTB_FindValidate_X64(pa, pb16M + pa)) {
                 VmmInitializeMemoryModel(VMM_MEMORYMODEL_X64);
@@ -655,7 +656,7 @@ BOOL VmmWinInit_DTB_Validate(QWORD paDTB)
 {
     BYTE pb[0x1000];
     paDTB = paDTB & ~0xfff;
-    if(!LcRead(ctxMain->hLC, paDTB, 0x1000, pb)) { return FALSE; }
+    if(!VmmReadDevice(paDTB, 0x1000, pb)) { return FALSE; }
     if(VmmWinInit_DTB_FindValidate_X64(paDTB, pb)) {
         VmmInitializeMemoryModel(VMM_MEMORYMODEL_X64);
         ctxVmm->kernel.paDTB = paDTB;
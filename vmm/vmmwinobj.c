@@ -6,11 +6,13 @@
 
 #include "vmmwinobj.h"
 #include "vmmwindef.h"
+#include "vmmwin.h"
 #include "vmm.h"
 #include "util.h"
 
 #define VMMWINOBJ_WORKITEM_FILEPROCSCAN_VAD         0x0000000100000000
 #define VMMWINOBJ_WORKITEM_FILEPROCSCAN_HANDLE      0x0000000200000000
+#define VMMWINOBJ_WORKITEM_FILESCAN_ALL             0x0000000400000000
 
 typedef struct tdVMMWINOBJ_CONTEXT {
     CRITICAL_SECTION LockUpdate;
@@ -454,62 +456,184 @@ success:
     return TRUE;
 }
 
+typedef struct tdVMMWINOBJ_GETALL_CONTEXT {
+    POB_SET psvaCandidate;
+    DWORD cProcess;
+    PVMM_PROCESS ppProcess[];
+} VMMWINOBJ_GETALL_CONTEXT, *PVMMWINOBJ_GETALL_CONTEXT;
 
-
-// ----------------------------------------------------------------------------
-// _FILE_OBJECT READ:
-// ----------------------------------------------------------------------------
+/*
+* Worker callback for VmmWinObjFile_GetAll: gather candidate _FILE_OBJECT
+* addresses from the handles and vads of a single process.
+*/
+VOID VmmWinObjFile_GetAll_DoWork(_In_ PVMMWINOBJ_GETALL_CONTEXT ctxGetAll, _In_ DWORD iProcess)
+{
+    DWORD i;
+    PVMMOB_MAP_VAD pmObVad = NULL;
+    PVMMOB_MAP_HANDLE pmObHandle = NULL;
+    PVMM_PROCESS pProcess = ctxGetAll->ppProcess[iProcess];
+    if(VmmMap_GetHandle(pProcess, &pmObHandle, TRUE)) {
+        for(i = 0; i < pmObHandle->cMap; i++) {
+            if((pmObHandle->pMap[i].dwPoolTag & 0x00ffffff) == 'liF') {
+                ObSet_Push(ctxGetAll->psvaCandidate, pmObHandle->pMap[i].vaObject);
+            }
+        }
+        Ob_DECREF_NULL(&pmObHandle);
+    }
+    if(VmmMap_GetVad(pProcess, &pmObVad, TRUE)) {
+        for(i = 0; i < pmObVad->cMap; i++) {
+            if(pmObVad->pMap[i].vaFileObject) {
+                ObSet_Push(ctxGetAll->psvaCandidate, pmObVad->pMap[i].vaFileObject);
+            }
+        }
+        Ob_DECREF_NULL(&pmObVad);
+    }
+}
 
 /*
-* Helper function to retrieve a Page Table Entry (PTE). Retrieval is done in a
-* fairly performance intensive (non-cached) way, but it's assumed this function
-* won't be heavily called.
-* -- pSystemProcess
-* -- vaPteBase
-* -- iPte
-* -- fVmmRead = VMM_FLAGS_* flags.
-* -- return = the PTE or 0 on fail.
+* Retrieve all _FILE_OBJECT related to all processes (system-wide). Candidate
+* addresses are gathered from the handles and vads of all processes in
+* parallel, de-duplicated into one set and each unique object not already
+* known is then resolved once in the batched initialization passes.
+* CALLER DECREF: ppmObFiles
+* -- ppmObFiles
+* -- return
 */
-QWORD VmmWinObjFile_ReadSubsectionAndSharedCache_GetPteSubsection(_In_ PVMM_PROCESS pSystemProcess, _In_ QWORD vaPteBase, _In_ QWORD iPte, _In_ QWORD fVmmRead)
+_Success_(return)
+BOOL VmmWinObjFile_GetAll(_Out_ POB_MAP *ppmObFiles)
 {
-    QWORD pte = 0;
-    DWORD cbPte = ctxVmm->tpMemoryModel == VMMDLL_MEMORYMODEL_X86 ? 4 : 8;
-    VmmReadEx(pSystemProcess, vaPteBase + iPte * cbPte, (PBYTE)&pte, cbPte, NULL, fVmmRead);
-    return pte;
+    DWORD i, cCandidate;
+    SIZE_T cProcess = 0;
+    QWORD va, tcStart = GetTickCount64(), cReadStart = ctxVmm->stat.cPhysReadSuccess + ctxVmm->stat.cPhysReadFail;
+    POB_MAP pmObFiles = NULL;
+    POB_SET psvaNew = NULL, psObKeyData = NULL;
+    POB_DATA pObData = NULL;
+    POB_VMMWINOBJ_FILE pObFile = NULL;
+    PVMM_PROCESS pObProcess = NULL, pObSystemProcess = NULL;
+    PVMMWINOBJ_GETALL_CONTEXT ctxGetAll = NULL;
+    PVMMWINOBJ_CONTEXT ctx = ctxVmm->pObjects;
+    *ppmObFiles = NULL;
+    if(!ctx || !ctxVmm->offset.FILE.fValid || !(pmObFiles = ObMap_New(OB_MAP_FLAGS_OBJECT_OB))) { return FALSE; }
+    // 1: try fetch from already completed system-wide workitem cache
+    EnterCriticalSection(&ctx->LockUpdate);
+    if((pObData = ObMap_GetByKey(ctx->pmByWorkitem, VMMWINOBJ_WORKITEM_FILESCAN_ALL))) {
+        for(i = 0; i < pObData->ObHdr.cbData / sizeof(QWORD); i++) {
+            if((pObFile = ObMap_GetByKey(ctx->pmByObj, pObData->pqw[i]))) {
+                if(pObFile->tp == VMMWINOBJ_TYPE_FILE) {
+                    ObMap_Push(pmObFiles, pObFile->va, pObFile);
+                }
+                Ob_DECREF_NULL(&pObFile);
+            }
+        }
+        Ob_DECREF_NULL(&pObData);
+        LeaveCriticalSection(&ctx->LockUpdate);
+        goto success;
+    }
+    LeaveCriticalSection(&ctx->LockUpdate);
+    // 2: gather candidate addresses from all processes in parallel
+    if(!(psvaNew = ObSet_New())) { goto fail; }
+    VmmProcessListPIDs(NULL, &cProcess, 0);
+    if(!(ctxGetAll = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMWINOBJ_GETALL_CONTEXT) + cProcess * sizeof(PVMM_PROCESS)))) { goto fail; }
+    if(!(ctxGetAll->psvaCandidate = ObSet_New())) { goto fail; }
+    while((ctxGetAll->cProcess < cProcess) && (pObProcess = VmmProcessGetNext(pObProcess, 0))) {
+        ctxGetAll->ppProcess[ctxGetAll->cProcess++] = Ob_INCREF(pObProcess);
+    }
+    Ob_DECREF_NULL(&pObProcess);
+    VmmWorkParallelForeach(ctxGetAll->cProcess, ctxGetAll, (VOID(*)(PVOID, DWORD))VmmWinObjFile_GetAll_DoWork);
+    cCandidate = ObSet_Size(ctxGetAll->psvaCandidate);
+    // 3: resolve unique unknown objects once in batched passes
+    EnterCriticalSection(&ctx->LockUpdate);
+    while((va = ObSet_Pop(ctxGetAll->psvaCandidate))) {
+        VmmWinObjFile_GetByProcess_DoWork_AddInitial(va, pmObFiles, psvaNew, ctx);
+    }
+    if(ObSet_Size(psvaNew) && (pObSystemProcess = VmmProcessGet(4))) {
+        VmmWinObjFile_Initialize_FileObjects(pObSystemProcess, psvaNew, pmObFiles);
+        Ob_DECREF_NULL(&pObSystemProcess);
+    }
+    if((psObKeyData = ObMap_FilterSet(pmObFiles, ObMap_FilterSet_FilterAllKey))) {
+        if((pObData = ObSet_GetAll(psObKeyData))) {
+            ObMap_Push(ctx->pmByWorkitem, VMMWINOBJ_WORKITEM_FILESCAN_ALL, pObData);
+            Ob_DECREF_NULL(&pObData);
+        }
+        Ob_DECREF_NULL(&psObKeyData);
+    }
+    LeaveCriticalSection(&ctx->LockUpdate);
+    vmmprintfv_fn("processes: %i candidates: %i files: %i reads: %lli time: %llims\n",
+        ctxGetAll->cProcess, cCandidate, ObMap_Size(pmObFiles),
+        ctxVmm->stat.cPhysReadSuccess + ctxVmm->stat.cPhysReadFail - cReadStart,
+        GetTickCount64() - tcStart);
+success:
+    *ppmObFiles = Ob_INCREF(pmObFiles);
+fail:
+    if(ctxGetAll) {
+        for(i = 0; i < ctxGetAll->cProcess; i++) {
+            Ob_DECREF(ctxGetAll->ppProcess[i]);
+        }
+        Ob_DECREF(ctxGetAll->psvaCandidate);
+        LocalFree(ctxGetAll);
+    }
+    Ob_DECREF(psvaNew);
+    Ob_DECREF(pmObFiles);
+    return (*ppmObFiles != NULL);
 }
 
+
+
+// ----------------------------------------------------------------------------
+// _FILE_OBJECT READ:
+// ----------------------------------------------------------------------------
+
 /*
-* Helper function to retrieve the virtual address of a _SHARED_CACHE_MAP entry.
-* Retrieval is done in a performance intensive (non-cached) way, but it's
-* assumed this function won't be heavily called.
+* Resolve the shared cache view base addresses of a range of _VACBs of a file.
+* The _VACB pointer array range is read in one read and the _VACBs are read in
+* one batched prefetch. Views are resolved per read call (the underlying reads
+* are served by the data cache) and each _VACB back-pointer is verified since
+* views may be unmapped or remapped to other files on live systems.
 * -- pSystemProcess
 * -- pFile
-* -- iPte
+* -- iVacbBase = index of first _VACB to resolve.
+* -- cVacb = number of _VACBs to resolve.
+* -- pvaView = receives per _VACB: the view base address, 0 = not mapped.
+* -- pbVacbs = scratch buffer of cVacb QWORDs.
 * -- fVmmRead
-* -- return = the virtual address or 0 on fail.
 */
-QWORD VmmWinObjFile_ReadSubsectionAndSharedCache_GetVaSharedCache(_In_ PVMM_PROCESS pSystemProcess, _In_ POB_VMMWINOBJ_FILE pFile, _In_ QWORD iPte, _In_ QWORD fVmmRead)
+VOID VmmWinObjFile_ReadSubsectionAndSharedCache_ResolveVacbs(_In_ PVMM_PROCESS pSystemProcess, _In_ POB_VMMWINOBJ_FILE pFile, _In_ QWORD iVacbBase, _In_ DWORD cVacb, _Out_writes_(cVacb) PQWORD pvaView, _Out_writes_(cVacb * 8) PBYTE pbVacbs, _In_ QWORD fVmmRead)
 {
-    BOOL f;
+    BOOL f32 = ctxVmm->f32;
     BYTE pbVacb[0x40];
-    QWORD va, iVacb, vaVacbs, vaVacb;
+    DWORD i, cbPtr = f32 ? 4 : 8;
+    QWORD vaVacb;
+    POB_SET psObPrefetch = NULL;
     PVMM_OFFSET_FILE po = &ctxVmm->offset.FILE;
-    iVacb = (iPte << 12) / pFile->_SHARED_CACHE_MAP.cbSectionSize;
-    vaVacbs = pFile->_SHARED_CACHE_MAP.vaVacbs + iVacb * (ctxVmm->f32 ? 4 : 8);
-    f = VmmRead2(pSystemProcess, vaVacbs, pbVacb, 8, fVmmRead) &&
-        (vaVacb = VMM_PTR_OFFSET(ctxVmm->f32, pbVacb, 0)) &&
-        VMM_KADDR_4_8(vaVacb) &&
-        VmmRead2(pSystemProcess, vaVacb, pbVacb, po->_VACB.cb, fVmmRead) &&
-        (pFile->_SHARED_CACHE_MAP.va == VMM_PTR_OFFSET(ctxVmm->f32, pbVacb, po->_VACB.oSharedCacheMap)) &&
-        (va = VMM_PTR_OFFSET(ctxVmm->f32, pbVacb, po->_VACB.oBaseAddress));
-    return f ? (va + (iPte << 12)) : 0;
+    ZeroMemory(pvaView, cVacb * sizeof(QWORD));
+    if(po->_VACB.cb > sizeof(pbVacb)) { return; }
+    // 1: read the _VACB pointer array range in one read and prefetch the _VACBs.
+    VmmReadEx(pSystemProcess, pFile->_SHARED_CACHE_MAP.vaVacbs + iVacbBase * cbPtr, pbVacbs, cVacb * cbPtr, NULL, fVmmRead | VMM_FLAG_ZEROPAD_ON_FAIL);
+    if((cVacb > 1) && (psObPrefetch = ObSet_New())) {
+        for(i = 0; i < cVacb; i++) {
+            vaVacb = VMM_PTR_OFFSET(f32, pbVacbs, i * cbPtr);
+            if(VMM_KADDR_4_8(vaVacb)) {
+                ObSet_Push(psObPrefetch, vaVacb);
+            }
+        }
+        VmmCachePrefetchPages3(pSystemProcess, psObPrefetch, po->_VACB.cb, fVmmRead);
+        Ob_DECREF(psObPrefetch);
+    }
+    // 2: resolve view base addresses of _VACBs still belonging to this file.
+    for(i = 0; i < cVacb; i++) {
+        vaVacb = VMM_PTR_OFFSET(f32, pbVacbs, i * cbPtr);
+        if(VMM_KADDR_4_8(vaVacb) &&
+            VmmRead2(pSystemProcess, vaVacb, pbVacb, po->_VACB.cb, fVmmRead) &&
+            (pFile->_SHARED_CACHE_MAP.va == VMM_PTR_OFFSET(f32, pbVacb, po->_VACB.oSharedCacheMap))) {
+            pvaView[i] = VMM_PTR_OFFSET(f32, pbVacb, po->_VACB.oBaseAddress);
+        }
+    }
 }
 
 /*
 * Read data from a single _FILE_OBJECT _SUBSECTION and/or a _SHARED_CACHE_MAP.
-* Function is very similar to the VmmReadEx() function. Reading is not yet
-* optimized, but the assumption is the function won't be called frequently so
-* any inefficencies should only have a minor performance impact.
+* Function is very similar to the VmmReadEx() function. Shared cache views and
+* subsection ptes of the requested range are resolved in one batch per call.
 * -- pSystemProcess
 * -- pFile
 * -- iSubsection
@@ -523,20 +647,23 @@ QWORD VmmWinObjFile_ReadSubsectionAndSharedCache_GetVaSharedCache(_In_ PVMM_PROC
 VOID VmmWinObjFile_ReadSubsectionAndSharedCache(_In_ PVMM_PROCESS pSystemProcess, _In_ POB_VMMWINOBJ_FILE pFile, _In_ DWORD iSubsection, _In_ QWORD cbOffset, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb, _Out_opt_ PDWORD pcbReadOpt, _In_ QWORD fVmmRead, _In_ BOOL fSharedCache)
 {
     BOOL fReadSubsection = FALSE, fReadSharedCacheMap = FALSE;
-    DWORD cbP, cMEMs, cbRead = 0;
-    PBYTE pbBuffer;
+    DWORD cbP, cMEMs, cbRead = 0, cbPte, cPte, cVacb = 0;
+    PBYTE pbBuffer, pbPte;
+    PQWORD pvaView;
     PMEM_SCATTER pMEMs, *ppMEMs;
-    QWORD i, oA, iPte;
+    QWORD i, oA, iPte, iPteBase, iVacb, iVacbBase = 0;
     if(pcbReadOpt) { *pcbReadOpt = 0; }
     if(!cb) { return; }
     cMEMs = (DWORD)(((cbOffset & 0xfff) + cb + 0xfff) >> 12);
-    pbBuffer = (PBYTE)LocalAlloc(LMEM_ZEROINIT, 0x2000 + cMEMs * (sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER)));
+    pbBuffer = (PBYTE)LocalAlloc(LMEM_ZEROINIT, 0x2000 + cMEMs * (sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER) + 3 * sizeof(QWORD)) + 2 * sizeof(QWORD));
     if(!pbBuffer) {
         ZeroMemory(pb, cb);
         return;
     }
     pMEMs = (PMEM_SCATTER)(pbBuffer + 0x2000);
     ppMEMs = (PPMEM_SCATTER)(pbBuffer + 0x2000 + cMEMs * sizeof(MEM_SCATTER));
+    pbPte = pbBuffer + 0x2000 + cMEMs * (sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER));
+    pvaView = (PQWORD)(pbPte + cMEMs * sizeof(QWORD));
     oA = cbOffset & 0xfff;
     // prepare "middle" pages
     for(i = 0; i < cMEMs; i++) {
@@ -552,11 +679,19 @@ VOID VmmWinObjFile_ReadSubsectionAndSharedCache(_In_ PVMM_PROCESS pSystemProcess
     if(cMEMs > 1) {
         pMEMs[cMEMs - 1].pb = pbBuffer + 0x1000;
     }
+    iPteBase = (cbOffset - oA) >> 12;
     // Read from _SHARED_CACHE_MAP
     if(fSharedCache) {
+        if(pFile->_SHARED_CACHE_MAP.cbSectionSize) {
+            iVacbBase = (iPteBase << 12) / pFile->_SHARED_CACHE_MAP.cbSectionSize;
+            cVacb = (DWORD)(((iPteBase + cMEMs - 1) << 12) / pFile->_SHARED_CACHE_MAP.cbSectionSize - iVacbBase + 1);
+            cVacb = min(cVacb, cMEMs + 1);
+            VmmWinObjFile_ReadSubsectionAndSharedCache_ResolveVacbs(pSystemProcess, pFile, iVacbBase, cVacb, pvaView, (PBYTE)(pvaView + cMEMs + 1), fVmmRead);
+        }
         for(i = 0; i < cMEMs; i++) {
-            iPte = i + ((cbOffset - oA) >> 12);
-            pMEMs[i].qwA = VmmWinObjFile_ReadSubsectionAndSharedCache_GetVaSharedCache(pSystemProcess, pFile, iPte, fVmmRead);
+            iPte = iPteBase + i;
+            iVacb = cVacb ? ((iPte << 12) / pFile->_SHARED_CACHE_MAP.cbSectionSize - iVacbBase) : 0;
+            pMEMs[i].qwA = ((iVacb < cVacb) && pvaView[iVacb]) ? (pvaView[iVacb] + (iPte << 12)) : 0;
             if(pMEMs[i].qwA) {
                 fReadSharedCacheMap = TRUE;
             }
@@ -565,12 +700,17 @@ VOID VmmWinObjFile_ReadSubsectionAndSharedCache(_In_ PVMM_PROCESS pSystemProcess
             VmmReadScatterVirtual(pSystemProcess, ppMEMs, cMEMs, fVmmRead);
         }
     }
-    // Read from _SUBSECTION
+    // Read from _SUBSECTION - the prototype ptes of the whole range are read in
+    // one read; pte values are not cached since they change as pages move.
     if(pFile->cSUBSECTION && (iSubsection < pFile->cSUBSECTION)) {
+        cbPte = (ctxVmm->tpMemoryModel == VMMDLL_MEMORYMODEL_X86) ? 4 : 8;
+        cPte = (iPteBase < pFile->pSUBSECTION[iSubsection].dwPtesInSubsection) ? (DWORD)min(cMEMs, pFile->pSUBSECTION[iSubsection].dwPtesInSubsection - iPteBase) : 0;
+        if(cPte) {
+            VmmReadEx(pSystemProcess, pFile->pSUBSECTION[iSubsection].vaSubsectionBase + iPteBase * cbPte, pbPte, cPte * cbPte, NULL, fVmmRead | VMM_FLAG_ZEROPAD_ON_FAIL);
+        }
         for(i = 0; i < cMEMs; i++) {
             if(pMEMs[i].f) { continue; }
-            iPte = i + ((cbOffset - oA) >> 12);
-            pMEMs[i].qwA = (iPte < pFile->pSUBSECTION[iSubsection].dwPtesInSubsection) ? VmmWinObjFile_ReadSubsectionAndSharedCache_GetPteSubsection(pSystemProcess, pFile->pSUBSECTION[iSubsection].vaSubsectionBase, iPte, fVmmRead) : 0;
+            pMEMs[i].qwA = (i < cPte) ? ((cbPte == 4) ? ((PDWORD)pbPte)[i] : ((PQWORD)pbPte)[i]) : 0;
             fReadSubsection = TRUE;
         }
         if(fReadSubsection) {
@@ -97,6 +97,18 @@ POB_VMMWINOBJ_OBJECT VmmWinObj_Get(_In_ QWORD va);
 _Success_(return)
 BOOL VmmWinObjFile_GetByProcess(_In_ PVMM_PROCESS pProcess, _Out_ POB_MAP *ppmObFiles, _In_ BOOL fHandles);
 
+/*
+* Retrieve all _FILE_OBJECT related to all processes (system-wide) - i.e. from
+* the handles and vads of all processes. Processes are scanned in parallel and
+* each unique file object is resolved only once.
+* NB! may be slow on first call (result is cached until next refresh).
+* CALLER DECREF: *ppmObFiles
+* -- ppmObFiles
+* -- return
+*/
+_Success_(return)
+BOOL VmmWinObjFile_GetAll(_Out_ POB_MAP *ppmObFiles);
+
 /*
 * Read a contigious amount of file data and report the number of bytes read.
 * -- pFile
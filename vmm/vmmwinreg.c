@@ -78,12 +78,63 @@ PVMM_PROCESS VmmWinReg_GetRegistryProcess()
 #define _IS_HMAP_ADDR32(a)     (!(a & 0xff0) && (a & 0xfff00000))
 #define _IS_HMAP_SIZE32(a)     (a && !(a & 0xffff0fff))
 
+/*
+* Decode a _HMAP_ENTRY into the page-aligned virtual address of the hive page.
+* -- pbHE
+* -- return = the virtual address, or zero if invalid.
+*/
+QWORD VmmWinReg_Reg2Virt_HmapEntry64(_In_ PBYTE pbHE)
+{
+    QWORD vaCell, oCell;
+    // [ --------------------------------------- ]
+    // [ WINVISTA->WIN81: dt nt!_HMAP_ENTRY      ]
+    // [    + 0x000 BlockAddress : Uint8B        ]
+    // [ --------------------------------------- ]
+    // [    WINDOWS10 : dt nt!_HMAP_ENTRY        ]
+    // [    + 0x000 BlockOffset : Uint8B         ]
+    // [    + 0x008 PermanentBinAddress : Uint8B ]
+    // [ --------------------------------------- ]
+    if(ctxVmm->kernel.dwVersionMajor == 10) {
+        oCell = *(PQWORD)pbHE;
+        vaCell = *(PQWORD)(pbHE + 8);
+        if((oCell & 0xfff) || (oCell >= 0x10000)) { return 0; }
+        vaCell += oCell;
+    } else {
+        vaCell = *(PQWORD)pbHE;
+    }
+    if(!_IS_HMAP_ADDR64(vaCell)) { return 0; }
+    return vaCell & 0xffffffff'fffff000;
+}
+
+QWORD VmmWinReg_Reg2Virt_HmapEntry32(_In_ PBYTE pbHE)
+{
+    DWORD vaCell, oCell;
+    // [ --------------------------------------- ]
+    // [ WINVISTA->WIN81: dt nt!_HMAP_ENTRY      ]
+    // [    + 0x000 BlockAddress : Uint4B        ]
+    // [ --------------------------------------- ]
+    // [    WINDOWS10 : dt nt!_HMAP_ENTRY        ]
+    // [    + 0x000 BlockOffset : Uint4B         ]
+    // [    + 0x004 PermanentBinAddress : Uint4B ]
+    // [ --------------------------------------- ]
+    if(ctxVmm->kernel.dwVersionMajor == 10) {
+        oCell = *(PDWORD)pbHE;
+        vaCell = *(PDWORD)(pbHE + 4);
+        if((oCell & 0xfff) || (oCell >= 0x10000)) { return 0; }
+        vaCell += oCell;
+    } else {
+        vaCell = *(PDWORD)pbHE;
+    }
+    if(!_IS_HMAP_ADDR32(vaCell)) { return 0; }
+    return vaCell & 0xfffff000;
+}
+
 _Success_(return)
 BOOL VmmWinReg_Reg2Virt64(_In_ PVMM_PROCESS pProcessRegistry, _In_ POB_REGISTRY_HIVE pRegistryHive, _In_ DWORD ra, _Out_ PQWORD pva)
 {
     PVMMWIN_REGISTRY_OFFSET po = &ctxVmm->pRegistry->Offset;
     QWORD iSV, iDirectory, iTable;
-    QWORD vaTable, vaCell, oCell;
+    QWORD vaTable, vaCell;
     BYTE pbHE[0x40];
     // TRANSLATION REMINDS OF X86 MEMORY MODEL
     // 1-bit    10-bits   9-bits    12-bits
@@ -103,25 +154,9 @@ BOOL VmmWinReg_Reg2Virt64(_In_ PVMM_PROCESS pProcessRegistry, _In_ POB_REGISTRY_
     }
     if(!VMM_KADDR64(vaTable)) { return FALSE; }
     // REG table is array of 512 _HMAP_ENTRY of size 0x18 or 0x20 or 0x28
-    // [ --------------------------------------- ]
-    // [ WINVISTA->WIN81: dt nt!_HMAP_ENTRY      ]
-    // [    + 0x000 BlockAddress : Uint8B        ]
-    // [ --------------------------------------- ]
-    // [    WINDOWS10 : dt nt!_HMAP_ENTRY        ]
-    // [    + 0x000 BlockOffset : Uint8B         ]
-    // [    + 0x008 PermanentBinAddress : Uint8B ]
-    // [ --------------------------------------- ]
     if(!VmmRead(pProcessRegistry, vaTable + iTable * po->HE._Size, (PBYTE)&pbHE, po->HE._Size)) { return FALSE; }
-    if(ctxVmm->kernel.dwVersionMajor == 10) {
-        oCell = *(PQWORD)pbHE;
-        vaCell = *(PQWORD)(pbHE + 8);
-        if((oCell & 0xfff) || (oCell >= 0x10000)) { return FALSE; }
-        vaCell += oCell;
-    } else {
-        vaCell = *(PQWORD)pbHE;
-    }
-    if(!_IS_HMAP_ADDR64(vaCell)) { return FALSE; }
-    *pva = (vaCell & 0xffffffff'fffff000) | (ra & 0xfff);
+    if(!(vaCell = VmmWinReg_Reg2Virt_HmapEntry64(pbHE))) { return FALSE; }
+    *pva = vaCell | (ra & 0xfff);
     return TRUE;
 }
 
@@ -129,8 +164,8 @@ _Success_(return)
 BOOL VmmWinReg_Reg2Virt32(_In_ PVMM_PROCESS pProcessRegistry, _In_ POB_REGISTRY_HIVE pRegistryHive, _In_ DWORD ra, _Out_ PQWORD pva)
 {
     PVMMWIN_REGISTRY_OFFSET po = &ctxVmm->pRegistry->Offset;
-    QWORD iSV, iDirectory, iTable;
-    DWORD vaTable, vaCell, oCell;
+    QWORD iSV, iDirectory, iTable, vaCell;
+    DWORD vaTable;
     BYTE pbHE[0x20];
     // TRANSLATION REMINDS OF X86 MEMORY MODEL
     // 1-bit    10-bits   9-bits    12-bits
@@ -149,28 +184,81 @@ BOOL VmmWinReg_Reg2Virt32(_In_ PVMM_PROCESS pProcessRegistry, _In_ POB_REGISTRY_
         vaTable = (DWORD)pRegistryHive->_DUAL[iSV].vaHMAP_TABLE_SmallDir;
     }
     if(!VMM_KADDR32(vaTable)) { return FALSE; }
-    // [ --------------------------------------- ]
-    // [ WINVISTA->WIN81: dt nt!_HMAP_ENTRY      ]
-    // [    + 0x000 BlockAddress : Uint4B        ]
-    // [ --------------------------------------- ]
-    // [    WINDOWS10 : dt nt!_HMAP_ENTRY        ]
-    // [    + 0x000 BlockOffset : Uint4B         ]
-    // [    + 0x004 PermanentBinAddress : Uint4B ]
-    // [ --------------------------------------- ]
     if(!VmmRead(pProcessRegistry, vaTable + iTable * po->HE._Size, (PBYTE)&pbHE, po->HE._Size)) { return FALSE; }
-    if(ctxVmm->kernel.dwVersionMajor == 10) {
-        oCell = *(PDWORD)pbHE;
-        vaCell = *(PDWORD)(pbHE + 4);
-        if((oCell & 0xfff) || (oCell >= 0x10000)) { return FALSE; }
-        vaCell += oCell;
-    } else {
-        vaCell = *(PDWORD)pbHE;
-    }
-    if(!_IS_HMAP_ADDR32(vaCell)) { return FALSE; }
-    *pva = (vaCell & 0xfffff000) | (ra & 0xfff);
+    if(!(vaCell = VmmWinReg_Reg2Virt_HmapEntry32(pbHE))) { return FALSE; }
+    *pva = vaCell | (ra & 0xfff);
     return TRUE;
 }
 
+/*
+* Capture the hive map directory and tables of a hive into flat per-page
+* translation tables (hive page index -> virtual address). The tables are
+* captured once per hive object; after this translation is arithmetic only.
+* -- pProcessRegistry
+* -- pRegistryHive
+*/
+VOID VmmWinReg_Reg2VirtTable_Initialize(_In_ PVMM_PROCESS pProcessRegistry, _In_ POB_REGISTRY_HIVE pRegistryHive)
+{
+    BOOL f32 = ctxVmm->f32;
+    PVMMWIN_REGISTRY_OFFSET po = &ctxVmm->pRegistry->Offset;
+    DWORD iSV, iDirectory, cDirectory, iTable, cPage, iPage, cbPtr = f32 ? 4 : 8;
+    QWORD vaTable, tcStart = GetTickCount64();
+    PQWORD pvaTables = NULL;
+    PBYTE pbDirectory = NULL, pbTable = NULL;
+    POB_SET psObPrefetch = NULL;
+    EnterCriticalSection(&pRegistryHive->LockUpdate);
+    if(pRegistryHive->Reg2Virt.fInitialized) { goto finish; }
+    if(!(pbDirectory = LocalAlloc(0, 1024 * sizeof(QWORD)))) { goto finish; }
+    if(!(pvaTables = LocalAlloc(0, 1024 * sizeof(QWORD)))) { goto finish; }
+    if(!(pbTable = LocalAlloc(0, 512 * po->HE._Size))) { goto finish; }
+    if(!(psObPrefetch = ObSet_New())) { goto finish; }
+    for(iSV = 0; iSV < 2; iSV++) {
+        cPage = (pRegistryHive->_DUAL[iSV].cb + 0xfff) >> 12;
+        cDirectory = (cPage + 511) / 512;
+        if(!cPage || (cDirectory > 1024)) { continue; }
+        if(!(pRegistryHive->Reg2Virt.pva[iSV] = LocalAlloc(LMEM_ZEROINIT, cPage * sizeof(QWORD)))) { continue; }
+        // 1: directory -> table addresses (1st table may be the small directory).
+        ZeroMemory(pvaTables, cDirectory * sizeof(QWORD));
+        if((cDirectory > 1) || !pRegistryHive->_DUAL[iSV].vaHMAP_TABLE_SmallDir) {
+            VmmReadEx(pProcessRegistry, pRegistryHive->_DUAL[iSV].vaHMAP_DIRECTORY, pbDirectory, cDirectory * cbPtr, NULL, VMM_FLAG_ZEROPAD_ON_FAIL);
+            for(iDirectory = 0; iDirectory < cDirectory; iDirectory++) {
+                pvaTables[iDirectory] = VMM_PTR_OFFSET(f32, pbDirectory, iDirectory * cbPtr);
+            }
+        }
+        if(pRegistryHive->_DUAL[iSV].vaHMAP_TABLE_SmallDir) {
+            pvaTables[0] = pRegistryHive->_DUAL[iSV].vaHMAP_TABLE_SmallDir;
+        }
+        // 2: prefetch tables in one batch and translate all entries.
+        ObSet_Clear(psObPrefetch);
+        for(iDirectory = 0; iDirectory < cDirectory; iDirectory++) {
+            if(VMM_KADDR(pvaTables[iDirectory])) {
+                ObSet_Push(psObPrefetch, pvaTables[iDirectory]);
+            }
+        }
+        VmmCachePrefetchPages3(pProcessRegistry, psObPrefetch, 512 * po->HE._Size, 0);
+        for(iDirectory = 0; iDirectory < cDirectory; iDirectory++) {
+            vaTable = pvaTables[iDirectory];
+            if(!VMM_KADDR(vaTable)) { continue; }
+            VmmReadEx(pProcessRegistry, vaTable, pbTable, 512 * po->HE._Size, NULL, VMM_FLAG_ZEROPAD_ON_FAIL);
+            for(iTable = 0; iTable < 512; iTable++) {
+                iPage = iDirectory * 512 + iTable;
+                if(iPage >= cPage) { break; }
+                pRegistryHive->Reg2Virt.pva[iSV][iPage] = f32 ?
+                    VmmWinReg_Reg2Virt_HmapEntry32(pbTable + iTable * po->HE._Size) :
+                    VmmWinReg_Reg2Virt_HmapEntry64(pbTable + iTable * po->HE._Size);
+            }
+        }
+    }
+    vmmprintfvv_fn("%s pages: %i/%i in %llims\n", pRegistryHive->szName, (pRegistryHive->_DUAL[0].cb + 0xfff) >> 12, (pRegistryHive->_DUAL[1].cb + 0xfff) >> 12, GetTickCount64() - tcStart);
+finish:
+    pRegistryHive->Reg2Virt.fInitialized = TRUE;
+    LeaveCriticalSection(&pRegistryHive->LockUpdate);
+    Ob_DECREF(psObPrefetch);
+    LocalFree(pbDirectory);
+    LocalFree(pvaTables);
+    LocalFree(pbTable);
+}
+
 /*
 * Translate a registry address 'ra' into a virtual address 'va'
 * -- pProcessRegistry = the registry process
@@ -182,7 +270,30 @@ BOOL VmmWinReg_Reg2Virt32(_In_ PVMM_PROCESS pProcessRegistry, _In_ POB_REGISTRY_
 _Success_(return)
 BOOL VmmWinReg_Reg2Virt(_In_ PVMM_PROCESS pProcessRegistry, _In_ POB_REGISTRY_HIVE pRegistryHive, _In_ DWORD ra, _Out_ PQWORD pva)
 {
+    QWORD va;
+    DWORD iSV = ra >> 31, raOffset = ra & 0x7fffffff;
     if(!pProcessRegistry || !pRegistryHive) { return FALSE; }
+    if(!pRegistryHive->Reg2Virt.fInitialized) {
+        VmmWinReg_Reg2VirtTable_Initialize(pProcessRegistry, pRegistryHive);
+    }
+    if(pRegistryHive->Reg2Virt.pva[iSV]) {
+        // fast path: flat translation table
+        if(raOffset >= pRegistryHive->_DUAL[iSV].cb) { return FALSE; }
+        if((va = pRegistryHive->Reg2Virt.pva[iSV][raOffset >> 12])) {
+            *pva = va | (raOffset & 0xfff);
+            return TRUE;
+        }
+        // entry not resolved at table initialization (table read failed or
+        // page not yet allocated) - fall back to a directory/table walk and
+        // update the flat translation table on success.
+        if(!(ctxVmm->f32 ?
+            VmmWinReg_Reg2Virt32(pProcessRegistry, pRegistryHive, ra, pva) :
+            VmmWinReg_Reg2Virt64(pProcessRegistry, pRegistryHive, ra, pva))) {
+            return FALSE;
+        }
+        pRegistryHive->Reg2Virt.pva[iSV][raOffset >> 12] = *pva & ~0xfffULL;
+        return TRUE;
+    }
     return ctxVmm->f32 ?
         VmmWinReg_Reg2Virt32(pProcessRegistry, pRegistryHive, ra, pva) :
         VmmWinReg_Reg2Virt64(pProcessRegistry, pRegistryHive, ra, pva);
@@ -679,6 +790,8 @@ VOID VmmWinReg_CallbackCleanup_ObRegistryHive(POB_REGISTRY_HIVE pOb)
     Ob_DECREF(pOb->Snapshot.pmKeyOffset);
     LocalFree(pOb->Snapshot._DUAL[0].pb);
     LocalFree(pOb->Snapshot._DUAL[1].pb);
+    LocalFree(pOb->Reg2Virt.pva[0]);
+    LocalFree(pOb->Reg2Virt.pva[1]);
 }
 
 /*
@@ -910,21 +1023,24 @@ BOOL VmmWinReg_KeyInitialize(_In_ POB_REGISTRY_HIVE pHive);
 * parsing of the keys. Any keys derived from the hive must never be used after
 * Ob_DECREF has been called on the hive.
 * -- pHive
+* -- pbDUAL = optional already read static/volatile hive memory (as read by
+*             VmmWinReg_HiveSnapshotEnsureAll). Function takes ownership of
+*             the buffers and sets the pointers to NULL.
 * -- return
 */
 _Success_(return)
-BOOL VmmWinReg_HiveSnapshotEnsure(_In_ POB_REGISTRY_HIVE pHive)
+BOOL VmmWinReg_HiveSnapshotEnsureEx(_In_ POB_REGISTRY_HIVE pHive, _Inout_opt_ PBYTE pbDUAL[2])
 {
     DWORD i, cbRead;
     // 1: check already cached
-    if(!pHive) { return FALSE; }
-    if(pHive->Snapshot.fInitialized) { return TRUE; }
-    if(pHive->cbLength > 0x10000000) { return FALSE; }      // max 256MB hive
+    if(!pHive) { goto fail_nolock; }
+    if(pHive->Snapshot.fInitialized) { goto success_nolock; }
+    if(pHive->cbLength > 0x10000000) { goto fail_nolock; }  // max 256MB hive
     // 2: lock and retry retrieve cached
     EnterCriticalSection(&pHive->LockUpdate);
     if(pHive->Snapshot.fInitialized) {
         LeaveCriticalSection(&pHive->LockUpdate);
-        return TRUE;
+        goto success_nolock;
     }
     // 3: allocate new
     pHive->Snapshot.pmKeyHash = ObMap_New(OB_MAP_FLAGS_OBJECT_OB);
@@ -932,12 +1048,22 @@ BOOL VmmWinReg_HiveSnapshotEnsure(_In_ POB_REGISTRY_HIVE pHive)
     if(!pHive->Snapshot.pmKeyHash || !pHive->Snapshot.pmKeyOffset) { goto fail; }
     for(i = 0; i < 2; i++) {
         pHive->Snapshot._DUAL[i].cb = pHive->_DUAL[i].cb;
+        if(pbDUAL && pbDUAL[i]) {
+            pHive->Snapshot._DUAL[i].pb = pbDUAL[i];
+            pbDUAL[i] = NULL;
+            continue;
+        }
         if(!(pHive->Snapshot._DUAL[i].pb = LocalAlloc(0, pHive->Snapshot._DUAL[i].cb))) { goto fail; }
         VmmWinReg_HiveReadEx(pHive, (i ? 0x80000000 : 0), pHive->Snapshot._DUAL[i].pb, pHive->Snapshot._DUAL[i].cb, &cbRead, VMM_FLAG_ZEROPAD_ON_FAIL);
     }
     if(!VmmWinReg_KeyInitialize(pHive)) { goto fail; }
     pHive->Snapshot.fInitialized = TRUE;
     LeaveCriticalSection(&pHive->LockUpdate);
+success_nolock:
+    if(pbDUAL) {
+        LocalFree(pbDUAL[0]); pbDUAL[0] = NULL;
+        LocalFree(pbDUAL[1]); pbDUAL[1] = NULL;
+    }
     return TRUE;
 fail:
     Ob_DECREF_NULL(&pHive->Snapshot.pmKeyHash);
@@ -947,9 +1073,140 @@ fail:
     pHive->Snapshot._DUAL[0].pb = NULL;
     pHive->Snapshot._DUAL[1].pb = NULL;
     LeaveCriticalSection(&pHive->LockUpdate);
+fail_nolock:
+    if(pbDUAL) {
+        LocalFree(pbDUAL[0]); pbDUAL[0] = NULL;
+        LocalFree(pbDUAL[1]); pbDUAL[1] = NULL;
+    }
     return FALSE;
 }
 
+_Success_(return)
+BOOL VmmWinReg_HiveSnapshotEnsure(_In_ POB_REGISTRY_HIVE pHive)
+{
+    return VmmWinReg_HiveSnapshotEnsureEx(pHive, NULL);
+}
+
+#define VMMWINREG_SNAPSHOT_CBWINDOW     0x00100000
+
+typedef struct tdVMMWINREG_SNAPSHOT_HIVE {
+    POB_REGISTRY_HIVE pHive;
+    PBYTE pbDUAL[2];
+} VMMWINREG_SNAPSHOT_HIVE, *PVMMWINREG_SNAPSHOT_HIVE;
+
+typedef struct tdVMMWINREG_SNAPSHOT_WINDOW {
+    PVMMWINREG_SNAPSHOT_HIVE pe;
+    DWORD ra;                   // hive address (incl. static/volatile bit)
+    DWORD o;                    // offset into snapshot buffer
+    DWORD cb;
+    DWORD iSV;
+} VMMWINREG_SNAPSHOT_WINDOW, *PVMMWINREG_SNAPSHOT_WINDOW;
+
+typedef struct tdVMMWINREG_SNAPSHOT_CONTEXT {
+    DWORD cHive;
+    DWORD cWindow;
+    PVMMWINREG_SNAPSHOT_WINDOW pWindows;
+    VMMWINREG_SNAPSHOT_HIVE pHives[];
+} VMMWINREG_SNAPSHOT_CONTEXT, *PVMMWINREG_SNAPSHOT_CONTEXT;
+
+int VmmWinReg_HiveSnapshotEnsureAll_CmpHive(PVMMWINREG_SNAPSHOT_HIVE v1, PVMMWINREG_SNAPSHOT_HIVE v2)
+{
+    return
+        (v1->pHive->cbLength < v2->pHive->cbLength) ? -1 :
+        (v1->pHive->cbLength > v2->pHive->cbLength) ? 1 : 0;
+}
+
+/*
+* Worker callback: read one bounded window of hive memory into the snapshot
+* buffer of its hive.
+*/
+VOID VmmWinReg_HiveSnapshotEnsureAll_ReadWindow(_In_ PVMMWINREG_SNAPSHOT_CONTEXT ctx, _In_ DWORD i)
+{
+    PVMMWINREG_SNAPSHOT_WINDOW pw = ctx->pWindows + i;
+    VmmWinReg_HiveReadEx(pw->pe->pHive, pw->ra, pw->pe->pbDUAL[pw->iSV] + pw->o, pw->cb, NULL, VMM_FLAG_ZEROPAD_ON_FAIL);
+}
+
+/*
+* Worker callback: build the key tree of one hive from its read snapshot.
+*/
+VOID VmmWinReg_HiveSnapshotEnsureAll_KeyInitialize(_In_ PVMMWINREG_SNAPSHOT_CONTEXT ctx, _In_ DWORD i)
+{
+    VmmWinReg_HiveSnapshotEnsureEx(ctx->pHives[i].pHive, ctx->pHives[i].pbDUAL);
+}
+
+/*
+* Ensure registry hive snapshots are taken of all registry hives. Hive memory
+* is read in bounded windows in parallel on the worker thread pool - this way
+* large hives are split between multiple workers. Key trees are then built in
+* parallel - one hive per worker, largest hive first.
+*/
+VOID VmmWinReg_HiveSnapshotEnsureAll()
+{
+    DWORD i, iSV, o, cbHive, cHive, cWindow = 0;
+    QWORD tcStart = GetTickCount64(), tcRead;
+    POB_MAP pmObHive = NULL;
+    POB_REGISTRY_HIVE pObHive = NULL;
+    PVMMWINREG_SNAPSHOT_HIVE pe;
+    PVMMWINREG_SNAPSHOT_WINDOW pw;
+    PVMMWINREG_SNAPSHOT_CONTEXT ctx = NULL;
+    if(!(pmObHive = VmmWinReg_HiveMap()) || !(cHive = ObMap_Size(pmObHive))) { goto fail; }
+    if(!(ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMWINREG_SNAPSHOT_CONTEXT) + cHive * sizeof(VMMWINREG_SNAPSHOT_HIVE)))) { goto fail; }
+    // 1: collect hives not yet snapshotted and allocate snapshot buffers.
+    while((pObHive = ObMap_GetNext(pmObHive, pObHive))) {
+        if(pObHive->Snapshot.fInitialized || (pObHive->cbLength > 0x10000000)) { continue; }
+        pe = ctx->pHives + ctx->cHive;
+        for(iSV = 0; iSV < 2; iSV++) {
+            if(!(pe->pbDUAL[iSV] = LocalAlloc(0, pObHive->_DUAL[iSV].cb))) { break; }
+            cWindow += (pObHive->_DUAL[iSV].cb + VMMWINREG_SNAPSHOT_CBWINDOW - 1) / VMMWINREG_SNAPSHOT_CBWINDOW;
+        }
+        pe->pHive = Ob_INCREF(pObHive);
+        ctx->cHive++;
+    }
+    if(!ctx->cHive) { goto fail; }
+    qsort(ctx->pHives, ctx->cHive, sizeof(VMMWINREG_SNAPSHOT_HIVE), (int(*)(const void*, const void*))VmmWinReg_HiveSnapshotEnsureAll_CmpHive);
+    // 2: split hive memory into bounded windows and read them in parallel.
+    if(cWindow && (ctx->pWindows = LocalAlloc(0, cWindow * sizeof(VMMWINREG_SNAPSHOT_WINDOW)))) {
+        for(i = 0; i < ctx->cHive; i++) {
+            pe = ctx->pHives + i;
+            for(iSV = 0; iSV < 2; iSV++) {
+                if(!pe->pbDUAL[iSV]) { continue; }
+                cbHive = pe->pHive->_DUAL[iSV].cb;
+                for(o = 0; o < cbHive; o += VMMWINREG_SNAPSHOT_CBWINDOW) {
+                    pw = ctx->pWindows + ctx->cWindow++;
+                    pw->pe = pe;
+                    pw->iSV = iSV;
+                    pw->o = o;
+                    pw->ra = o + (iSV ? 0x80000000 : 0);
+                    pw->cb = min(VMMWINREG_SNAPSHOT_CBWINDOW, cbHive - o);
+                }
+            }
+        }
+        VmmWorkParallelForeach(ctx->cWindow, ctx, (VOID(*)(PVOID, DWORD))VmmWinReg_HiveSnapshotEnsureAll_ReadWindow);
+    } else {
+        // out of memory for windows - let the per-hive snapshot read itself.
+        for(i = 0; i < ctx->cHive; i++) {
+            LocalFree(ctx->pHives[i].pbDUAL[0]); ctx->pHives[i].pbDUAL[0] = NULL;
+            LocalFree(ctx->pHives[i].pbDUAL[1]); ctx->pHives[i].pbDUAL[1] = NULL;
+        }
+    }
+    tcRead = GetTickCount64();
+    // 3: build key trees in parallel - one hive per worker.
+    VmmWorkParallelForeach(ctx->cHive, ctx, (VOID(*)(PVOID, DWORD))VmmWinReg_HiveSnapshotEnsureAll_KeyInitialize);
+    vmmprintfvv_fn("hives: %i windows: %i read: %llims keys: %llims\n", ctx->cHive, ctx->cWindow, tcRead - tcStart, GetTickCount64() - tcRead);
+fail:
+    if(ctx) {
+        for(i = 0; i < ctx->cHive; i++) {
+            LocalFree(ctx->pHives[i].pbDUAL[0]);
+            LocalFree(ctx->pHives[i].pbDUAL[1]);
+            Ob_DECREF(ctx->pHives[i].pHive);
+        }
+        LocalFree(ctx->pWindows);
+        LocalFree(ctx);
+    }
+    Ob_DECREF(pObHive);
+    Ob_DECREF(pmObHive);
+}
+
 
 
 //-----------------------------------------------------------------------------
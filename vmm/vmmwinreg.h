@@ -34,6 +34,11 @@ typedef struct tdOB_REGISTRY_HIVE {
             PBYTE pb;
         } _DUAL[2];
     } Snapshot;
+    // flat registry address translation tables - initialized on first translation.
+    struct {
+        BOOL fInitialized;
+        PQWORD pva[2];          // hive page index -> page virtual address (0 = invalid). [0] = Static, [1] = Volatile.
+    } Reg2Virt;
 } OB_REGISTRY_HIVE, *POB_REGISTRY_HIVE;
 
 typedef struct tdVMM_REGISTRY_KEY_INFO {
@@ -293,6 +298,13 @@ BOOL VmmWinReg_ValueQuery3(_In_ POB_REGISTRY_HIVE pHive, _In_ LPWSTR wszPathKeyV
 _Success_(return)
 BOOL VmmWinReg_ValueQuery4(_In_ POB_REGISTRY_HIVE pHive, _In_ POB_REGISTRY_VALUE pKeyValue, _Out_opt_ PDWORD pdwType, _Out_writes_opt_(cbData) PBYTE pbData, _In_ DWORD cbData, _Out_opt_ PDWORD pcbData);
 
+/*
+* Ensure registry hive snapshots (hive memory and key tree) are taken of all
+* registry hives. The work is spread over the worker thread pool. This is
+* recommended before iterating over the keys of all hives.
+*/
+VOID VmmWinReg_HiveSnapshotEnsureAll();
+
 /*
 * Function to allow the forensic sub-system to request extraction of all keys
 * from a specific hive. The key information will be delivered back to the
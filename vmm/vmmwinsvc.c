@@ -206,106 +206,176 @@ finish:
     LocalFree(pb);
 }
 
+#define VMMWINSVC_STR_PREFETCH_SIZE     (2 * 2048)
+
 /*
-* Retrieve services from the service database list structure.
-* CALLER DECREF: return
+* Queue a not yet resolved service string for prefetch.
+* -- psPrefetch
+* -- wsz = virtual address of string in services.exe.
+*/
+VOID VmmWinSvc_PrefetchStr(_In_ POB_SET psPrefetch, _In_opt_ LPWSTR wsz)
+{
+    if(((QWORD)wsz >= 0x10000) && VMM_UADDR((QWORD)wsz)) {
+        ObSet_Push_PageAlign(psPrefetch, (QWORD)wsz, VMMWINSVC_STR_PREFETCH_SIZE);
+    }
+}
+
+/*
+* Parse a single service record of the service database list. Linked records
+* and data referenced by the record (strings and extended info) are queued for
+* prefetch in the next batch.
 * -- ctx
 * -- pProcessSvc
-* -- cVaListHead
-* -- pvaListHead
-* -- return
+* -- va = address of service record.
+* -- pmSvc
+* -- psNext = set of linked records to walk in the next batch.
+* -- psPrefetch
+* -- return = the new service entry or NULL.
 */
-POB_MAP VmmWinSvc_MainListWalk(_In_ PVMMWINSVC_CONTEXT ctx, _In_ PVMM_PROCESS pProcessSvc, _In_ DWORD cVaListHead, _In_reads_(cVaListHead) PQWORD pvaListHead)
+PVMM_MAP_SERVICEENTRY VmmWinSvc_MainListWalk_Entry(_In_ PVMMWINSVC_CONTEXT ctx, _In_ PVMM_PROCESS pProcessSvc, _In_ QWORD va, _In_ POB_MAP pmSvc, _In_ POB_SET psNext, _In_ POB_SET psPrefetch)
 {
     BOOL f32 = ctxVmm->f32;
     DWORD dwOrdinal, dwStartType;
-    QWORD i, va, va1, va2, va3;
+    QWORD va1, va2, va3;
     BYTE pb[0x200] = { 0 };
-    POB_SET psA = NULL;
-    POB_MAP pmSvc = NULL;
     PVMM_MAP_SERVICEENTRY pe;
     PVMMWINSVC_OFFSET_SC19 o = &ctx->oSc19;
-    if(!(psA = ObSet_New())) { goto fail; }
-    if(!(pmSvc = ObMap_New(OB_MAP_FLAGS_OBJECT_LOCALFREE))) { goto fail; }
-    for(i = 0; i < cVaListHead; i++) {
-        ObSet_Push(psA, pvaListHead[i]);
+    // read & sanity check
+    if(ObMap_ExistsKey(pmSvc, va)) { return NULL; }
+    if(!VmmRead(pProcessSvc, va, pb, o->_Size)) { return NULL; }
+    if(o->fTag && !VMM_POOLTAG(*(PDWORD)(pb + o->Tag), o->TagV)) { return NULL; }
+    if((dwOrdinal = *(PDWORD)(pb + o->Ordinal)) > 0xffff) { return NULL; }
+    if((dwStartType = *(PDWORD)(pb + o->SvcTp)) > SERVICE_TYPE_ALL) { return NULL; }
+    // BLink / FLink
+    va1 = VMM_PTR_OFFSET(f32, pb, o->BLink);
+    va2 = VMM_PTR_OFFSET(f32, pb, o->FLink);
+    if(!VMM_UADDR_4_8(va1)) { va1 = 0; }
+    if(!VMM_UADDR_4_8(va2)) { va2 = 0; }
+    if(!va1 && !va2) { return NULL; }
+    if(va1 && !ObMap_ExistsKey(pmSvc, va1)) {
+        ObSet_Push(psNext, va1);
+        ObSet_Push_PageAlign(psPrefetch, va1, o->_Size);
+    }
+    if(va2 && !ObMap_ExistsKey(pmSvc, va2)) {
+        ObSet_Push(psNext, va2);
+        ObSet_Push_PageAlign(psPrefetch, va2, o->_Size);
     }
-    while((va = ObSet_Pop(psA))) {
-        // read & sanity check
-        if(ObMap_ExistsKey(pmSvc, va)) { continue; }
-        if(!VmmRead(pProcessSvc, va, pb, o->_Size)) { continue; }
-        if(o->fTag && !VMM_POOLTAG(*(PDWORD)(pb + o->Tag), o->TagV)) { continue; }
-        if((dwOrdinal = *(PDWORD)(pb + o->Ordinal)) > 0xffff) { continue; }
-        if((dwStartType = *(PDWORD)(pb + o->SvcTp)) > SERVICE_TYPE_ALL) { continue; }
-        // BLink / FLink
-        va1 = VMM_PTR_OFFSET(f32, pb, o->BLink);
-        va2 = VMM_PTR_OFFSET(f32, pb, o->FLink);
-        if(!VMM_UADDR_4_8(va1)) { va1 = 0; }
-        if(!VMM_UADDR_4_8(va2)) { va2 = 0; }
-        if(!va1 && !va2) { continue; }
-        ObSet_Push(psA, va1);
-        ObSet_Push(psA, va2);
-        if(!VMM_UADDR(VMM_PTR_OFFSET(f32, pb, o->NmShort))) { continue; }
-        // allocate & assign
-        if(!(pe = LocalAlloc(LMEM_ZEROINIT, sizeof(VMM_MAP_SERVICEENTRY)))) { continue; }
-        ObMap_Push(pmSvc, va, pe);
-        pe->vaObj = va;
-        pe->dwOrdinal = dwOrdinal;
-        pe->dwStartType = dwStartType;
-        memcpy(&pe->ServiceStatus, pb + o->SvcStatus, sizeof(SERVICE_STATUS));
-        pe->wszServiceName = (LPWSTR)VMM_PTR_OFFSET(f32, pb, o->NmShort);
-        pe->wszDisplayName = (LPWSTR)VMM_PTR_OFFSET(f32, pb, o->NmLong);
-        if((pe->ServiceStatus.dwServiceType & SERVICE_KERNEL_DRIVER) || (pe->ServiceStatus.dwServiceType & SERVICE_FILE_SYSTEM_DRIVER)) {
-            pe->wszPath = (LPWSTR)VMM_PTR_OFFSET(f32, pb, o->ExtInfo);
-        } else {
-            va3 = VMM_PTR_OFFSET(f32, pb, o->ExtInfo);
-            pe->_Reserved = VMM_UADDR_4_8(va3) ? va3 : 0;
+    if(!VMM_UADDR(VMM_PTR_OFFSET(f32, pb, o->NmShort))) { return NULL; }
+    // allocate & assign
+    if(!(pe = LocalAlloc(LMEM_ZEROINIT, sizeof(VMM_MAP_SERVICEENTRY)))) { return NULL; }
+    ObMap_Push(pmSvc, va, pe);
+    pe->vaObj = va;
+    pe->dwOrdinal = dwOrdinal;
+    pe->dwStartType = dwStartType;
+    memcpy(&pe->ServiceStatus, pb + o->SvcStatus, sizeof(SERVICE_STATUS));
+    pe->wszServiceName = (LPWSTR)VMM_PTR_OFFSET(f32, pb, o->NmShort);
+    pe->wszDisplayName = (LPWSTR)VMM_PTR_OFFSET(f32, pb, o->NmLong);
+    if((pe->ServiceStatus.dwServiceType & SERVICE_KERNEL_DRIVER) || (pe->ServiceStatus.dwServiceType & SERVICE_FILE_SYSTEM_DRIVER)) {
+        pe->wszPath = (LPWSTR)VMM_PTR_OFFSET(f32, pb, o->ExtInfo);
+        VmmWinSvc_PrefetchStr(psPrefetch, pe->wszPath);
+    } else {
+        va3 = VMM_PTR_OFFSET(f32, pb, o->ExtInfo);
+        pe->_Reserved = VMM_UADDR_4_8(va3) ? va3 : 0;
+        if(pe->_Reserved) {
+            ObSet_Push_PageAlign(psPrefetch, pe->_Reserved, ctx->oSc16._Size);
         }
     }
-    Ob_INCREF(pmSvc);
-fail:
-    Ob_DECREF(psA);
-    return Ob_DECREF(pmSvc);
+    VmmWinSvc_PrefetchStr(psPrefetch, pe->wszServiceName);
+    VmmWinSvc_PrefetchStr(psPrefetch, pe->wszDisplayName);
+    return pe;
 }
 
 /*
 * Retrieve the extended service info such as service process id, service user
-* and other data which is found in the 'Sc16' data structure.
+* and other data which is found in the 'Sc16' data structure. The extended info
+* is expected to have been prefetched. Referenced strings are queued for
+* prefetch in the next batch.
 * -- ctx
 * -- pProcessSvc
-* -- pmSvc
+* -- pe
+* -- psPrefetch
 */
-VOID VmmWinSvc_GetExtendedInfo(_In_ PVMMWINSVC_CONTEXT ctx, _In_ PVMM_PROCESS pProcessSvc, _In_ POB_MAP pmSvc)
+VOID VmmWinSvc_GetExtendedInfo_Entry(_In_ PVMMWINSVC_CONTEXT ctx, _In_ PVMM_PROCESS pProcessSvc, _In_ PVMM_MAP_SERVICEENTRY pe, _In_ POB_SET psPrefetch)
 {
     BOOL f32 = ctxVmm->f32;
     QWORD va;
     BYTE pb[0x80] = { 0 };
-    POB_SET psObPrefetch = NULL;
-    PVMM_MAP_SERVICEENTRY pe = NULL;
     PVMMWINSVC_OFFSET_SC16 o = &ctx->oSc16;
-    if((psObPrefetch = ObSet_New())) {
-        while((pe = ObMap_GetNext(pmSvc, pe))) {
-            ObSet_Push(psObPrefetch, pe->_Reserved);
-        }
-        VmmCachePrefetchPages3(pProcessSvc, psObPrefetch, o->_Size, 0);
-        Ob_DECREF_NULL(&psObPrefetch);
+    if(!(va = pe->_Reserved)) { return; }
+    pe->_Reserved = 0;
+    if(!VmmRead2(pProcessSvc, va, pb, o->_Size, VMM_FLAG_FORCECACHE_READ)) { return; }
+    if(o->fTag) {
+        if(!VMM_POOLTAG(*(PDWORD)(pb + o->Tag), 'Sc16')) { return; }
+    } else {
+        if(!(va = VMM_PTR_OFFSET(f32, pb, o->BLink)) || !VMM_UADDR_4_8(va)) { return; }
+        if(!(va = VMM_PTR_OFFSET(f32, pb, o->FLink)) || !VMM_UADDR_4_8(va)) { return; }
     }
-    while((pe = ObMap_GetNext(pmSvc, pe))) {
-        if((va = pe->_Reserved)) {
-            pe->_Reserved = 0;
-            if(!VmmRead2(pProcessSvc, va, pb, o->_Size, VMM_FLAG_FORCECACHE_READ)) { continue; }
-            if(o->fTag) {
-                if(!VMM_POOLTAG(*(PDWORD)(pb + o->Tag), 'Sc16')) { continue; }
-            } else {
-                if(!(va = VMM_PTR_OFFSET(f32, pb, o->BLink)) || !VMM_UADDR_4_8(va)) { continue; }
-                if(!(va = VMM_PTR_OFFSET(f32, pb, o->FLink)) || !VMM_UADDR_4_8(va)) { continue; }
+    pe->dwPID = *(PDWORD)(pb + o->Pid);
+    pe->wszPath = (LPWSTR)VMM_PTR_OFFSET(f32, pb, o->StartupPath);
+    pe->wszUserTp = o->UserTp ? (LPWSTR)VMM_PTR_OFFSET(f32, pb, o->UserTp) : NULL;
+    pe->wszUserAcct = o->UserAcct ? (LPWSTR)VMM_PTR_OFFSET(f32, pb, o->UserAcct) : NULL;
+    VmmWinSvc_PrefetchStr(psPrefetch, pe->wszPath);
+    VmmWinSvc_PrefetchStr(psPrefetch, pe->wszUserTp);
+    VmmWinSvc_PrefetchStr(psPrefetch, pe->wszUserAcct);
+}
+
+/*
+* Retrieve services from the service database list structure together with
+* their extended info. The walk is performed in batches - each batch fetches
+* the next list records, the extended info of the previous batch and strings
+* of the batches before in a single prefetch round trip.
+* CALLER DECREF: return
+* -- ctx
+* -- pProcessSvc
+* -- cVaListHead
+* -- pvaListHead
+* -- return
+*/
+POB_MAP VmmWinSvc_MainListWalk(_In_ PVMMWINSVC_CONTEXT ctx, _In_ PVMM_PROCESS pProcessSvc, _In_ DWORD cVaListHead, _In_reads_(cVaListHead) PQWORD pvaListHead)
+{
+    QWORD i, va, tmStart = GetTickCount64();
+    DWORD cRoundTrip = 0;
+    POB_SET psA = NULL, psNext = NULL, psExt = NULL, psExtNext = NULL, psPrefetch = NULL, psSwap;
+    POB_MAP pmSvc = NULL;
+    PVMM_MAP_SERVICEENTRY pe;
+    if(!(psA = ObSet_New())) { goto fail; }
+    if(!(psNext = ObSet_New())) { goto fail; }
+    if(!(psExt = ObSet_New())) { goto fail; }
+    if(!(psExtNext = ObSet_New())) { goto fail; }
+    if(!(psPrefetch = ObSet_New())) { goto fail; }
+    if(!(pmSvc = ObMap_New(OB_MAP_FLAGS_OBJECT_LOCALFREE))) { goto fail; }
+    for(i = 0; i < cVaListHead; i++) {
+        ObSet_Push(psA, pvaListHead[i]);
+        ObSet_Push_PageAlign(psPrefetch, pvaListHead[i], ctx->oSc19._Size);
+    }
+    while(ObSet_Size(psA) || ObSet_Size(psExt) || ObSet_Size(psPrefetch)) {
+        VmmCachePrefetchPages(pProcessSvc, psPrefetch, 0);
+        ObSet_Clear(psPrefetch);
+        cRoundTrip++;
+        while((va = ObSet_Pop(psA))) {
+            if((pe = VmmWinSvc_MainListWalk_Entry(ctx, pProcessSvc, va, pmSvc, psNext, psPrefetch)) && pe->_Reserved) {
+                ObSet_Push(psExtNext, (QWORD)pe);
             }
-            pe->dwPID = *(PDWORD)(pb + o->Pid);
-            pe->wszPath = (LPWSTR)VMM_PTR_OFFSET(f32, pb, o->StartupPath);
-            pe->wszUserTp = o->UserTp ? (LPWSTR)VMM_PTR_OFFSET(f32, pb, o->UserTp) : NULL;
-            pe->wszUserAcct = o->UserAcct ? (LPWSTR)VMM_PTR_OFFSET(f32, pb, o->UserAcct) : NULL;
         }
+        while((pe = (PVMM_MAP_SERVICEENTRY)ObSet_Pop(psExt))) {
+            VmmWinSvc_GetExtendedInfo_Entry(ctx, pProcessSvc, pe, psPrefetch);
+        }
+        psSwap = psA;
+        psA = psNext;
+        psNext = psSwap;
+        psSwap = psExt;
+        psExt = psExtNext;
+        psExtNext = psSwap;
     }
+    vmmprintfvv_fn("%i services in %i round trips [%llims]\n", ObMap_Size(pmSvc), cRoundTrip, GetTickCount64() - tmStart);
+    Ob_INCREF(pmSvc);
+fail:
+    Ob_DECREF(psA);
+    Ob_DECREF(psNext);
+    Ob_DECREF(psExt);
+    Ob_DECREF(psExtNext);
+    Ob_DECREF(psPrefetch);
+    return Ob_DECREF(pmSvc);
 }
 
 #define VMMWINSVC_MULTITEXT_MAX         0x00800000
@@ -378,7 +448,7 @@ BOOL VmmWinSvc_ResolveStrAll(_In_ PVMM_PROCESS pProcessSvc, _In_ POB_MAP pmSvc,
             ObSet_Push(psObPrefetch, (QWORD)pe->wszUserTp);
             ObSet_Push(psObPrefetch, (QWORD)pe->wszUserAcct);
         }
-        VmmCachePrefetchPages3(pProcessSvc, psObPrefetch, 2 * 2048, 0);
+        VmmCachePrefetchPages3(pProcessSvc, psObPrefetch, VMMWINSVC_STR_PREFETCH_SIZE, 0);
         Ob_DECREF_NULL(&psObPrefetch);
     }
     // 3: fetch strings
@@ -454,7 +524,6 @@ PVMMOB_MAP_SERVICE VmmWinSvc_Initialize_DoWork()
     if(!vaSvcDatabase[0] && !vaSvcDatabase[1]) { goto fail; }
     // 2: walk services list and resolve extended info and strings
     if(!(pmObSvc = VmmWinSvc_MainListWalk(&InitCtx, pObSvcProcess, 2, vaSvcDatabase))) { goto fail; }
-    VmmWinSvc_GetExtendedInfo(&InitCtx, pObSvcProcess, pmObSvc);
     if(!VmmWinSvc_ResolveStrAll(pObSvcProcess, pmObSvc, &wszMultiText, &cbMultiText)) { goto fail; }
     // 3: allocate, assign and sort services map
     cSvc = ObMap_Size(pmObSvc);
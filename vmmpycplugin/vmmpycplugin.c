@@ -19,9 +19,53 @@
 
 
 //-----------------------------------------------------------------------------
-// PY2C PYTHON CALLBACK FUNCTIONALITY BELOW:
+// PY2C CONTEXT AND COMMON DEFINES BELOW:
 //-----------------------------------------------------------------------------
 
+#define PY2C_HASH_BUCKETS               0x100
+#define PY2C_LISTCACHE_MAX              0x1000
+#define PY2C_CONTENTCACHE_MAX           0x01000000      // max natively cached file content: 16MB
+
+#ifndef PyBUF_WRITE
+#define PyBUF_WRITE                     0x200
+#endif /* PyBUF_WRITE */
+
+/*
+* Static file/directory registered by the python plugin manager. Entries are
+* linked both by path hash (lookup) and by parent path hash (listing).
+*/
+typedef struct tdPY2C_STATIC_ENTRY {
+    struct tdPY2C_STATIC_ENTRY *FLink;
+    struct tdPY2C_STATIC_ENTRY *FLinkParent;
+    QWORD qwHash;
+    QWORD qwHashParent;
+    QWORD cb;
+    BOOL fDir;
+    BOOL fDynamic;                  // directory with python 'list' callback.
+    BOOL fCache;                    // file content may be cached natively.
+    DWORD _Reserved;
+    PBYTE pbContent;                // natively cached file content (if any).
+    WCHAR wszName[0];
+} PY2C_STATIC_ENTRY, *PPY2C_STATIC_ENTRY;
+
+typedef struct tdPY2C_LISTCACHE_ENTRY {
+    QWORD cb;
+    BOOL fDir;
+    DWORD cbEntry;                  // size of this entry including name.
+    WCHAR wszName[0];
+} PY2C_LISTCACHE_ENTRY, *PPY2C_LISTCACHE_ENTRY;
+
+/*
+* Cached result of a dynamic python directory listing - valid until notify.
+*/
+typedef struct tdPY2C_LISTCACHE {
+    struct tdPY2C_LISTCACHE *FLink;
+    QWORD qwHash;
+    DWORD cEntry;
+    DWORD _Reserved;
+    BYTE pbEntry[0];
+} PY2C_LISTCACHE, *PPY2C_LISTCACHE;
+
 typedef struct tdPY2C_CONTEXT {
 	BOOL fPrintf;
 	BOOL fVerbose;
@@ -33,10 +77,378 @@ typedef struct tdPY2C_CONTEXT {
     PyObject *fnWrite;
 	PyObject *fnNotify;
     PyObject *fnClose;
+    PyObject *fnReadInto;
+    SRWLOCK LockSRW;
+    DWORD dwGeneration;             // incremented on content invalidation.
+    DWORD cListCache;
+    PPY2C_STATIC_ENTRY pStatic[PY2C_HASH_BUCKETS];
+    PPY2C_STATIC_ENTRY pStaticParent[PY2C_HASH_BUCKETS];
+    PPY2C_LISTCACHE pListCache[PY2C_HASH_BUCKETS];
 } PY2C_CONTEXT, *PPY2C_CONTEXT;
 
 PPY2C_CONTEXT ctxPY2C = NULL;
 
+/*
+* Hash a python plugin path. Empty path components are ignored and both '/'
+* and '\\' are treated as delimiters to match the python side path handling.
+* -- fRoot = root directory (TRUE) or process directory (FALSE).
+* -- wszPath
+* -- pqwHashParent = optional hash of the parent directory.
+* -- return
+*/
+QWORD PY2C_Util_HashPath(_In_ BOOL fRoot, _In_ LPCWSTR wszPath, _Out_opt_ PQWORD pqwHashParent)
+{
+    QWORD qwHash = fRoot ? 0xcbf29ce484222325 : 0x84222325cbf29ce4, qwHashParent = qwHash;
+    BOOL fComponentNew = TRUE;
+    WCHAR wch;
+    while((wch = *wszPath++)) {
+        if((wch == '/') || (wch == '\\')) {
+            fComponentNew = TRUE;
+            continue;
+        }
+        if(fComponentNew) {
+            fComponentNew = FALSE;
+            qwHashParent = qwHash;
+            qwHash = (qwHash ^ '/') * 0x100000001b3;
+        }
+        qwHash = (qwHash ^ wch) * 0x100000001b3;
+    }
+    if(pqwHashParent) { *pqwHashParent = qwHashParent; }
+    return qwHash;
+}
+
+/*
+* Retrieve the hash used for the dynamic list cache of a plugin context.
+* -- ctx
+* -- return
+*/
+QWORD PY2C_Util_HashListCache(_In_ PVMMDLL_PLUGIN_CONTEXT ctx)
+{
+    return PY2C_Util_HashPath(ctx->dwPID == -1, ctx->wszPath, NULL) + ctx->dwPID * 0x9e3779b97f4a7c15;
+}
+
+
+
+//-----------------------------------------------------------------------------
+// PY2C NATIVE STATIC FILE REGISTRY AND LIST CACHE BELOW:
+// Files and directories registered by the python plugin manager are mirrored
+// natively so that listings and out-of-range reads are served without taking
+// the GIL. Dynamic listings are cached until the next notify event. All
+// native state is protected by ctxPY2C->LockSRW.
+//-----------------------------------------------------------------------------
+
+/*
+* Retrieve a static entry by its path hash. CALLER MUST HOLD LockSRW.
+*/
+PPY2C_STATIC_ENTRY PY2C_Static_Get(_In_ QWORD qwHash)
+{
+    PPY2C_STATIC_ENTRY pe = ctxPY2C->pStatic[qwHash % PY2C_HASH_BUCKETS];
+    while(pe && (pe->qwHash != qwHash)) {
+        pe = pe->FLink;
+    }
+    return pe;
+}
+
+/*
+* Retrieve a child of a static directory. CALLER MUST HOLD LockSRW.
+*/
+PPY2C_STATIC_ENTRY PY2C_Static_GetChild(_In_ QWORD qwHashParent)
+{
+    PPY2C_STATIC_ENTRY pe = ctxPY2C->pStaticParent[qwHashParent % PY2C_HASH_BUCKETS];
+    while(pe && (pe->qwHashParent != qwHashParent)) {
+        pe = pe->FLinkParent;
+    }
+    return pe;
+}
+
+/*
+* Drop natively cached content of an entry and its children.
+* CALLER MUST HOLD LockSRW EXCLUSIVE.
+*/
+VOID PY2C_Static_InvalidateContent(_In_ PPY2C_STATIC_ENTRY pe)
+{
+    PPY2C_STATIC_ENTRY peChild;
+    LocalFree(pe->pbContent);
+    pe->pbContent = NULL;
+    if(pe->fDir) {
+        peChild = ctxPY2C->pStaticParent[pe->qwHash % PY2C_HASH_BUCKETS];
+        for(; peChild; peChild = peChild->FLinkParent) {
+            if(peChild->qwHashParent == pe->qwHash) {
+                PY2C_Static_InvalidateContent(peChild);
+            }
+        }
+    }
+}
+
+/*
+* Remove a static entry and all its children. CALLER MUST HOLD LockSRW EXCLUSIVE.
+*/
+VOID PY2C_Static_Remove(_In_ QWORD qwHash)
+{
+    PPY2C_STATIC_ENTRY pe, peChild, *ppe;
+    ppe = &ctxPY2C->pStatic[qwHash % PY2C_HASH_BUCKETS];
+    while((pe = *ppe) && (pe->qwHash != qwHash)) {
+        ppe = &pe->FLink;
+    }
+    if(!pe) { return; }
+    *ppe = pe->FLink;
+    ppe = &ctxPY2C->pStaticParent[pe->qwHashParent % PY2C_HASH_BUCKETS];
+    while(*ppe && (*ppe != pe)) {
+        ppe = &(*ppe)->FLinkParent;
+    }
+    if(*ppe) { *ppe = pe->FLinkParent; }
+    if(pe->fDir) {
+        while((peChild = PY2C_Static_GetChild(qwHash))) {
+            PY2C_Static_Remove(peChild->qwHash);
+        }
+    }
+    LocalFree(pe->pbContent);
+    LocalFree(pe);
+}
+
+/*
+* Register (or overwrite) a static file or directory. Any previous entry with
+* the same path is removed together with its children - which mirrors the
+* python side dict overwrite.
+* -- fRoot
+* -- wszPath
+* -- cb
+* -- fDir
+* -- fDynamic
+* -- fCache = ignored for process (non-root) registrations.
+*/
+VOID PY2C_Static_Register(_In_ BOOL fRoot, _In_ LPWSTR wszPath, _In_ QWORD cb, _In_ BOOL fDir, _In_ BOOL fDynamic, _In_ BOOL fCache)
+{
+    PPY2C_STATIC_ENTRY pe;
+    QWORD qwHash, qwHashParent;
+    SIZE_T cch, oName;
+    qwHash = PY2C_Util_HashPath(fRoot, wszPath, &qwHashParent);
+    if(qwHash == qwHashParent) { return; }
+    // name is the last non-empty path component:
+    cch = wcslen(wszPath);
+    while(cch && ((wszPath[cch - 1] == '/') || (wszPath[cch - 1] == '\\'))) { cch--; }
+    oName = cch;
+    while(oName && (wszPath[oName - 1] != '/') && (wszPath[oName - 1] != '\\')) { oName--; }
+    cch -= oName;
+    if(!(pe = LocalAlloc(LMEM_ZEROINIT, sizeof(PY2C_STATIC_ENTRY) + (cch + 1) * sizeof(WCHAR)))) { return; }
+    memcpy(pe->wszName, wszPath + oName, cch * sizeof(WCHAR));
+    pe->qwHash = qwHash;
+    pe->qwHashParent = qwHashParent;
+    pe->cb = fDir ? 0 : cb;
+    pe->fDir = fDir;
+    pe->fDynamic = fDir && fDynamic;
+    // process directory registrations are shared by all processes while file
+    // contents may differ per process - only root file contents are cached.
+    pe->fCache = fRoot && !fDir && fCache && (cb <= PY2C_CONTENTCACHE_MAX);
+    AcquireSRWLockExclusive(&ctxPY2C->LockSRW);
+    PY2C_Static_Remove(qwHash);
+    pe->FLink = ctxPY2C->pStatic[qwHash % PY2C_HASH_BUCKETS];
+    ctxPY2C->pStatic[qwHash % PY2C_HASH_BUCKETS] = pe;
+    pe->FLinkParent = ctxPY2C->pStaticParent[qwHashParent % PY2C_HASH_BUCKETS];
+    ctxPY2C->pStaticParent[qwHashParent % PY2C_HASH_BUCKETS] = pe;
+    ctxPY2C->dwGeneration++;
+    ReleaseSRWLockExclusive(&ctxPY2C->LockSRW);
+}
+
+/*
+* Clear the dynamic list cache. CALLER MUST HOLD LockSRW EXCLUSIVE.
+*/
+VOID PY2C_ListCache_Clear()
+{
+    DWORD i;
+    PPY2C_LISTCACHE pc;
+    for(i = 0; i < PY2C_HASH_BUCKETS; i++) {
+        while((pc = ctxPY2C->pListCache[i])) {
+            ctxPY2C->pListCache[i] = pc->FLink;
+            LocalFree(pc);
+        }
+    }
+    ctxPY2C->cListCache = 0;
+}
+
+/*
+* Invalidate natively cached content and listings.
+* -- fRoot
+* -- wszPath = path to invalidate, or NULL to invalidate everything.
+*/
+VOID PY2C_Static_Invalidate(_In_ BOOL fRoot, _In_opt_ LPWSTR wszPath)
+{
+    DWORD i;
+    PPY2C_STATIC_ENTRY pe;
+    QWORD qwHash, qwHashParent;
+    AcquireSRWLockExclusive(&ctxPY2C->LockSRW);
+    if(wszPath) {
+        qwHash = PY2C_Util_HashPath(fRoot, wszPath, &qwHashParent);
+        if(qwHash == qwHashParent) {
+            // root directory - invalidate all top level entries.
+            for(pe = ctxPY2C->pStaticParent[qwHash % PY2C_HASH_BUCKETS]; pe; pe = pe->FLinkParent) {
+                if(pe->qwHashParent == qwHash) { PY2C_Static_InvalidateContent(pe); }
+            }
+        } else if((pe = PY2C_Static_Get(qwHash))) {
+            PY2C_Static_InvalidateContent(pe);
+        }
+    } else {
+        for(i = 0; i < PY2C_HASH_BUCKETS; i++) {
+            for(pe = ctxPY2C->pStatic[i]; pe; pe = pe->FLink) {
+                LocalFree(pe->pbContent);
+                pe->pbContent = NULL;
+            }
+        }
+    }
+    PY2C_ListCache_Clear();
+    ctxPY2C->dwGeneration++;
+    ReleaseSRWLockExclusive(&ctxPY2C->LockSRW);
+}
+
+/*
+* List a static directory natively. Dynamic directories and paths residing
+* below dynamic directories are not handled.
+* -- ctx
+* -- pFileList
+* -- return = TRUE if the listing was served from the static registry.
+*/
+_Success_(return)
+BOOL PY2C_Static_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileList)
+{
+    BOOL fResult;
+    PPY2C_STATIC_ENTRY pe;
+    QWORD qwHash, qwHashParent;
+    qwHash = PY2C_Util_HashPath(ctx->dwPID == -1, ctx->wszPath, &qwHashParent);
+    AcquireSRWLockShared(&ctxPY2C->LockSRW);
+    pe = PY2C_Static_Get(qwHash);
+    fResult = (qwHash == qwHashParent) || (pe && pe->fDir && !pe->fDynamic);
+    if(fResult) {
+        for(pe = ctxPY2C->pStaticParent[qwHash % PY2C_HASH_BUCKETS]; pe; pe = pe->FLinkParent) {
+            if(pe->qwHashParent != qwHash) { continue; }
+            if(pe->fDir) {
+                VMMDLL_VfsList_AddDirectory(pFileList, pe->wszName, NULL);
+            } else {
+                VMMDLL_VfsList_AddFile(pFileList, pe->wszName, pe->cb, NULL);
+            }
+        }
+    }
+    ReleaseSRWLockShared(&ctxPY2C->LockSRW);
+    return fResult;
+}
+
+/*
+* List a dynamic directory from the list cache (if cached).
+* -- qwHash
+* -- pFileList
+* -- return = TRUE if the listing was served from the cache.
+*/
+_Success_(return)
+BOOL PY2C_ListCache_List(_In_ QWORD qwHash, _Inout_ PHANDLE pFileList)
+{
+    DWORD i;
+    PPY2C_LISTCACHE pc;
+    PPY2C_LISTCACHE_ENTRY pe;
+    AcquireSRWLockShared(&ctxPY2C->LockSRW);
+    pc = ctxPY2C->pListCache[qwHash % PY2C_HASH_BUCKETS];
+    while(pc && (pc->qwHash != qwHash)) {
+        pc = pc->FLink;
+    }
+    if(pc) {
+        pe = (PPY2C_LISTCACHE_ENTRY)pc->pbEntry;
+        for(i = 0; i < pc->cEntry; i++) {
+            if(pe->fDir) {
+                VMMDLL_VfsList_AddDirectory(pFileList, pe->wszName, NULL);
+            } else {
+                VMMDLL_VfsList_AddFile(pFileList, pe->wszName, pe->cb, NULL);
+            }
+            pe = (PPY2C_LISTCACHE_ENTRY)((PBYTE)pe + pe->cbEntry);
+        }
+    }
+    ReleaseSRWLockShared(&ctxPY2C->LockSRW);
+    return pc ? TRUE : FALSE;
+}
+
+/*
+* Insert a dynamic listing into the list cache. On success the list cache
+* takes ownership of pc; otherwise pc is free'd.
+* -- pc
+*/
+VOID PY2C_ListCache_Insert(_In_ PPY2C_LISTCACHE pc)
+{
+    PPY2C_LISTCACHE pcExisting;
+    AcquireSRWLockExclusive(&ctxPY2C->LockSRW);
+    pcExisting = ctxPY2C->pListCache[pc->qwHash % PY2C_HASH_BUCKETS];
+    while(pcExisting && (pcExisting->qwHash != pc->qwHash)) {
+        pcExisting = pcExisting->FLink;
+    }
+    if(!pcExisting && (ctxPY2C->cListCache < PY2C_LISTCACHE_MAX)) {
+        pc->FLink = ctxPY2C->pListCache[pc->qwHash % PY2C_HASH_BUCKETS];
+        ctxPY2C->pListCache[pc->qwHash % PY2C_HASH_BUCKETS] = pc;
+        ctxPY2C->cListCache++;
+        pc = NULL;
+    }
+    ReleaseSRWLockExclusive(&ctxPY2C->LockSRW);
+    LocalFree(pc);
+}
+
+/*
+* Python callable: register a static file or directory natively.
+* (f_root, path, size, f_isdir, f_isdynamic, f_iscacheable) -> None
+*/
+static PyObject*
+PY2C_StaticRegister(PyObject *self, PyObject *args)
+{
+    PyObject *pyPath;
+    LPWSTR wszPath;
+    int fRoot, fDir, fDynamic, fCache;
+    unsigned long long cb;
+    if(!PyArg_ParseTuple(args, "pUKppp", &fRoot, &pyPath, &cb, &fDir, &fDynamic, &fCache)) { return NULL; }
+    if(!(wszPath = PyUnicode_AsWideCharString(pyPath, NULL))) { return NULL; }
+    PY2C_Static_Register(fRoot, wszPath, cb, fDir, fDynamic, fCache);
+    PyMem_Free(wszPath);
+    return Py_BuildValue("s", NULL);    // None returned on success.
+}
+
+/*
+* Python callable: unregister a static file or directory (and its children).
+* (f_root, path) -> None
+*/
+static PyObject*
+PY2C_StaticUnregister(PyObject *self, PyObject *args)
+{
+    PyObject *pyPath;
+    LPWSTR wszPath;
+    int fRoot;
+    if(!PyArg_ParseTuple(args, "pU", &fRoot, &pyPath)) { return NULL; }
+    if(!(wszPath = PyUnicode_AsWideCharString(pyPath, NULL))) { return NULL; }
+    AcquireSRWLockExclusive(&ctxPY2C->LockSRW);
+    PY2C_Static_Remove(PY2C_Util_HashPath(fRoot, wszPath, NULL));
+    ctxPY2C->dwGeneration++;
+    ReleaseSRWLockExclusive(&ctxPY2C->LockSRW);
+    PyMem_Free(wszPath);
+    return Py_BuildValue("s", NULL);    // None returned on success.
+}
+
+/*
+* Python callable: invalidate natively cached file contents and listings.
+* (f_root, path or None) -> None
+*/
+static PyObject*
+PY2C_Invalidate(PyObject *self, PyObject *args)
+{
+    PyObject *pyPath = NULL;
+    LPWSTR wszPath = NULL;
+    int fRoot;
+    if(!PyArg_ParseTuple(args, "p|O", &fRoot, &pyPath)) { return NULL; }
+    if(pyPath && (pyPath != Py_None)) {
+        if(!PyUnicode_Check(pyPath) || !(wszPath = PyUnicode_AsWideCharString(pyPath, NULL))) { return NULL; }
+    }
+    PY2C_Static_Invalidate(fRoot, wszPath);
+    PyMem_Free(wszPath);
+    return Py_BuildValue("s", NULL);    // None returned on success.
+}
+
+
+
+//-----------------------------------------------------------------------------
+// PY2C PYTHON CALLBACK FUNCTIONALITY BELOW:
+//-----------------------------------------------------------------------------
+
 static PyObject*
 PY2C_CallbackRegister(PyObject *self, PyObject *args)
 {
@@ -46,12 +458,16 @@ PY2C_CallbackRegister(PyObject *self, PyObject *args)
         Py_XDECREF(ctxPY2C->fnWrite);
 		Py_XDECREF(ctxPY2C->fnNotify);
         Py_XDECREF(ctxPY2C->fnClose);
-        if(!PyArg_ParseTuple(args, "OOOOO", &ctxPY2C->fnList, &ctxPY2C->fnRead, &ctxPY2C->fnWrite, &ctxPY2C->fnNotify, &ctxPY2C->fnClose)) { return NULL; }
+        Py_XDECREF(ctxPY2C->fnReadInto);
+        ctxPY2C->fnReadInto = NULL;
+        if(!PyArg_ParseTuple(args, "OOOOO|O", &ctxPY2C->fnList, &ctxPY2C->fnRead, &ctxPY2C->fnWrite, &ctxPY2C->fnNotify, &ctxPY2C->fnClose, &ctxPY2C->fnReadInto)) { return NULL; }
+        if(ctxPY2C->fnReadInto == Py_None) { ctxPY2C->fnReadInto = NULL; }
         Py_XINCREF(ctxPY2C->fnList);
         Py_XINCREF(ctxPY2C->fnRead);
         Py_XINCREF(ctxPY2C->fnWrite);
 		Py_XINCREF(ctxPY2C->fnNotify);
         Py_XINCREF(ctxPY2C->fnClose);
+        Py_XINCREF(ctxPY2C->fnReadInto);
         ctxPY2C->fInitialized = TRUE;
     }
     return Py_BuildValue("s", NULL);    // None returned on success.
@@ -68,16 +484,24 @@ BOOL PY2C_Util_TranslatePathDelimiterW(_Out_writes_(MAX_PATH) LPWSTR dst, LPWSTR
     return FALSE;
 }
 
-BOOL PY2C_Callback_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileList)
+/*
+* Retrieve a dynamic directory listing from python. The result is converted
+* into a native list cache entry which is inserted into the list cache.
+* -- ctx
+* -- pFileList
+* -- return
+*/
+BOOL PY2C_Callback_List_Python(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileList)
 {
     BOOL result = FALSE;
     PyObject *args = NULL, *pyList = NULL, *pyDict, *pyPid = NULL, *pyPath = NULL;
     PyObject *pyDict_Name, *pyDict_Size, *pyDict_IsDir;
-    LPWSTR wszDict_Name;
+    LPWSTR *pwszDict_Name = NULL;
+    PPY2C_LISTCACHE pc = NULL;
+    PPY2C_LISTCACHE_ENTRY pe;
     PyGILState_STATE gstate;
-    SIZE_T i, cList;
+    SIZE_T i, cList = 0, cbList = sizeof(PY2C_LISTCACHE);
     WCHAR wszPathBuffer[MAX_PATH];
-    if(!ctxPY2C->fInitialized) { return FALSE; }
     if(!PY2C_Util_TranslatePathDelimiterW(wszPathBuffer, ctx->wszPath)) { return FALSE; }
     gstate = PyGILState_Ensure();
     if(!(pyPath = PyUnicode_FromWideChar(wszPathBuffer, -1))) { goto fail; }
@@ -87,6 +511,8 @@ BOOL PY2C_Callback_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileLi
     pyList = PyObject_CallObject(ctxPY2C->fnList, args);
     if(!pyList || !PyList_Check(pyList)) { goto fail; }
     cList = PyList_Size(pyList);
+    if(!(pwszDict_Name = LocalAlloc(LMEM_ZEROINIT, max(1, cList) * sizeof(LPWSTR)))) { goto fail; }
+    // 1: validate entries and fetch names:
     for(i = 0; i < cList; i++) {
         pyDict = PyList_GetItem(pyList, i); // borrowed reference
         if(!PyDict_Check(pyDict)) { continue; }
@@ -94,62 +520,177 @@ BOOL PY2C_Callback_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileLi
         pyDict_Size = PyDict_GetItemString(pyDict, "size");
         pyDict_IsDir = PyDict_GetItemString(pyDict, "f_isdir");
         if(!pyDict_Name || !PyUnicode_Check(pyDict_Name) || !pyDict_IsDir || !PyBool_Check(pyDict_IsDir)) { continue; }
-        wszDict_Name = PyUnicode_AsWideCharString(pyDict_Name, NULL);
-        if(wszDict_Name) {
-            if(pyDict_IsDir == Py_True) {
-                VMMDLL_VfsList_AddDirectory(pFileList, wszDict_Name, NULL);
-            } else {
-                if(!pyDict_Size || !PyLong_Check(pyDict_Size)) { continue; }
-                VMMDLL_VfsList_AddFile(pFileList, wszDict_Name, PyLong_AsUnsignedLongLong(pyDict_Size), NULL);
-            }
-            PyMem_Free(wszDict_Name);
+        if((pyDict_IsDir != Py_True) && (!pyDict_Size || !PyLong_Check(pyDict_Size))) { continue; }
+        if((pwszDict_Name[i] = PyUnicode_AsWideCharString(pyDict_Name, NULL))) {
+            cbList += (sizeof(PY2C_LISTCACHE_ENTRY) + (wcslen(pwszDict_Name[i]) + 1) * sizeof(WCHAR) + 7) & ~7;
         }
     }
+    // 2: build list cache entry:
+    if(!(pc = LocalAlloc(LMEM_ZEROINIT, cbList))) { goto fail; }
+    pc->qwHash = PY2C_Util_HashListCache(ctx);
+    pe = (PPY2C_LISTCACHE_ENTRY)pc->pbEntry;
+    for(i = 0; i < cList; i++) {
+        if(!pwszDict_Name[i]) { continue; }
+        pyDict = PyList_GetItem(pyList, i); // borrowed reference
+        pe->fDir = (PyDict_GetItemString(pyDict, "f_isdir") == Py_True);
+        pe->cb = pe->fDir ? 0 : PyLong_AsUnsignedLongLong(PyDict_GetItemString(pyDict, "size"));
+        pe->cbEntry = (DWORD)((sizeof(PY2C_LISTCACHE_ENTRY) + (wcslen(pwszDict_Name[i]) + 1) * sizeof(WCHAR) + 7) & ~7);
+        wcscpy_s(pe->wszName, wcslen(pwszDict_Name[i]) + 1, pwszDict_Name[i]);
+        if(pe->fDir) {
+            VMMDLL_VfsList_AddDirectory(pFileList, pe->wszName, NULL);
+        } else {
+            VMMDLL_VfsList_AddFile(pFileList, pe->wszName, pe->cb, NULL);
+        }
+        pe = (PPY2C_LISTCACHE_ENTRY)((PBYTE)pe + pe->cbEntry);
+        pc->cEntry++;
+    }
+    PyErr_Clear();
     result = TRUE;
     // fall through to cleanup
 fail:
+    if(pwszDict_Name) {
+        for(i = 0; i < cList; i++) {
+            PyMem_Free(pwszDict_Name[i]);
+        }
+        LocalFree(pwszDict_Name);
+    }
     Py_XDECREF(args);
     Py_XDECREF(pyPid);
     Py_XDECREF(pyList);
     Py_XDECREF(pyPath);
     PyGILState_Release(gstate);
+    if(pc) {
+        PY2C_ListCache_Insert(pc);
+    }
     return result;
 }
 
-NTSTATUS PY2C_Callback_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_ LPVOID pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ ULONG64 cbOffset)
+BOOL PY2C_Callback_List(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Inout_ PHANDLE pFileList)
+{
+    if(!ctxPY2C->fInitialized) { return FALSE; }
+    if(PY2C_Static_List(ctx, pFileList)) { return TRUE; }
+    if(PY2C_ListCache_List(PY2C_Util_HashListCache(ctx), pFileList)) { return TRUE; }
+    return PY2C_Callback_List_Python(ctx, pFileList);
+}
+
+/*
+* Read a file from python. If a 'readinto' callback is registered python will
+* fill the native buffer in-place through a writable memoryview; otherwise the
+* legacy 'read' callback returning a bytes object is used.
+*/
+NTSTATUS PY2C_Callback_Read_Python(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ ULONG64 cbOffset)
 {
     NTSTATUS nt = VMMDLL_STATUS_FILE_INVALID;
-    PyObject *args = NULL, *pyBytes = NULL, *pyPid = NULL, *pyPath = NULL;
+    PyObject *args = NULL, *pyResult = NULL, *pyPid = NULL, *pyPath = NULL, *pyView = NULL, *pyViewRelease;
     PyGILState_STATE gstate;
+    long long llResult;
     WCHAR wszPathBuffer[MAX_PATH];
-    if(!ctxPY2C->fInitialized) { return FALSE; }
-    if(!PY2C_Util_TranslatePathDelimiterW(wszPathBuffer, ctx->wszPath)) { return FALSE; }
+    *pcbRead = 0;
+    if(!PY2C_Util_TranslatePathDelimiterW(wszPathBuffer, ctx->wszPath)) { return VMMDLL_STATUS_FILE_INVALID; }
     gstate = PyGILState_Ensure();
     if(!(pyPath = PyUnicode_FromWideChar(wszPathBuffer, -1))) { goto fail; }
     pyPid = (ctx->dwPID == -1) ? NULL : PyLong_FromUnsignedLong(ctx->dwPID);
-    args = Py_BuildValue("OOkK",
-        pyPid ? pyPid : Py_None,
-        pyPath,
-        cb,
-        cbOffset);
-    if(!args) { goto fail; }
-    pyBytes = PyObject_CallObject(ctxPY2C->fnRead, args);
-    if(!pyBytes || !PyBytes_Check(pyBytes)) { goto fail; }
-    *pcbRead = min(cb, (DWORD)PyBytes_Size(pyBytes));
-    if(*pcbRead) {
-        memcpy(pb, PyBytes_AsString(pyBytes), *pcbRead);
+    if(ctxPY2C->fnReadInto) {
+        if(!(pyView = PyMemoryView_FromMemory((char*)pb, cb, PyBUF_WRITE))) { goto fail; }
+        args = Py_BuildValue("OOOK",
+            pyPid ? pyPid : Py_None,
+            pyPath,
+            pyView,
+            cbOffset);
+        if(!args) { goto fail; }
+        pyResult = PyObject_CallObject(ctxPY2C->fnReadInto, args);
+        if(!pyResult || !PyLong_Check(pyResult)) { goto fail; }
+        llResult = PyLong_AsLongLong(pyResult);
+        *pcbRead = (llResult > 0) ? (DWORD)min(cb, (ULONG64)llResult) : 0;
+    } else {
+        args = Py_BuildValue("OOkK",
+            pyPid ? pyPid : Py_None,
+            pyPath,
+            cb,
+            cbOffset);
+        if(!args) { goto fail; }
+        pyResult = PyObject_CallObject(ctxPY2C->fnRead, args);
+        if(!pyResult || !PyBytes_Check(pyResult)) { goto fail; }
+        *pcbRead = min(cb, (DWORD)PyBytes_Size(pyResult));
+        if(*pcbRead) {
+            memcpy(pb, PyBytes_AsString(pyResult), *pcbRead);
+        }
     }
     nt = *pcbRead ? VMMDLL_STATUS_SUCCESS : VMMDLL_STATUS_END_OF_FILE;
     // fall through to cleanup
 fail:
+    if(pyView) {
+        // release the view - python must not access the native buffer after return.
+        PyErr_Clear();
+        pyViewRelease = PyObject_CallMethod(pyView, "release", NULL);
+        Py_XDECREF(pyViewRelease);
+        Py_DECREF(pyView);
+    }
+    PyErr_Clear();
     Py_XDECREF(args);
     Py_XDECREF(pyPid);
-    Py_XDECREF(pyBytes);
+    Py_XDECREF(pyResult);
     Py_XDECREF(pyPath);
     PyGILState_Release(gstate);
     return nt;
 }
 
+/*
+* Read a file. Static files are bounds checked natively and cacheable static
+* files are served from native memory once read - both without the GIL.
+*/
+NTSTATUS PY2C_Callback_Read(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ ULONG64 cbOffset)
+{
+    NTSTATUS nt;
+    QWORD qwHash, cbFile = 0;
+    BOOL fCache = FALSE;
+    DWORD cbContent, dwGeneration;
+    PBYTE pbContent = NULL;
+    PPY2C_STATIC_ENTRY pe;
+    *pcbRead = 0;
+    if(!ctxPY2C->fInitialized) { return VMMDLL_STATUS_FILE_INVALID; }
+    qwHash = PY2C_Util_HashPath(ctx->dwPID == -1, ctx->wszPath, NULL);
+    // 1: static file - serve natively (if possible):
+    AcquireSRWLockShared(&ctxPY2C->LockSRW);
+    if((pe = PY2C_Static_Get(qwHash)) && !pe->fDir) {
+        if(cbOffset >= pe->cb) {
+            ReleaseSRWLockShared(&ctxPY2C->LockSRW);
+            return VMMDLL_STATUS_END_OF_FILE;
+        }
+        cb = (DWORD)min(cb, pe->cb - cbOffset);
+        if(pe->pbContent) {
+            memcpy(pb, pe->pbContent + cbOffset, cb);
+            ReleaseSRWLockShared(&ctxPY2C->LockSRW);
+            *pcbRead = cb;
+            return VMMDLL_STATUS_SUCCESS;
+        }
+        fCache = pe->fCache;
+        cbFile = pe->cb;
+    }
+    dwGeneration = ctxPY2C->dwGeneration;
+    ReleaseSRWLockShared(&ctxPY2C->LockSRW);
+    // 2: cacheable static file - read whole file once and publish natively
+    //    unless invalidated while reading:
+    if(fCache && cbFile && (pbContent = LocalAlloc(0, (SIZE_T)cbFile))) {
+        nt = PY2C_Callback_Read_Python(ctx, pbContent, (DWORD)cbFile, &cbContent, 0);
+        if((nt == VMMDLL_STATUS_SUCCESS) && (cbContent == cbFile)) {
+            memcpy(pb, pbContent + cbOffset, cb);
+            *pcbRead = cb;
+            AcquireSRWLockExclusive(&ctxPY2C->LockSRW);
+            if((dwGeneration == ctxPY2C->dwGeneration) && (pe = PY2C_Static_Get(qwHash)) && !pe->pbContent && (pe->cb == cbFile)) {
+                pe->pbContent = pbContent;
+                pbContent = NULL;
+            }
+            ReleaseSRWLockExclusive(&ctxPY2C->LockSRW);
+            LocalFree(pbContent);
+            return VMMDLL_STATUS_SUCCESS;
+        }
+        LocalFree(pbContent);
+    }
+    // 3: read from python:
+    return PY2C_Callback_Read_Python(ctx, pb, cb, pcbRead, cbOffset);
+}
+
 NTSTATUS PY2C_Callback_Write(_In_ PVMMDLL_PLUGIN_CONTEXT ctx, _In_ LPVOID pb, _In_ DWORD cb, _Out_ PDWORD pcbWrite, _In_ ULONG64 cbOffset)
 {
     NTSTATUS nt = VMMDLL_STATUS_FILE_INVALID;
@@ -180,6 +721,8 @@ fail:
     Py_XDECREF(pyLong);
     Py_XDECREF(pyPath);
     PyGILState_Release(gstate);
+    // file contents may have changed - drop any natively cached content.
+    PY2C_Static_Invalidate(ctx->dwPID == -1, ctx->wszPath);
     return nt;
 }
 
@@ -188,6 +731,9 @@ VOID PY2C_Callback_Notify(_In_ DWORD fEvent, _In_opt_ PVOID pvEvent, _In_opt_ DW
     PyObject *args, *pyResult = NULL;
     PyGILState_STATE gstate;
     if(!ctxPY2C->fInitialized) { return; }
+    AcquireSRWLockExclusive(&ctxPY2C->LockSRW);
+    PY2C_ListCache_Clear();
+    ReleaseSRWLockExclusive(&ctxPY2C->LockSRW);
     gstate = PyGILState_Ensure();
     args = Py_BuildValue("ky#", fEvent, (char*)pvEvent, cbEvent);
     if(!args) { goto fail; }
@@ -222,7 +768,10 @@ fail:
 //-----------------------------------------------------------------------------
 
 static PyMethodDef VMMPYCC_EmbMethods[] = {
-    {"VMMPYCC_CallbackRegister", PY2C_CallbackRegister, METH_VARARGS, "Register callback functions: List, Read, Write, Close"},
+    {"VMMPYCC_CallbackRegister", PY2C_CallbackRegister, METH_VARARGS, "Register callback functions: List, Read, Write, Notify, Close, [ReadInto]"},
+    {"VMMPYCC_StaticRegister", PY2C_StaticRegister, METH_VARARGS, "Register static file/directory natively: f_root, path, size, f_isdir, f_isdynamic, f_iscacheable"},
+    {"VMMPYCC_StaticUnregister", PY2C_StaticUnregister, METH_VARARGS, "Unregister static file/directory natively: f_root, path"},
+    {"VMMPYCC_Invalidate", PY2C_Invalidate, METH_VARARGS, "Invalidate natively cached contents/listings: f_root, [path]"},
     {NULL, NULL, 0, NULL}
 };
 